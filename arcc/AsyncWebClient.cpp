@@ -0,0 +1,256 @@
+// Another Reddit Console Client
+// Copyright (c) 2017-2019, Adalid Claure <aclaure@gmail.com>
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+
+#include "HandlePool.h"
+#include "NetStats.h"
+#include "AsyncWebClient.h"
+
+namespace arcc
+{
+
+namespace
+{
+    // upper bound on how long the event thread sleeps when nothing
+    // happens, submit() wakes it up early
+    constexpr int POLL_TIMEOUT_MS = 1000;
+}
+
+static std::chrono::microseconds timeInfo(CURL* handle, CURLINFO info)
+{
+    curl_off_t value = 0;
+    curl_easy_getinfo(handle, info, &value);
+    return std::chrono::microseconds{ value };
+}
+
+static WebClient::Timings collectTimings(CURL* handle)
+{
+    // libcurl reports every phase as time elapsed since the start
+    const auto nameLookup = timeInfo(handle, CURLINFO_NAMELOOKUP_TIME_T);
+    const auto connect = timeInfo(handle, CURLINFO_CONNECT_TIME_T);
+    const auto appConnect = timeInfo(handle, CURLINFO_APPCONNECT_TIME_T);
+
+    WebClient::Timings retval;
+    retval.nameLookup = nameLookup;
+    retval.connect = std::max(connect - nameLookup, std::chrono::microseconds::zero());
+    retval.tlsHandshake = appConnect > connect ? appConnect - connect : std::chrono::microseconds::zero();
+    retval.firstByte = timeInfo(handle, CURLINFO_STARTTRANSFER_TIME_T);
+    retval.total = timeInfo(handle, CURLINFO_TOTAL_TIME_T);
+
+    curl_off_t bytes = 0;
+    curl_easy_getinfo(handle, CURLINFO_SIZE_DOWNLOAD_T, &bytes);
+    retval.bytesReceived = static_cast<std::uint64_t>(bytes);
+
+    return retval;
+}
+
+static std::string hostName(CURL* handle)
+{
+    std::string retval{ "unknown" };
+
+    char* url = nullptr;
+    curl_easy_getinfo(handle, CURLINFO_EFFECTIVE_URL, &url);
+    if (url == nullptr) return retval;
+
+    CURLU* parsed = curl_url();
+    char* host = nullptr;
+    if (curl_url_set(parsed, CURLUPART_URL, url, 0) == CURLUE_OK
+        && curl_url_get(parsed, CURLUPART_HOST, &host, 0) == CURLUE_OK)
+    {
+        retval = host;
+        curl_free(host);
+    }
+
+    curl_url_cleanup(parsed);
+    return retval;
+}
+
+AsyncWebClient& AsyncWebClient::instance()
+{
+    static AsyncWebClient engine;
+    return engine;
+}
+
+AsyncWebClient::AsyncWebClient()
+{
+    // make sure the pool outlives us since every transfer we
+    // tear down hands its handle back to it
+    HandlePool::instance();
+
+    _multi = curl_multi_init();
+
+    // reddit speaks HTTP/2, so let concurrent requests share one connection
+    curl_multi_setopt(_multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+
+    _thread = std::thread(&AsyncWebClient::run, this);
+}
+
+AsyncWebClient::~AsyncWebClient()
+{
+    _done = true;
+    curl_multi_wakeup(_multi);
+
+    if (_thread.joinable())
+    {
+        _thread.join();
+    }
+
+    curl_multi_cleanup(_multi);
+}
+
+std::future<WebClient::Reply> AsyncWebClient::submit(TransferPtr transfer)
+{
+    auto future = transfer->promise.get_future();
+
+    {
+        std::lock_guard<std::mutex> lock{ _mutex };
+        _pending.push_back(std::move(transfer));
+    }
+
+    curl_multi_wakeup(_multi);
+    return future;
+}
+
+void AsyncWebClient::run()
+{
+    while (!_done)
+    {
+        addPending();
+
+        int running = 0;
+        curl_multi_perform(_multi, &running);
+
+        int queued = 0;
+        while (CURLMsg* msg = curl_multi_info_read(_multi, &queued))
+        {
+            if (msg->msg != CURLMSG_DONE) continue;
+
+            // `msg` is invalid once the handle is removed
+            CURL* handle = msg->easy_handle;
+            const CURLcode result = msg->data.result;
+            curl_multi_remove_handle(_multi, handle);
+
+            if (auto it = _active.find(handle); it != _active.end())
+            {
+                auto transfer = std::move(it->second);
+                _active.erase(it);
+                finish(std::move(transfer), result);
+            }
+        }
+
+        curl_multi_poll(_multi, nullptr, 0, POLL_TIMEOUT_MS, nullptr);
+    }
+
+    abortAll();
+}
+
+void AsyncWebClient::addPending()
+{
+    std::vector<TransferPtr> pending;
+
+    {
+        std::lock_guard<std::mutex> lock{ _mutex };
+        pending.swap(_pending);
+    }
+
+    for (auto& transfer : pending)
+    {
+        CURL* handle = transfer->handle;
+        if (const auto code = curl_multi_add_handle(_multi, handle); code != CURLM_OK)
+        {
+            auto error = std::make_exception_ptr(
+                WebClientError(std::string{"Request error: "} + curl_multi_strerror(code)));
+
+            if (transfer->callback) transfer->callback(WebClient::Reply{}, error);
+            transfer->promise.set_exception(error);
+            continue;
+        }
+
+        _active.emplace(handle, std::move(transfer));
+    }
+}
+
+void AsyncWebClient::finish(TransferPtr transfer, CURLcode result)
+{
+    WebClient::Reply retval;
+    std::exception_ptr error;
+
+    long status = 0;
+    curl_easy_getinfo(transfer->handle, CURLINFO_RESPONSE_CODE, &status);
+
+    retval.status = status;
+    retval.headers = std::move(transfer->responseHeaders);
+    const auto host = hostName(transfer->handle);
+
+    if (result == CURLE_OK)
+    {
+        char *finalUrl;
+        curl_easy_getinfo(transfer->handle, CURLINFO_EFFECTIVE_URL, &finalUrl);
+
+        retval.timings = collectTimings(transfer->handle);
+        NetStats::instance().record(host, retval.timings);
+
+        if (status == 200)
+        {
+            retval.finalUrl = finalUrl;
+            retval.data = std::move(transfer->buffer);
+        }
+    }
+    else
+    {
+        std::stringstream ss;
+
+        if (std::strlen(transfer->errbuf) > 0)
+        {
+            ss << "Request error: " << transfer->errbuf;
+        }
+        else
+        {
+            ss << "Request error: " << curl_easy_strerror(result);
+        }
+
+        error = std::make_exception_ptr(WebClientError(ss.str()));
+        NetStats::instance().recordError(host);
+    }
+
+    if (transfer->callback)
+    {
+        transfer->callback(retval, error);
+    }
+
+    if (error)
+    {
+        transfer->promise.set_exception(error);
+    }
+    else
+    {
+        transfer->promise.set_value(std::move(retval));
+    }
+}
+
+void AsyncWebClient::abortAll()
+{
+    // nothing will ever complete these, so don't leave anyone waiting
+    const auto error = std::make_exception_ptr(WebClientError("Request error: client is shutting down"));
+
+    for (auto& [handle, transfer] : _active)
+    {
+        curl_multi_remove_handle(_multi, handle);
+        if (transfer->callback) transfer->callback(WebClient::Reply{}, error);
+        transfer->promise.set_exception(error);
+    }
+    _active.clear();
+
+    std::lock_guard<std::mutex> lock{ _mutex };
+    for (auto& transfer : _pending)
+    {
+        if (transfer->callback) transfer->callback(WebClient::Reply{}, error);
+        transfer->promise.set_exception(error);
+    }
+    _pending.clear();
+}
+
+} // namespace arcc
@@ -0,0 +1,82 @@
+// Another Reddit Console Client
+// Copyright (c) 2017-2019, Adalid Claure <aclaure@gmail.com>
+
+#pragma once
+
+#include <atomic>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <curl/curl.h>
+
+#include "BufferPool.h"
+#include "HandlePool.h"
+#include "WebClient.h"
+
+namespace arcc
+{
+
+// a single request that is owned by the AsyncWebClient while it is in flight,
+// everything libcurl points into must live here so it outlives the caller
+struct Transfer
+{
+    CURL*                           handle = nullptr;
+    std::string                     buffer;                     // buffer for response text
+    char                            errbuf[CURL_ERROR_SIZE] = {}; // detailed error buffer
+    std::shared_ptr<curl_slist>     headers;                    // custom headers, shared with the WebClient
+    WebClient::Headers              responseHeaders;
+
+    std::promise<WebClient::Reply>  promise;
+    WebClient::Callback             callback;
+    CancelFlag                      cancel;                     // checked from libcurl's progress callback
+
+    Transfer() = default;
+    Transfer(const Transfer&) = delete;
+    Transfer& operator=(const Transfer&) = delete;
+
+    ~Transfer()
+    {
+        HandlePool::instance().release(handle);
+        BufferPool::instance().release(std::move(buffer));
+    }
+};
+
+using TransferPtr = std::unique_ptr<Transfer>;
+
+// Drives any number of transfers on a single `curl_multi` handle from one
+// event thread. Callers hand over a fully configured Transfer and get back
+// a future, or have their callback invoked on the event thread, so
+// callbacks should be quick and must never block on another request.
+class AsyncWebClient final
+{
+    CURLM*                          _multi;
+    std::thread                     _thread;
+    std::atomic_bool                _done = false;
+
+    std::mutex                      _mutex;
+    std::vector<TransferPtr>        _pending;                   // guarded by _mutex
+    std::map<CURL*, TransferPtr>    _active;                    // only touched by the event thread
+
+public:
+    static AsyncWebClient& instance();
+
+    AsyncWebClient();
+    ~AsyncWebClient();
+
+    AsyncWebClient(const AsyncWebClient&) = delete;
+    AsyncWebClient& operator=(const AsyncWebClient&) = delete;
+
+    std::future<WebClient::Reply> submit(TransferPtr transfer);
+
+private:
+    void run();
+    void addPending();
+    void finish(TransferPtr transfer, CURLcode result);
+    void abortAll();
+};
+
+} // namespace arcc
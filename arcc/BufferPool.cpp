@@ -0,0 +1,71 @@
+// Another Reddit Console Client
+// Copyright (c) 2017-2019, Adalid Claure <aclaure@gmail.com>
+
+#include "BufferPool.h"
+
+namespace arcc
+{
+
+namespace
+{
+    constexpr std::size_t MAX_FREE_BUFFERS = 16;
+
+    // don't let one huge response pin its memory forever
+    constexpr std::size_t MAX_POOLED_CAPACITY = 4 * 1024 * 1024;
+}
+
+BufferPool& BufferPool::instance()
+{
+    static BufferPool pool;
+    return pool;
+}
+
+std::string BufferPool::acquire()
+{
+    _acquired++;
+
+    std::lock_guard<std::mutex> lock{ _mutex };
+    if (_free.empty())
+    {
+        return std::string{};
+    }
+
+    _reused++;
+
+    std::string retval{ std::move(_free.back()) };
+    _free.pop_back();
+    return retval;
+}
+
+void BufferPool::release(std::string&& buffer)
+{
+    if (buffer.capacity() == 0 || buffer.capacity() > MAX_POOLED_CAPACITY)
+    {
+        return;
+    }
+
+    buffer.clear();
+
+    std::lock_guard<std::mutex> lock{ _mutex };
+    if (_free.size() < MAX_FREE_BUFFERS)
+    {
+        _free.push_back(std::move(buffer));
+    }
+}
+
+void BufferPool::append(std::string& buffer, const char* data, std::size_t size)
+{
+    if (buffer.size() + size > buffer.capacity())
+    {
+        _reallocations++;
+    }
+
+    buffer.append(data, size);
+}
+
+BufferPool::Stats BufferPool::stats() const
+{
+    return Stats{ _acquired.load(), _reused.load(), _reallocations.load() };
+}
+
+} // namespace arcc
@@ -0,0 +1,46 @@
+// Another Reddit Console Client
+// Copyright (c) 2017-2019, Adalid Claure <aclaure@gmail.com>
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace arcc
+{
+
+// Recycles response buffers so a request starts with memory that has
+// already grown to a realistic size. Buffers travel from the pool into a
+// Transfer, get moved into the Reply and come back when the Reply dies.
+class BufferPool final
+{
+    std::mutex                  _mutex;
+    std::vector<std::string>    _free;                          // guarded by _mutex
+
+    std::atomic<std::uint64_t>  _acquired = 0;
+    std::atomic<std::uint64_t>  _reused = 0;
+    std::atomic<std::uint64_t>  _reallocations = 0;
+
+public:
+    struct Stats
+    {
+        std::uint64_t acquired = 0;
+        std::uint64_t reused = 0;                               // served from the pool
+        std::uint64_t reallocations = 0;                        // appends that outgrew the buffer
+    };
+
+    static BufferPool& instance();
+
+    std::string acquire();
+    void release(std::string&& buffer);
+
+    // appends to a pooled buffer and keeps track of how often it had to grow
+    void append(std::string& buffer, const char* data, std::size_t size);
+
+    Stats stats() const;
+};
+
+} // namespace arcc
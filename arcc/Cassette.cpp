@@ -0,0 +1,250 @@
+// Another Reddit Console Client
+// Copyright (c) 2017-2019, Adalid Claure <aclaure@gmail.com>
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#include <nlohmann/json.hpp>
+
+#include "Cassette.h"
+
+using namespace std::string_literals;
+
+namespace arcc
+{
+
+static std::string methodName(Transport::Method method)
+{
+    return method == Transport::Method::POST ? "POST" : "GET";
+}
+
+static nlohmann::json toJson(const CassetteEntry& entry)
+{
+    return nlohmann::json
+    {
+        { "method", methodName(entry.method) },
+        { "url", entry.url },
+        { "payload", entry.payload },
+        { "status", entry.status },
+        { "finalUrl", entry.finalUrl },
+        { "headers", entry.headers },
+        { "data", entry.data }
+    };
+}
+
+static CassetteEntry fromJson(const nlohmann::json& json)
+{
+    CassetteEntry retval;
+    retval.method = json.value("method", "GET"s) == "POST" ? Transport::Method::POST : Transport::Method::GET;
+    retval.url = json.at("url").get<std::string>();
+    retval.payload = json.value("payload", ""s);
+    retval.status = json.value("status", 200L);
+    retval.finalUrl = json.value("finalUrl", retval.url);
+    retval.data = json.value("data", ""s);
+
+    if (json.contains("headers"))
+    {
+        retval.headers = json["headers"].get<Transport::Headers>();
+    }
+
+    return retval;
+}
+
+std::vector<CassetteEntry> loadCassette(const std::string& filename)
+{
+    std::ifstream in{ filename };
+    if (!in)
+    {
+        throw WebClientError("could not open cassette '" + filename + "'");
+    }
+
+    std::vector<CassetteEntry> retval;
+    std::string line;
+    std::size_t lineno = 0;
+
+    while (std::getline(in, line))
+    {
+        ++lineno;
+        if (line.empty()) continue;
+
+        try
+        {
+            retval.push_back(fromJson(nlohmann::json::parse(line)));
+        }
+        catch (const nlohmann::json::exception& ex)
+        {
+            throw WebClientError("cassette '" + filename + "' line " + std::to_string(lineno) + ": " + ex.what());
+        }
+    }
+
+    return retval;
+}
+
+CassetteWriter::CassetteWriter(const std::string& filename)
+    : _out{ filename, std::ios::app }
+{
+    if (!_out)
+    {
+        throw WebClientError("could not open cassette '" + filename + "' for writing");
+    }
+}
+
+void CassetteWriter::append(const CassetteEntry& entry)
+{
+    const auto line = toJson(entry).dump();
+
+    std::lock_guard<std::mutex> lock{ _mutex };
+    _out << line << '\n' << std::flush;
+}
+
+RecordingTransport::RecordingTransport(TransportPtr inner, CassetteWriterPtr writer)
+    : _inner{ std::move(inner) }, _writer{ std::move(writer) }
+{
+}
+
+RecordingTransport::RecordingTransport(TransportPtr inner, const std::string& filename)
+    : RecordingTransport(std::move(inner), std::make_shared<CassetteWriter>(filename))
+{
+}
+
+std::future<Transport::Reply> RecordingTransport::send(Request request)
+{
+    auto entry = std::make_shared<CassetteEntry>();
+    entry->method = request.method;
+    entry->url = request.url;
+    entry->payload = request.payload;
+
+    request.callback =
+        [writer = _writer, entry, callback = std::move(request.callback)]
+        (const Transport::Reply& reply, std::exception_ptr error)
+        {
+            if (!error)
+            {
+                entry->status = reply.status;
+                entry->finalUrl = reply.finalUrl;
+                entry->headers = reply.headers;
+                entry->data = reply.data;
+
+                writer->append(*entry);
+            }
+
+            if (callback) callback(reply, error);
+        };
+
+    return _inner->send(std::move(request));
+}
+
+TransportPtr RecordingTransport::makeSibling() const
+{
+    return std::make_shared<RecordingTransport>(_inner->makeSibling(), _writer);
+}
+
+ReplayTransport::ReplayTransport(const std::string& filename)
+    : ReplayTransport(loadCassette(filename))
+{
+}
+
+ReplayTransport::ReplayTransport(const std::vector<CassetteEntry>& entries)
+    : _tape{ std::make_shared<Tape>() }
+{
+    for (const auto& entry : entries)
+    {
+        _tape->entries[Key{ entry.method, entry.url, entry.payload }].push_back(entry);
+    }
+}
+
+ReplayTransport::ReplayTransport(std::shared_ptr<Tape> tape)
+    : _tape{ std::move(tape) }
+{
+}
+
+TransportPtr ReplayTransport::makeSibling() const
+{
+    auto retval = std::shared_ptr<ReplayTransport>(new ReplayTransport(_tape));
+    retval->_latency = _latency;
+    return retval;
+}
+
+std::size_t ReplayTransport::played(Method method, const std::string& url, const std::string& payload) const
+{
+    std::lock_guard<std::mutex> lock{ _tape->mutex };
+    const auto it = _tape->played.find(Key{ method, url, payload });
+    return it == _tape->played.end() ? 0 : it->second;
+}
+
+std::optional<CassetteEntry> ReplayTransport::next(const Request& request)
+{
+    const Key key{ request.method, request.url, request.payload };
+
+    std::lock_guard<std::mutex> lock{ _tape->mutex };
+    const auto it = _tape->entries.find(key);
+    if (it == _tape->entries.end()) return {};
+
+    auto& played = _tape->played[key];
+    const auto index = std::min(played, it->second.size() - 1);
+    ++played;
+
+    return it->second[index];
+}
+
+static void deliver(Transport::Request& request, const std::optional<CassetteEntry>& entry,
+    std::promise<Transport::Reply>& promise)
+{
+    const bool cancelled = request.cancel && *request.cancel;
+    if (!entry || cancelled)
+    {
+        auto error = std::make_exception_ptr(WebClientError(cancelled
+            ? "Request error: cancelled"
+            : "Request error: no recorded response for " + methodName(request.method) + " " + request.url));
+
+        if (request.callback) request.callback(Transport::Reply{}, error);
+        promise.set_exception(error);
+        return;
+    }
+
+    Transport::Reply reply;
+    reply.status = entry->status;
+    reply.headers = entry->headers;
+
+    // mirror the live transport, only a 200 carries a body
+    if (entry->status == 200)
+    {
+        reply.finalUrl = entry->finalUrl;
+        reply.data = entry->data;
+    }
+
+    if (request.callback) request.callback(reply, nullptr);
+    promise.set_value(std::move(reply));
+}
+
+std::future<Transport::Reply> ReplayTransport::send(Request request)
+{
+    auto entry = next(request);
+    std::promise<Transport::Reply> promise;
+    auto future = promise.get_future();
+
+    if (_latency.count() == 0)
+    {
+        deliver(request, entry, promise);
+        return future;
+    }
+
+    std::thread(
+        [request = std::move(request), entry = std::move(entry), promise = std::move(promise),
+            latency = _latency]() mutable
+        {
+            // a cancelled request gives up right away, as a live one does
+            const auto until = std::chrono::steady_clock::now() + latency;
+            while (std::chrono::steady_clock::now() < until && !(request.cancel && *request.cancel))
+            {
+                std::this_thread::sleep_for(std::min(latency, std::chrono::milliseconds{ 5 }));
+            }
+
+            deliver(request, entry, promise);
+        }).detach();
+
+    return future;
+}
+
+} // namespace arcc
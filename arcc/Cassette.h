@@ -0,0 +1,128 @@
+// Another Reddit Console Client
+// Copyright (c) 2017-2019, Adalid Claure <aclaure@gmail.com>
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "Transport.h"
+
+namespace arcc
+{
+
+// One recorded request and the response it got. A cassette file holds one
+// entry per line as a JSON object.
+struct CassetteEntry
+{
+    Transport::Method       method = Transport::Method::GET;
+    std::string             url;
+    std::string             payload;
+
+    long                    status = -1;
+    std::string             finalUrl;
+    Transport::Headers      headers;
+    std::string             data;
+};
+
+std::vector<CassetteEntry> loadCassette(const std::string& filename);
+
+// Appends entries to a cassette file, shared by every RecordingTransport
+// that records into the same file
+class CassetteWriter final
+{
+    std::mutex      _mutex;
+    std::ofstream   _out;
+
+public:
+    explicit CassetteWriter(const std::string& filename);
+    void append(const CassetteEntry& entry);
+};
+
+using CassetteWriterPtr = std::shared_ptr<CassetteWriter>;
+
+// Passes every request through to another transport and writes each
+// completed request/response pair to a cassette
+class RecordingTransport final : public Transport
+{
+    TransportPtr        _inner;
+    CassetteWriterPtr   _writer;
+
+public:
+    RecordingTransport(TransportPtr inner, CassetteWriterPtr writer);
+    RecordingTransport(TransportPtr inner, const std::string& filename);
+
+    std::future<Transport::Reply> send(Request request) override;
+    TransportPtr makeSibling() const override;
+
+    void setBasicAuth(const std::string& username, const std::string& password) override
+    {
+        _inner->setBasicAuth(username, password);
+    }
+
+    void setUserAgent(const std::string& useragent) override
+    {
+        _inner->setUserAgent(useragent);
+    }
+
+    void setHeader(const std::string& header) override
+    {
+        _inner->setHeader(header);
+    }
+
+    void setTrace(bool trace) override
+    {
+        _inner->setTrace(trace);
+    }
+};
+
+// Serves recorded responses from memory without touching the network.
+// Requests are matched on method, url and payload; repeated requests get
+// the recorded responses in order and then the last one over and over.
+// Authentication and header settings are accepted and ignored.
+class ReplayTransport final : public Transport
+{
+    using Key = std::tuple<Method, std::string, std::string>;
+
+    struct Tape
+    {
+        std::mutex                                  mutex;
+        std::map<Key, std::vector<CassetteEntry>>   entries;
+        std::map<Key, std::size_t>                  played;
+    };
+
+    std::shared_ptr<Tape>       _tape;
+    std::chrono::milliseconds   _latency{ 0 };
+
+public:
+    explicit ReplayTransport(const std::string& filename);
+    explicit ReplayTransport(const std::vector<CassetteEntry>& entries);
+
+    // delay every response, a non-zero latency delivers on a separate thread
+    // and a request cancelled in the meantime fails as soon as it is
+    void setLatency(std::chrono::milliseconds latency) { _latency = latency; }
+
+    // how many times a recorded request was answered, siblings included
+    std::size_t played(Method method, const std::string& url, const std::string& payload = {}) const;
+
+    std::future<Transport::Reply> send(Request request) override;
+    TransportPtr makeSibling() const override;
+
+    void setBasicAuth(const std::string&, const std::string&) override {}
+    void setUserAgent(const std::string&) override {}
+    void setHeader(const std::string&) override {}
+
+private:
+    ReplayTransport(std::shared_ptr<Tape> tape);
+
+    std::optional<CassetteEntry> next(const Request& request);
+};
+
+} // namespace arcc
@@ -18,6 +18,15 @@
 #include "OAuth2Login.h"
 #include "core.h"
 #include "Settings.h"
+#include "NetStats.h"
+#include "BufferPool.h"
+#include "Exporter.h"
+#include "FilteredListing.h"
+#include "ListingStream.h"
+#include "MergedListing.h"
+#include "SearchListing.h"
+#include "Watcher.h"
+#include "HandlePool.h"
 
 #include "ConsoleApp.h"
 
@@ -86,8 +95,64 @@ ConsoleApp::ConsoleApp(arcc::Settings& settings, std::shared_ptr<arcc::RedditSes
     _history.setHistoryFile(historyfile);
     _history.loadHistory(false);
 
+    initSession();
+    initStore();
+    initIndex();
+}
+
+void ConsoleApp::initSession()
+{
+    // runs on the session's refresher thread, which can outlive us but
+    // never the session itself
     _session->setRefreshCallback(
-        [this]() { _session->save(utils::getDefaultSessionFile()); });
+        [session = _session.get()]() { session->save(utils::getDefaultSessionFile()); });
+
+    _session->setRefreshMargin(std::chrono::seconds{ _settings.value("reddit.refresh.margin", 300u) });
+}
+
+void ConsoleApp::initStore()
+{
+    if (!_settings.value("command.list.store", true)) return;
+
+    try
+    {
+        _store = std::make_shared<PostStore>(utils::getDefaultPostStoreFile());
+    }
+    catch (const std::exception& ex)
+    {
+        printWarning(fmt::format("saved listings are not available: {}", ex.what()));
+    }
+}
+
+void ConsoleApp::initIndex()
+{
+    if (!_settings.value("command.search.index", true)) return;
+
+    _index = std::make_shared<SearchIndex>();
+
+    try
+    {
+        _index->load(utils::getDefaultSearchIndexFile());
+    }
+    catch (const std::exception& ex)
+    {
+        // start over, the next save replaces the file
+        printWarning(fmt::format("the search index could not be loaded: {}", ex.what()));
+    }
+}
+
+void ConsoleApp::saveIndex()
+{
+    if (!_index || !_index->modified()) return;
+
+    try
+    {
+        _index->save(utils::getDefaultSearchIndexFile());
+    }
+    catch (const std::exception& ex)
+    {
+        printWarning(fmt::format("the search index could not be saved: {}", ex.what()));
+    }
 }
 
 void ConsoleApp::initTerminal()
@@ -131,9 +196,15 @@ void ConsoleApp::initCommands()
     addCommand("list,l,ls", "list links and posts", std::bind(&ConsoleApp::list, this, std::placeholders::_1));
     addCommand("next,n", "go to the next page of links and posts", std::bind(&ConsoleApp::next, this, std::placeholders::_1));
     addCommand("previous,p", "go to a previous page of links and posts", std::bind(&ConsoleApp::previous, this, std::placeholders::_1));
+    addCommand("refresh,r", "fetch the current page of links and posts again", std::bind(&ConsoleApp::refresh, this, std::placeholders::_1));
     addCommand("current,c", "list items on the current page", 
         [this](const std::string&)
         {
+            if (settleListing())
+            {
+                ConsoleApp::printStatus("showing the latest items");
+            }
+
             if (_currentPage.size() > 0)
             {
                 printListing();
@@ -156,6 +227,7 @@ void ConsoleApp::initCommands()
                 if (login.loggedIn())
                 {
                     _session = login.getRedditSession();
+                    initSession();
                     _session->save(utils::getDefaultSessionFile());
                     std::cout << "login successful " << utils::sentimentText(utils::Sentiment::POSITIVE) << std::endl;
                 }
@@ -246,6 +318,11 @@ void ConsoleApp::initCommands()
                 auto result = client.doRequest(params);
                 auto t_end = std::chrono::high_resolution_clock::now();
                 std::cout << result.data.size() << " bytes in " << std::chrono::duration<double, std::milli>(t_end-t_start).count() << " ms\n";
+
+                const auto& t = result.timings;
+                std::cout << fmt::format("dns {:.2f} ms, connect {:.2f} ms, tls {:.2f} ms, first byte {:.2f} ms\n",
+                    t.nameLookup.count() / 1000.0, t.connect.count() / 1000.0,
+                    t.tlsHandshake.count() / 1000.0, t.firstByte.count() / 1000.0);
             }
             catch (WebClientError& e)
             {
@@ -253,6 +330,11 @@ void ConsoleApp::initCommands()
             }
         });
 
+    addCommand("netstats", "print request latency statistics", std::bind(&ConsoleApp::netstats, this, std::placeholders::_1));
+    addCommand("export", "write the items of the current listing to a file", std::bind(&ConsoleApp::exportListing, this, std::placeholders::_1));
+    addCommand("search,find", "search the items fetched so far", std::bind(&ConsoleApp::search, this, std::placeholders::_1));
+    addCommand("watch,w", "print new items of subreddits as they are posted", std::bind(&ConsoleApp::watch, this, std::placeholders::_1));
+
     addCommand("time", "print the current epoch time",
         [](const std::string&)
         {
@@ -276,6 +358,8 @@ void ConsoleApp::refreshSettings()
     {
         rang::setControlMode(rang::control::Off);
     }
+
+    _session->setRefreshMargin(std::chrono::seconds{ _settings.value("reddit.refresh.margin", 300u) });
 }
 
 void ConsoleApp::exec(const std::string& rawline)
@@ -368,6 +452,10 @@ void ConsoleApp::run()
             std::cout << std::endl;
         }
     }
+
+    // a first page that is still loading adds to the index too
+    settleListing();
+    saveIndex();
 }
 
 bool ConsoleApp::setLocation(const std::string& location)
@@ -376,6 +464,7 @@ bool ConsoleApp::setLocation(const std::string& location)
 
     if (location == "/")
     {
+        leaveListing();
         _session->setLocation(""s);
         return true;
     }
@@ -393,6 +482,7 @@ bool ConsoleApp::setLocation(const std::string& location)
                 if (jreply["data"]["created"].get<unsigned int>() > 0)
                 {
                     retval = true;
+                    leaveListing();
                     _session->setLocation(location);
                     return true;
                 }
@@ -407,6 +497,50 @@ bool ConsoleApp::setLocation(const std::string& location)
     return false;
 }
 
+std::optional<SeenSet::Mode> ConsoleApp::dedupMode() const
+{
+    const auto mode = _settings.value("command.list.dedup", "exact");
+    if (mode == "bloom") return SeenSet::Mode::BLOOM;
+    if (mode == "off") return {};
+    return SeenSet::Mode::EXACT;
+}
+
+bool ConsoleApp::settleListing()
+{
+    if (!_latest.valid()) return false;
+
+    Listing::Page page;
+    try
+    {
+        page = _latest.get();
+    }
+    catch (const std::exception& ex)
+    {
+        printError(ex.what());
+    }
+
+    if (page.empty())
+    {
+        printWarning("could not load the latest items, the saved ones are all there is");
+        return false;
+    }
+
+    _currentPage = std::move(page);
+    return true;
+}
+
+void ConsoleApp::leaveListing()
+{
+    // the listing is not ours to touch while its first page is loading
+    settleListing();
+
+    // stop paying for pages nobody is going to look at
+    if (_listing)
+    {
+        _listing->cancelPrefetch();
+    }
+}
+
 std::string ConsoleApp::doRedditGet(const std::string& endpoint)
 {
     return doRedditGet(endpoint, Params{});
@@ -510,7 +644,7 @@ ConsoleApp::ViewFormType ConsoleApp::parserViewFormType(const std::string& val)
 
 void ConsoleApp::view(const std::string& params)
 {
-    static const std::string usage = "usage: view <index> (-c,--comments | -u,--url)";
+    static const std::string usage = "usage: view <index> (-c,--comments | -u,--url | --raw)";
 
     if (SimpleArgs args{ params }; args.getPositionalCount() > 0)
     {
@@ -523,11 +657,13 @@ void ConsoleApp::view(const std::string& params)
 
             if (index > 0 && index <= _currentPage.size())
             {
-                const auto& page = _currentPage.at(index-1);
-                assert(page.find("data") != page.end());
-                const auto& data = page.at("data");
-                assert(data.find("url") != data.end());
-                assert(data.find("permalink") != data.end());
+                const auto& link = _currentPage.at(index-1);
+
+                if (args.hasArgument("raw"))
+                {
+                    printRawLink(link);
+                    return;
+                }
 
                 if (args.hasArgument("comments") || args.hasArgument("c"))
                 {
@@ -558,7 +694,7 @@ void ConsoleApp::view(const std::string& params)
 
                 if (viewType == COMMENTS)
                 {
-                    url = fmt::format("https://www.reddit.com{}", static_cast<std::string>(data["permalink"]));
+                    url = fmt::format("https://www.reddit.com{}", link.permalink);
                     
                     auto formType = ViewFormType::NORMAL;
                     if (args.hasArgument("mobile")) formType = ViewFormType::MOBILE;
@@ -593,7 +729,7 @@ void ConsoleApp::view(const std::string& params)
                 }
                 else if (viewType == URL)
                 {
-                    url = data["url"];
+                    url = link.url;
                 }
 
                 printStatus(fmt::format("opening '{}'", url));
@@ -615,6 +751,31 @@ void ConsoleApp::view(const std::string& params)
     }
 }
 
+void ConsoleApp::printRawLink(const Link& link)
+{
+    if (link.raw)
+    {
+        std::cout << link.raw->dump(4) << std::endl;
+        return;
+    }
+
+    // the listing didn't keep it, so ask reddit for this one item
+    const auto jsontext = doRedditGet(fmt::format("/by_id/{}", link.name));
+    if (jsontext.empty()) return;
+
+    const auto reply = nlohmann::json::parse(jsontext, nullptr, false);
+    if (reply.is_discarded()
+        || !reply.contains("data")
+        || !reply["data"].contains("children")
+        || reply["data"]["children"].empty())
+    {
+        ConsoleApp::printError(fmt::format("could not retrieve '{}'", link.name));
+        return;
+    }
+
+    std::cout << reply["data"]["children"][0].value("data", nlohmann::json{}).dump(4) << std::endl;
+}
+
 void ConsoleApp::setCommand(const std::string& params)
 {
     if (params.size() == 0)
@@ -751,16 +912,15 @@ void ConsoleApp::history(const std::string& params)
     }
 }
 
-void ConsoleApp::renderLink(const nlohmann::json& link, std::size_t idx)
+void ConsoleApp::renderLink(const Link& link, std::size_t idx)
 {
     std::string flairText;
-    if (link.find("link_flair_text") != link.end()
-        && !link["link_flair_text"].is_null())
+    if (!link.flair.empty())
     {
-        flairText = fmt::format("[{}]", link.at("link_flair_text").template get<std::string>());
+        flairText = fmt::format("[{}]", link.flair);
     }
 
-    if (link["stickied"].get<bool>())
+    if (link.stickied)
     {
         std::cout << rang::fg::black << rang::style::bold << rang::bg::yellow;
     }
@@ -768,24 +928,22 @@ void ConsoleApp::renderLink(const nlohmann::json& link, std::size_t idx)
     std::string namestr;
     if (_settings.value("render.list.name", false))
     {
-        namestr = fmt::format(" ({})", link["name"].get<std::string>());
+        namestr = fmt::format(" ({})", link.name);
     }
 
     std::string updownstr;
     if (_settings.value("render.list.votes", false))
     {
-        updownstr = fmt::format(" (+{}/-{})",
-            std::to_string(link["ups"].get<std::uint32_t>()),
-            std::to_string(link["downs"].get<std::uint32_t>()));
+        updownstr = fmt::format(" (+{}/-{})", link.ups, link.downs);
     }
 
     std::string urlstr;
     if (_settings.value("render.list.url", false))
     {
-        urlstr = fmt::format("{}\n", link.value("url", ""));
+        urlstr = fmt::format("{}\n", link.url);
     }
 
-    std::string titlestr { link.value("title","")} ;
+    std::string titlestr{ link.title };
     if (const std::size_t maxlen = _settings.value("render.list.title.length",0);
         maxlen > 0 && titlestr.size() > maxlen)
     {
@@ -812,19 +970,19 @@ void ConsoleApp::renderLink(const nlohmann::json& link, std::size_t idx)
         << urlstr
         << rang::style::reset
         << rang::fg::gray
-        << link["score"].get<int>()
+        << link.score
         << " pts"
         << updownstr
         << " - "
-        << utils::miniMoment(link["created_utc"].get<std::uint32_t>())
+        << utils::miniMoment(link.created)
         << " - "
-        << link["num_comments"].get<int>() << " comments"
+        << link.comments << " comments"
         << '\n'
         << rang::fg::magenta
-        << link["author"].get<std::string>()
+        << link.author
         << ' '
         << rang::fg::yellow
-        << link["subreddit_name_prefixed"].get<std::string>();
+        << link.subreddit;
 
     if (flairText.size() > 0)
     {
@@ -849,19 +1007,13 @@ void ConsoleApp::printListing()
     std::size_t idx = 0;
     for (const auto& item : _currentPage)
     {
-        if (item.at("data").is_null())
-        {
-            continue;
-        }
-
-        const auto listkind = item.value("kind", "t3");
-        if (listkind == "t3")
+        if (item.kind == "t3")
         {
-            renderLink(item.at("data"), ++idx);
+            renderLink(item, ++idx);
         }
         else
         {
-            printError(fmt::format("unsupported list prefix '{}'", listkind));
+            printError(fmt::format("unsupported list prefix '{}'", item.kind));
         }
     }
 }
@@ -875,17 +1027,23 @@ void ConsoleApp::list(const std::string& cmdParams)
     SimpleArgs args{ cmdParams };
     std::string endpoint;
 
+    // more than one sub, e.g. `--sub=cpp,rust`, are listed side by side
+    std::vector<std::string> subs;
     if (const std::string subName = args.getNamedArgument("sub"); 
         !subName.empty())
     {
-        if (boost::starts_with(subName, "/r/"))
-        {
-            endpoint = subName;
-        }
-        else
+        boost::split(subs, subName, boost::is_any_of(","), boost::token_compress_on);
+        subs.erase(std::remove(subs.begin(), subs.end(), std::string{}), subs.end());
+
+        for (auto& sub : subs)
         {
-            endpoint = fmt::format("/r/{}", subName);
+            if (!boost::starts_with(sub, "/r/"))
+            {
+                sub = fmt::format("/r/{}", sub);
+            }
         }
+
+        if (!subs.empty()) endpoint = subs.front();
     }
     else if (_session->location() != "/")
     {
@@ -907,14 +1065,17 @@ void ConsoleApp::list(const std::string& cmdParams)
             return;
         }
 
-        endpoint.append(fmt::format("/{}", temp));
         listType.assign(temp);
     }
     else
     {
-        const auto typeSetting = _settings.value("command.list.type", "hot");
-        endpoint.append(fmt::format("/{}", typeSetting));
-        listType.assign(typeSetting);
+        listType.assign(_settings.value("command.list.type", "hot"));
+    }
+
+    endpoint.append(fmt::format("/{}", listType));
+    for (auto& sub : subs)
+    {
+        sub.append(fmt::format("/{}", listType));
     }
 
     if (listType == "top" && args.hasArgument("t"))
@@ -946,21 +1107,130 @@ void ConsoleApp::list(const std::string& cmdParams)
         limit = static_cast<std::uint32_t>(std::stoul(limitstr));
     }
 
-    auto listing = std::make_unique<Listing>(_session, endpoint, limit, listParams);
+    // more than reddit sends at once is put together from several requests
+    if (limit == 0)
+    {
+        ConsoleApp::printError("parameter 'limit' has invalid value '0'");
+        return;
+    }
+
+    std::optional<LinkFilter> filter;
+    if (args.hasArgument("where"))
+    {
+        try
+        {
+            filter.emplace(args.getNamedArgument("where"));
+        }
+        catch (const std::invalid_argument& ex)
+        {
+            ConsoleApp::printError(ex.what());
+            return;
+        }
+    }
+
+    // a filter is likely to throw most items away, so ask for full pages
+    const auto pageSize = filter ? ListingStream::MAX_PAGE_SIZE : limit;
+
+    // memory each listing may spend on pages already shown
+    const std::size_t cacheSize = _settings.value("command.list.cache.size", 4096u) * 1024;
+
+    std::unique_ptr<ListingBase> listing;
+    if (subs.size() > 1)
+    {
+        // merge in the order reddit sorts each of them by
+        auto order = listType == "new" ? MergeOrder::CREATED
+            : (listType == "top" || listType == "controversial") ? MergeOrder::SCORE
+            : MergeOrder::HOT;
+
+        if (args.hasArgument("order"))
+        {
+            const auto& orderName = args.getNamedArgument("order");
+            if (orderName == "created") order = MergeOrder::CREATED;
+            else if (orderName == "score") order = MergeOrder::SCORE;
+            else if (orderName == "hot") order = MergeOrder::HOT;
+            else
+            {
+                ConsoleApp::printError(fmt::format("invalid order '{}'", orderName));
+                ConsoleApp::printStatus("valid values: created, score, hot");
+                return;
+            }
+        }
+
+        auto merged = std::make_unique<MergedListing>(_session, subs, pageSize, listParams, order);
+        merged->setCacheSize(cacheSize);
+        merged->setIndex(_index);
+        listing = std::move(merged);
+        endpoint = boost::algorithm::join(subs, "', '");
+    }
+    else
+    {
+        auto single = std::make_unique<Listing>(_session, endpoint, pageSize, listParams);
+        single->setPrefetchDepth(_settings.value("command.list.prefetch", 1u));
+        single->setCacheSize(cacheSize);
+        single->setDeduplicate(dedupMode());
+        single->setStore(_store);
+        single->setIndex(_index);
+        listing = std::move(single);
+    }
+
+    // whatever the previous listing was still loading goes with it
+    settleListing();
+
+    FilteredListing* filtered = nullptr;
+    if (filter)
+    {
+        auto temp = std::make_unique<FilteredListing>(std::move(listing), std::move(*filter), limit);
+        temp->setCacheSize(cacheSize);
+        filtered = temp.get();
+        listing = std::move(temp);
+    }
+
+    // show what was saved last time while reddit is asked for the latest,
+    // the store has nothing filtered so a filtered listing is never shown
+    // from it
+    if (const auto single = dynamic_cast<Listing*>(listing.get()); single && _store)
+    {
+        if (auto saved = _store->get(PostStore::key(single->endpoint(), single->params()), limit);
+            saved && !saved->page.empty())
+        {
+            ConsoleApp::printStatus(fmt::format("showing {} saved '{}' items from '{}', {} old, `current` shows the latest",
+                saved->page.size(), listType, endpoint, utils::miniMoment(saved->saved)));
+
+            _listing = std::move(listing);
+            _currentPage = std::move(saved->page);
+            _latest = std::async(std::launch::async, [single] { return single->getFirstPage(); });
+
+            printListing();
+            return;
+        }
+    }
+
+
     if (auto page = listing->getFirstPage(); !page.empty())
     {
         ConsoleApp::printStatus(fmt::format("showing {} '{}' items from '{}'",
             limit, listType, endpoint ));
 
+        if (filtered)
+        {
+            ConsoleApp::printStatus(fmt::format("where {}", filtered->filter().expression()));
+        }
+
         _listing = std::move(listing);
         _currentPage = std::move(page);
 
         printListing();
     }
+    else if (filtered)
+    {
+        ConsoleApp::printWarning(fmt::format("nothing matched the filter in {} page(s)", filtered->scanned()));
+    }
 }
 
 void ConsoleApp::next(const std::string&)
 {
+    settleListing();
+
     if (auto page = _listing->getNextPage(); !page.empty())
     {
         _currentPage = std::move(page);
@@ -974,6 +1244,8 @@ void ConsoleApp::next(const std::string&)
 
 void ConsoleApp::previous(const std::string&)
 {
+    settleListing();
+
     if (auto page = _listing->getPreviousPage(); !page.empty())
     {
         _currentPage = std::move(page);
@@ -985,4 +1257,315 @@ void ConsoleApp::previous(const std::string&)
     }
 }
 
+void ConsoleApp::refresh(const std::string&)
+{
+    if (!_listing)
+    {
+        ConsoleApp::printWarning("there is no listing to refresh");
+        return;
+    }
+
+    settleListing();
+
+    if (auto page = _listing->refresh(); !page.empty())
+    {
+        _currentPage = std::move(page);
+        printListing();
+    }
+    else
+    {
+        ConsoleApp::printWarning("there are no items on the current page");
+    }
+}
+
+void ConsoleApp::exportListing(const std::string& params)
+{
+    static const std::string usage = "usage: export <file> [--limit=<count>] [--fields=<name,...>]";
+
+    SimpleArgs args{ params };
+    if (args.getPositionalCount() != 1)
+    {
+        ConsoleApp::printError(usage);
+        return;
+    }
+
+    if (!_listing)
+    {
+        ConsoleApp::printWarning("there is no listing to export, use `list` first");
+        return;
+    }
+
+    std::size_t limit = 1000;
+    if (args.hasArgument("limit"))
+    {
+        const auto text = args.getNamedArgument("limit");
+        if (!utils::isNumeric(text) || std::stoul(text) == 0)
+        {
+            ConsoleApp::printError(fmt::format("parameter 'limit' has invalid value '{}'", text));
+            return;
+        }
+
+        limit = std::stoul(text);
+    }
+
+    const auto listing = dynamic_cast<const Listing*>(_listing.get());
+    if (!listing)
+    {
+        ConsoleApp::printWarning("only an unfiltered listing of a single sub can be exported");
+        return;
+    }
+
+    Exporter exporter{ _session, listing->endpoint(), listing->params() };
+    exporter.setDeduplicate(dedupMode());
+
+    if (args.hasArgument("fields"))
+    {
+        std::vector<std::string> fields;
+        boost::split(fields, args.getNamedArgument("fields"), boost::is_any_of(","), boost::token_compress_on);
+
+        for (const auto& field : fields)
+        {
+            // these go into the output as they are
+            if (field.empty() || !std::all_of(field.begin(), field.end(),
+                    [](char c) { return std::isalnum(static_cast<unsigned char>(c)) || c == '_'; }))
+            {
+                ConsoleApp::printError(fmt::format("invalid field name '{}'", field));
+                return;
+            }
+        }
+
+        exporter.setFields(std::move(fields));
+    }
+
+    const auto filename = args.getPositional(0);
+    std::ofstream out{ filename, std::ofstream::out | std::ofstream::trunc };
+    if (!out)
+    {
+        ConsoleApp::printError(fmt::format("could not open '{}'", filename));
+        return;
+    }
+
+    const auto stats = exporter.run(out, limit);
+    ConsoleApp::printStatus(fmt::format("exported {} item(s) from {} page(s) to '{}' ({} bytes)",
+        stats.items, stats.pages, filename, stats.bytes));
+
+    if (stats.duplicates > 0)
+    {
+        ConsoleApp::printStatus(fmt::format("left out {} item(s) that had already been exported", stats.duplicates));
+    }
+}
+
+void ConsoleApp::search(const std::string& params)
+{
+    static const std::string usage = "usage: search <words> [--limit=<count>]";
+
+    if (!_index)
+    {
+        ConsoleApp::printWarning("searching is turned off, see `command.search.index`");
+        return;
+    }
+
+    // a query has its own use for '-', so only the options go through SimpleArgs
+    std::vector<std::string> tokens;
+    boost::split(tokens, params, boost::is_any_of(" \t"), boost::token_compress_on);
+
+    std::string query;
+    std::string options;
+    for (const auto& token : tokens)
+    {
+        if (token.empty()) continue;
+
+        auto& target = boost::starts_with(token, "--") ? options : query;
+        if (!target.empty()) target.push_back(' ');
+        target.append(token);
+    }
+
+    if (query.empty())
+    {
+        ConsoleApp::printError(usage);
+        return;
+    }
+
+    SimpleArgs args{ options };
+
+    std::size_t limit = _settings.value("command.list.limit", 5u);
+    if (args.hasArgument("limit"))
+    {
+        auto limitstr = args.getNamedArgument("limit");
+        if (!utils::isNumeric(limitstr) || std::stoul(limitstr) == 0)
+        {
+            ConsoleApp::printError("parameter 'limit' has invalid value '" + limitstr + "'");
+            return;
+        }
+
+        limit = std::stoul(limitstr);
+    }
+
+    std::unique_ptr<SearchListing> listing;
+    try
+    {
+        listing = std::make_unique<SearchListing>(_index, query, limit);
+    }
+    catch (const std::invalid_argument& ex)
+    {
+        ConsoleApp::printError(ex.what());
+        return;
+    }
+
+    if (listing->matches() == 0)
+    {
+        ConsoleApp::printWarning(fmt::format("nothing matched '{}' in {} item(s)", query, _index->size()));
+        return;
+    }
+
+    ConsoleApp::printStatus(fmt::format("{} of {} item(s) matched '{}'",
+        listing->matches(), _index->size(), query));
+
+    if (listing->ranked() < listing->matches())
+    {
+        ConsoleApp::printStatus(fmt::format("only the best {} can be paged through", listing->ranked()));
+    }
+
+    // whatever the previous listing was still loading goes with it
+    settleListing();
+
+    _currentPage = listing->getFirstPage();
+    _listing = std::move(listing);
+
+    printListing();
+}
+
+void ConsoleApp::watch(const std::string& params)
+{
+    static const std::string usage = "usage: watch [<sub>,...] [--every=<interval>]";
+
+    SimpleArgs args{ params };
+    if (args.getPositionalCount() > 1)
+    {
+        ConsoleApp::printError(usage);
+        return;
+    }
+
+    std::vector<std::string> subs;
+    if (args.getPositionalCount() == 1)
+    {
+        boost::split(subs, args.getPositional(0), boost::is_any_of(","), boost::token_compress_on);
+        subs.erase(std::remove(subs.begin(), subs.end(), std::string{}), subs.end());
+    }
+    else
+    {
+        // only a subreddit can be watched, not wherever else we are
+        static const std::regex subRegex { R"(^\/r\/[a-zA-Z0-9_]+$)" };
+
+        if (const auto location = _session->location(); std::regex_match(location, subRegex))
+        {
+            subs.push_back(location);
+        }
+    }
+
+    if (subs.empty())
+    {
+        ConsoleApp::printError("there is nothing to watch, name a subreddit or `go` to one first");
+        return;
+    }
+
+    std::chrono::seconds interval{ _settings.value("command.watch.interval", 60u) };
+    if (args.hasArgument("every"))
+    {
+        const auto every = args.getNamedArgument("every");
+        const auto parsed = utils::parseDuration(every);
+        if (!parsed || parsed->count() == 0)
+        {
+            ConsoleApp::printError(fmt::format("parameter 'every' has invalid value '{}'", every));
+            return;
+        }
+
+        interval = *parsed;
+    }
+
+    Watcher watcher{ _session, subs, interval };
+    watcher.setIndex(_index);
+
+    if (watcher.interval() > interval)
+    {
+        ConsoleApp::printWarning(fmt::format("checking every {}s instead, to stay within reddit's rate limit",
+            watcher.interval().count()));
+    }
+
+    ConsoleApp::printStatus(fmt::format("watching {} subreddit(s) with {} request(s) every {}s, press any key to stop",
+        subs.size(), watcher.groups(), watcher.interval().count()));
+
+    std::size_t idx = 0;
+    while (true)
+    {
+        const auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(
+            watcher.nextPoll() - Watcher::Clock::now());
+
+        if (_terminal.waitForKey(std::max(wait, std::chrono::milliseconds::zero()))) break;
+
+        for (const auto& link : watcher.poll())
+        {
+            renderLink(link, ++idx);
+        }
+    }
+
+    const auto& stats = watcher.stats();
+    ConsoleApp::printStatus(fmt::format("{} new item(s) from {} request(s), {} of which failed",
+        stats.items, stats.requests, stats.errors));
+}
+
+void ConsoleApp::netstats(const std::string& params)
+{
+    static const std::string usage = "usage: netstats [reset]";
+
+    arcc::SimpleArgs args{ params };
+    if (args.getPositionalCount() == 1 && args.getPositional(0) == "reset")
+    {
+        NetStats::instance().reset();
+        printStatus("network statistics reset");
+        return;
+    }
+    else if (args.getPositionalCount() > 0)
+    {
+        ConsoleApp::printError(usage);
+        return;
+    }
+
+    const auto hosts = NetStats::instance().snapshot();
+    ConsoleApp::printStatus(fmt::format("{} host(s)", hosts.size()));
+
+    const auto printPhase = 
+        [](const std::string& name, const LatencyHistogram& histogram)
+        {
+            std::cout << fmt::format("  {:<12}{:>10.2f}{:>10.2f}{:>10.2f}{:>10.2f}\n",
+                name,
+                histogram.percentile(50) / 1000.0,
+                histogram.percentile(90) / 1000.0,
+                histogram.percentile(99) / 1000.0,
+                histogram.max() / 1000.0);
+        };
+
+    for (const auto& [host, stats] : hosts)
+    {
+        std::cout
+            << rang::style::bold
+            << host
+            << rang::style::reset
+            << fmt::format(" - {} request(s), {} error(s), {} bytes\n", 
+                stats.requests, stats.errors, stats.bytes);
+
+        std::cout << fmt::format("  {:<12}{:>10}{:>10}{:>10}{:>10}\n", "(ms)", "p50", "p90", "p99", "max");
+        printPhase("dns", stats.nameLookup);
+        printPhase("connect", stats.connect);
+        printPhase("tls", stats.tlsHandshake);
+        printPhase("first byte", stats.firstByte);
+        printPhase("total", stats.total);
+    }
+
+    const auto buffers = BufferPool::instance().stats();
+    std::cout << fmt::format("buffers: {} acquired, {} reused, {} reallocation(s); {} idle connection handle(s)",
+        buffers.acquired, buffers.reused, buffers.reallocations, HandlePool::instance().idleCount())
+        << std::endl;
+}
+
 } // namespace arcc
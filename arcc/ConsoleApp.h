@@ -10,6 +10,8 @@
 #include "Terminal.h"
 #include "CommandHistory.h"
 #include "Listing.h"
+#include "PostStore.h"
+#include "SearchIndex.h"
 #include "Settings.h"
 
 namespace arcc
@@ -44,9 +46,18 @@ class ConsoleApp final : public AppBase
 
     std::vector<ConsoleCommand>     _commands;
 
-    std::unique_ptr<Listing>        _listing;
+    std::unique_ptr<ListingBase>    _listing;
     Listing::Page                   _currentPage;
 
+    // the first page of a listing that was shown from the post store while
+    // reddit was asked for the latest, destroyed before `_listing` since
+    // it waits for the request
+    std::shared_ptr<PostStore>      _store;
+    std::future<Listing::Page>      _latest;
+
+    // every item fetched, for `search`, saved on the way out
+    std::shared_ptr<SearchIndex>    _index;
+
     bool                            _doExit = false;
 
     arcc::Settings&                         _settings;
@@ -73,6 +84,7 @@ public:
     void doExitApp() { _doExit = true; }
 
     bool setLocation(const std::string&);
+    void leaveListing();
     bool loadSession();
     void saveSession();
     void resetSession();
@@ -84,12 +96,19 @@ private:
     std::size_t printListing(const arcc::Listing& listing);
 
     void printListing();
-    void renderLink(const nlohmann::json& link, std::size_t idx);
+    void renderLink(const Link& link, std::size_t idx);
+    void printRawLink(const Link& link);
 
     void initCommands();
+    void initSession();
     void initTerminal();
+    void initStore();
+    void initIndex();
+    void saveIndex();
 
     void refreshSettings();
+    std::optional<SeenSet::Mode> dedupMode() const;
+    bool settleListing();
 
     void whoami();
     void list(const std::string& params);
@@ -99,6 +118,11 @@ private:
     void history(const std::string& params);
     void next(const std::string& params);
     void previous(const std::string& params);
+    void refresh(const std::string& params);
+    void netstats(const std::string& params);
+    void exportListing(const std::string& params);
+    void search(const std::string& params);
+    void watch(const std::string& params);
 
     void setCommand(const std::string& params);
     void settingsCommand(const std::string& params);
@@ -0,0 +1,83 @@
+// Another Reddit Console Client
+// Copyright (c) 2017-2019, Adalid Claure <aclaure@gmail.com>
+
+#include "JsonIndex.h"
+#include "Exporter.h"
+
+namespace arcc
+{
+
+Exporter::Exporter(RedditSessionPtr session, const std::string& endpoint, const Params& params)
+    : _sessionPtr{ session },
+      _endpoint{ endpoint },
+      _params{ params }
+{
+}
+
+void Exporter::setDeduplicate(std::optional<SeenSet::Mode> mode)
+{
+    _seen.reset();
+    if (mode)
+    {
+        _seen.emplace(*mode);
+    }
+}
+
+Exporter::Stats Exporter::run(std::ostream& out, std::size_t limit, std::size_t pageSize)
+{
+    Stats retval;
+    std::string line;
+
+    if (_seen) _seen->clear();
+
+    // a crawl should never hold up anything the user is waiting on, which
+    // is the stream's default
+    ListingStream stream{ _sessionPtr, _endpoint, limit, _params };
+    stream.setPageSize(pageSize);
+    stream.setKeepRaw(RawJson::TEXT);
+
+    for (const auto& link : stream)
+    {
+        if (link.text.empty()) continue;
+
+        if (_seen && !_seen->insert(link.name))
+        {
+            retval.duplicates++;
+            continue;
+        }
+
+        if (_fields.empty())
+        {
+            line.assign(link.text);
+        }
+        else
+        {
+            const JsonIndex index{ link.text };
+            const auto item = index.root();
+
+            line.assign("{");
+            for (const auto& field : _fields)
+            {
+                const auto value = item.find(field);
+                if (!value) continue;
+
+                if (line.size() > 1) line.push_back(',');
+                line.append("\"").append(field).append("\":").append(value->raw());
+            }
+            line.push_back('}');
+        }
+
+        line.push_back('\n');
+        out << line;
+
+        retval.items++;
+        retval.bytes += line.size();
+    }
+
+    retval.pages = stream.pagesFetched();
+
+    out.flush();
+    return retval;
+}
+
+} // namespace arcc
@@ -0,0 +1,58 @@
+// Another Reddit Console Client
+// Copyright (c) 2017-2019, Adalid Claure <aclaure@gmail.com>
+
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "Listing.h"
+#include "ListingStream.h"
+#include "SeenSet.h"
+
+namespace arcc
+{
+
+// Crawls a listing through a ListingStream and writes every item to a
+// stream as one line of JSON, the whole of the item's `data` or only the
+// selected fields. The items are never parsed, the text of each item (or
+// of the selected fields) is copied straight out of the response, so an
+// export costs little more than the download. The next pages are fetched
+// while the current one is written.
+class Exporter final
+{
+    RedditSessionPtr                _sessionPtr;
+    const std::string               _endpoint;
+    Params                          _params;
+    std::vector<std::string>        _fields;                // empty exports each item's whole `data`
+    std::optional<SeenSet>          _seen;                  // fullnames written so far, when deduplicating
+
+public:
+    struct Stats
+    {
+        std::size_t pages = 0;
+        std::size_t items = 0;
+        std::size_t bytes = 0;                              // written to the stream
+        std::size_t duplicates = 0;                         // items left out because they were written before
+    };
+
+    Exporter(RedditSessionPtr session, const std::string& endpoint, const Params& params = Params{});
+
+    const std::vector<std::string>& fields() const { return _fields; }
+    void setFields(std::vector<std::string> fields) { _fields = std::move(fields); }
+
+    // leave out items that were already written, which happens when the
+    // listing shifts between two pages; off by default
+    bool deduplicate() const { return _seen.has_value(); }
+    void setDeduplicate(std::optional<SeenSet::Mode> mode);
+
+    // writes up to `limit` items, asked for `pageSize` at a time, and
+    // stops early at the end of the listing or when a request fails,
+    // throws if a response was malformed
+    Stats run(std::ostream& out, std::size_t limit, std::size_t pageSize = ListingStream::MAX_PAGE_SIZE);
+};
+
+} // namespace arcc
@@ -0,0 +1,141 @@
+// Another Reddit Console Client
+// Copyright (c) 2017-2019, Adalid Claure <aclaure@gmail.com>
+
+#include "FilteredListing.h"
+
+namespace arcc
+{
+
+FilteredListing::FilteredListing(std::unique_ptr<ListingBase> listing, LinkFilter filter, std::size_t limit)
+    : _listing{ std::move(listing) },
+      _filter{ std::move(filter) },
+      _limit{ limit }
+{
+    // what a listing fetches for us is not what `list` shows for its
+    // endpoint, so it must not be saved as that
+    if (auto inner = dynamic_cast<Listing*>(_listing.get()); inner)
+    {
+        inner->setStore(nullptr);
+    }
+}
+
+LinkPage FilteredListing::getFirstPage()
+{
+    _pages.clear();
+    _collected = 0;
+    _current = 0;
+
+    restart();
+
+    auto page = collect();
+    if (!page.empty())
+    {
+        _pages.put(0, page, page.memoryUsage());
+        _collected = 1;
+    }
+
+    return page;
+}
+
+LinkPage FilteredListing::getNextPage()
+{
+    if (_collected == 0) return LinkPage{};
+
+    if (_current + 1 < _collected)
+    {
+        return pageAt(++_current);
+    }
+
+    auto page = collect();
+    if (!page.empty())
+    {
+        _current = _collected++;
+        _pages.put(_current, page, page.memoryUsage());
+    }
+
+    return page;
+}
+
+LinkPage FilteredListing::getPreviousPage()
+{
+    if (_collected == 0 || _current == 0) return LinkPage{};
+    return pageAt(--_current);
+}
+
+LinkPage FilteredListing::refresh()
+{
+    return getFirstPage();
+}
+
+void FilteredListing::restart()
+{
+    _scanned = 0;
+    _exhausted = false;
+
+    take(_listing->getFirstPage());
+}
+
+LinkPage FilteredListing::pageAt(std::size_t index)
+{
+    if (const auto cached = _pages.get(index); cached)
+    {
+        return *cached;
+    }
+
+    // the listing underneath has moved on, filter it again up to this
+    // page and carry on from there
+    restart();
+
+    LinkPage page;
+    for (std::size_t i = 0; i <= index; i++)
+    {
+        page = collect();
+        _pages.put(i, page, page.memoryUsage());
+    }
+
+    _collected = index + 1;
+    return page;
+}
+
+void FilteredListing::take(LinkPage page)
+{
+    _source = std::move(page);
+    _next = 0;
+
+    if (_source.empty())
+    {
+        _matches.clear();
+        _exhausted = true;
+        return;
+    }
+
+    _scanned++;
+    _filter.select(_source, _matches);
+}
+
+LinkPage FilteredListing::collect()
+{
+    LinkPage retval;
+    retval.reserve(_limit);
+
+    // pages in a row that had no matches
+    std::size_t misses = 0;
+
+    while (retval.size() < _limit)
+    {
+        if (_next < _matches.size())
+        {
+            retval.append(_source[_matches[_next++]]);
+            continue;
+        }
+
+        if (_exhausted || misses >= _maxScan) break;
+
+        take(_listing->getNextPage());
+        misses = _matches.empty() ? misses + 1 : 0;
+    }
+
+    return retval;
+}
+
+} // namespace arcc
@@ -0,0 +1,80 @@
+// Another Reddit Console Client
+// Copyright (c) 2017-2019, Adalid Claure <aclaure@gmail.com>
+
+#pragma once
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "LinkFilter.h"
+#include "Listing.h"
+#include "LruCache.h"
+
+namespace arcc
+{
+
+// Shows only the items of another listing that match a filter, in pages of
+// `limit` items. When the filter throws most of a page away the listing
+// underneath is asked for more pages until there are `limit` matches, it
+// runs out, or `maxScan` pages in a row had nothing to offer. A Listing
+// underneath no longer saves its pages to the post store.
+class FilteredListing final : public ListingBase
+{
+public:
+    static constexpr std::size_t DEFAULT_MAX_SCAN = 10;
+
+private:
+    std::unique_ptr<ListingBase>    _listing;
+    LinkFilter                      _filter;
+    const std::size_t               _limit;
+    std::size_t                     _maxScan = DEFAULT_MAX_SCAN;
+
+    LinkPage                        _source;                // the page being filtered
+    std::vector<std::uint32_t>      _matches;               // indices of its matches
+    std::size_t                     _next = 0;              // next one to show
+    bool                            _exhausted = false;     // the listing underneath has no more
+
+    // filtered pages keyed by their index, with the same budget as a Listing
+    LruCache<std::size_t, LinkPage> _pages{ Listing::DEFAULT_CACHE_SIZE };
+    std::size_t                     _collected = 0;         // pages filtered so far
+    std::size_t                     _current = 0;           // index of the page shown
+    std::size_t                     _scanned = 0;           // pages of the listing underneath
+
+public:
+    FilteredListing(std::unique_ptr<ListingBase> listing, LinkFilter filter, std::size_t limit);
+
+    LinkPage getFirstPage() override;
+    LinkPage getNextPage() override;
+    LinkPage getPreviousPage() override;
+
+    // starts over from the first page
+    LinkPage refresh() override;
+
+    void cancelPrefetch() override { _listing->cancelPrefetch(); }
+
+    void setMaxScan(std::size_t pages) { _maxScan = std::max<std::size_t>(pages, 1); }
+
+    // memory the filtered pages may use, in bytes (roughly)
+    std::size_t cacheSize() const { return _pages.maxCost(); }
+    void setCacheSize(std::size_t bytes) { _pages.setMaxCost(bytes); }
+
+    const LinkFilter& filter() const { return _filter; }
+    std::size_t limit() const { return _limit; }
+
+    // pages fetched from the listing underneath so far
+    std::size_t scanned() const { return _scanned; }
+
+private:
+    // the listing underneath back at its first page
+    void restart();
+
+    // the page at `index`, filtered over again from the start if it has
+    // been dropped from the cache
+    LinkPage pageAt(std::size_t index);
+
+    void take(LinkPage page);
+    LinkPage collect();
+};
+
+} // namespace arcc
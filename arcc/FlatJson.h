@@ -0,0 +1,177 @@
+// Another Reddit Console Client
+// Copyright (c) 2017-2019, Adalid Claure <aclaure@gmail.com>
+
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+namespace arcc
+{
+
+// An object type for nlohmann::basic_json that keeps its members in one
+// vector sorted by key instead of a node per member in a std::map. A reddit
+// child has around a hundred members, and finding one is then a binary
+// search over contiguous memory rather than a walk down a red-black tree.
+// Members come out in the same order as from a std::map, so dump() writes
+// the same text. Inserting in the middle moves the members behind it, which
+// is cheap for objects the size of a listing child.
+template<typename Key, typename T, typename IgnoredLess = std::less<>,
+    typename Allocator = std::allocator<std::pair<const Key, T>>>
+class FlatMap : public std::vector<std::pair<Key, T>,
+    typename std::allocator_traits<Allocator>::template rebind_alloc<std::pair<Key, T>>>
+{
+public:
+    using key_type = Key;
+    using mapped_type = T;
+    using key_compare = std::less<>;
+    using Container = std::vector<std::pair<Key, T>,
+        typename std::allocator_traits<Allocator>::template rebind_alloc<std::pair<Key, T>>>;
+    using iterator = typename Container::iterator;
+    using const_iterator = typename Container::const_iterator;
+    using size_type = typename Container::size_type;
+    using value_type = typename Container::value_type;
+
+private:
+    // anything a key can be compared with, but not an iterator so that
+    // erase(iterator) still means the vector's erase
+    template<typename K>
+    using IfKey = std::enable_if_t<!std::is_convertible_v<K, const_iterator>, int>;
+
+public:
+    using Container::erase;
+
+    FlatMap() = default;
+
+    template<typename It>
+    FlatMap(It first, It last)
+    {
+        insert(first, last);
+    }
+
+    FlatMap(std::initializer_list<value_type> init)
+        : FlatMap(init.begin(), init.end())
+    {
+    }
+
+    template<typename K, typename... Args>
+    std::pair<iterator, bool> emplace(K&& key, Args&&... args)
+    {
+        auto it = lowerBound(key);
+        if (it != this->end() && !key_compare{}(key, it->first))
+        {
+            return { it, false };
+        }
+
+        it = Container::emplace(it, std::piecewise_construct,
+            std::forward_as_tuple(std::forward<K>(key)),
+            std::forward_as_tuple(std::forward<Args>(args)...));
+
+        return { it, true };
+    }
+
+    template<typename K>
+    T& operator[](K&& key)
+    {
+        return emplace(std::forward<K>(key)).first->second;
+    }
+
+    template<typename K>
+    const T& operator[](const K& key) const
+    {
+        return at(key);
+    }
+
+    template<typename K>
+    T& at(const K& key)
+    {
+        if (const auto it = find(key); it != this->end()) return it->second;
+        throw std::out_of_range("key not found");
+    }
+
+    template<typename K>
+    const T& at(const K& key) const
+    {
+        if (const auto it = find(key); it != this->end()) return it->second;
+        throw std::out_of_range("key not found");
+    }
+
+    template<typename K>
+    iterator find(const K& key)
+    {
+        const auto it = lowerBound(key);
+        return it != this->end() && !key_compare{}(key, it->first) ? it : this->end();
+    }
+
+    template<typename K>
+    const_iterator find(const K& key) const
+    {
+        return const_cast<FlatMap*>(this)->find(key);
+    }
+
+    template<typename K>
+    size_type count(const K& key) const
+    {
+        return find(key) != this->end() ? 1 : 0;
+    }
+
+    template<typename K, IfKey<K> = 0>
+    size_type erase(const K& key)
+    {
+        if (const auto it = find(key); it != this->end())
+        {
+            Container::erase(it);
+            return 1;
+        }
+
+        return 0;
+    }
+
+    std::pair<iterator, bool> insert(value_type&& value)
+    {
+        return emplace(std::move(value.first), std::move(value.second));
+    }
+
+    std::pair<iterator, bool> insert(const value_type& value)
+    {
+        return emplace(value.first, value.second);
+    }
+
+    template<typename It>
+    void insert(It first, It last)
+    {
+        for (; first != last; ++first)
+        {
+            emplace(first->first, first->second);
+        }
+    }
+
+private:
+    template<typename K>
+    iterator lowerBound(const K& key)
+    {
+        // members usually arrive in order when copying another object
+        if (this->empty() || key_compare{}(this->back().first, key))
+        {
+            return this->end();
+        }
+
+        return std::lower_bound(this->begin(), this->end(), key,
+            [](const value_type& member, const K& k) { return key_compare{}(member.first, k); });
+    }
+};
+
+// JSON whose objects are FlatMaps, used for the raw listing items a Link
+// can hold on to
+using FlatJson = nlohmann::basic_json<FlatMap>;
+
+} // namespace arcc
@@ -0,0 +1,107 @@
+// Another Reddit Console Client
+// Copyright (c) 2017-2019, Adalid Claure <aclaure@gmail.com>
+
+#include "HandlePool.h"
+
+namespace arcc
+{
+
+namespace
+{
+    // anything beyond this is cleaned up rather than kept warm
+    constexpr std::size_t MAX_IDLE_HANDLES = 16;
+}
+
+CURLcode curlGlobalInit()
+{
+    return curl_global_init(CURL_GLOBAL_ALL);
+}
+
+HandlePool& HandlePool::instance()
+{
+    static HandlePool pool;
+    return pool;
+}
+
+HandlePool::HandlePool()
+{
+    static CURLcode __global = curlGlobalInit();
+    (void)__global; // silence unused warnings
+
+    _share = curl_share_init();
+    curl_share_setopt(_share, CURLSHOPT_LOCKFUNC, &HandlePool::lock);
+    curl_share_setopt(_share, CURLSHOPT_UNLOCKFUNC, &HandlePool::unlock);
+    curl_share_setopt(_share, CURLSHOPT_USERDATA, this);
+
+    curl_share_setopt(_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    curl_share_setopt(_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+    curl_share_setopt(_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+    curl_share_setopt(_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_COOKIE);
+}
+
+HandlePool::~HandlePool()
+{
+    for (auto handle : _idle)
+    {
+        curl_easy_cleanup(handle);
+    }
+
+    curl_share_cleanup(_share);
+}
+
+CURL* HandlePool::acquire()
+{
+    {
+        std::lock_guard<std::mutex> guard{ _mutex };
+        if (!_idle.empty())
+        {
+            CURL* handle = _idle.back();
+            _idle.pop_back();
+            return handle;
+        }
+    }
+
+    CURL* handle = curl_easy_init();
+    curl_easy_setopt(handle, CURLOPT_SHARE, _share);
+    return handle;
+}
+
+void HandlePool::release(CURL* handle)
+{
+    if (handle == nullptr) return;
+
+    // a reset keeps the live connections, DNS and TLS session caches
+    // as well as the share, but drops all per-request options
+    curl_easy_reset(handle);
+
+    {
+        std::lock_guard<std::mutex> guard{ _mutex };
+        if (_idle.size() < MAX_IDLE_HANDLES)
+        {
+            _idle.push_back(handle);
+            return;
+        }
+    }
+
+    curl_easy_cleanup(handle);
+}
+
+std::size_t HandlePool::idleCount()
+{
+    std::lock_guard<std::mutex> guard{ _mutex };
+    return _idle.size();
+}
+
+void HandlePool::lock(CURL*, curl_lock_data data, curl_lock_access, void* userptr)
+{
+    auto pool = static_cast<HandlePool*>(userptr);
+    pool->_locks.at(static_cast<std::size_t>(data)).lock();
+}
+
+void HandlePool::unlock(CURL*, curl_lock_data data, void* userptr)
+{
+    auto pool = static_cast<HandlePool*>(userptr);
+    pool->_locks.at(static_cast<std::size_t>(data)).unlock();
+}
+
+} // namespace arcc
@@ -0,0 +1,46 @@
+// Another Reddit Console Client
+// Copyright (c) 2017-2019, Adalid Claure <aclaure@gmail.com>
+
+#pragma once
+
+#include <array>
+#include <mutex>
+#include <vector>
+
+#include <curl/curl.h>
+
+namespace arcc
+{
+
+// Process wide pool of curl easy handles. Every handle is attached to the
+// same CURLSH so the DNS cache, TLS sessions, cookies and live connections
+// are reused no matter which WebClient made the request. Released handles
+// are reset and kept around so the next request starts with a warm handle.
+class HandlePool final
+{
+    CURLSH*                                     _share;
+    std::array<std::mutex, CURL_LOCK_DATA_LAST> _locks;     // one per CURL_LOCK_DATA_* type
+
+    std::mutex                                  _mutex;
+    std::vector<CURL*>                          _idle;      // guarded by _mutex
+
+public:
+    static HandlePool& instance();
+
+    HandlePool();
+    ~HandlePool();
+
+    HandlePool(const HandlePool&) = delete;
+    HandlePool& operator=(const HandlePool&) = delete;
+
+    CURL* acquire();
+    void release(CURL* handle);
+
+    std::size_t idleCount();
+
+private:
+    static void lock(CURL*, curl_lock_data data, curl_lock_access, void* userptr);
+    static void unlock(CURL*, curl_lock_data data, void* userptr);
+};
+
+} // namespace arcc
@@ -0,0 +1,546 @@
+// Another Reddit Console Client
+// Copyright (c) 2017-2019, Adalid Claure <aclaure@gmail.com>
+
+#include <bit>
+#include <cstring>
+#include <limits>
+
+#include "JsonIndex.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#   define ARCC_JSON_SSE2
+#   include <emmintrin.h>
+#   if defined(__GNUC__) || defined(__clang__)
+        // compiled for AVX2 on its own and only called if the CPU has it
+#       define ARCC_JSON_AVX2
+#       include <immintrin.h>
+#   endif
+#endif
+
+namespace arcc
+{
+
+namespace
+{
+
+constexpr std::size_t BLOCK_SIZE = 64;
+
+// where the interesting characters are in one block, one bit per byte
+struct BlockMasks
+{
+    std::uint64_t   quotes = 0;
+    std::uint64_t   backslashes = 0;
+    std::uint64_t   operators = 0;              // { } [ ] : ,
+};
+
+BlockMasks classifyScalar(const char* block)
+{
+    BlockMasks retval;
+
+    for (std::size_t i = 0; i < BLOCK_SIZE; i++)
+    {
+        const std::uint64_t bit = std::uint64_t{ 1 } << i;
+        switch (block[i])
+        {
+            case '"': retval.quotes |= bit; break;
+            case '\\': retval.backslashes |= bit; break;
+
+            case '{': case '}':
+            case '[': case ']':
+            case ':': case ',':
+                retval.operators |= bit;
+            break;
+
+            default:
+            break;
+        }
+    }
+
+    return retval;
+}
+
+#ifdef ARCC_JSON_SSE2
+BlockMasks classifySse2(const char* block)
+{
+    const auto quote = _mm_set1_epi8('"');
+    const auto backslash = _mm_set1_epi8('\\');
+
+    BlockMasks retval;
+    for (std::size_t i = 0; i < BLOCK_SIZE; i += 16)
+    {
+        const auto chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + i));
+
+        const auto ops = _mm_or_si128(
+            _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('{')), _mm_cmpeq_epi8(chunk, _mm_set1_epi8('}'))),
+                _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('[')), _mm_cmpeq_epi8(chunk, _mm_set1_epi8(']')))),
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(':')), _mm_cmpeq_epi8(chunk, _mm_set1_epi8(','))));
+
+        const auto shift = static_cast<unsigned>(i);
+        retval.quotes |= std::uint64_t{ static_cast<std::uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, quote))) } << shift;
+        retval.backslashes |= std::uint64_t{ static_cast<std::uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, backslash))) } << shift;
+        retval.operators |= std::uint64_t{ static_cast<std::uint16_t>(_mm_movemask_epi8(ops)) } << shift;
+    }
+
+    return retval;
+}
+#endif
+
+#ifdef ARCC_JSON_AVX2
+__attribute__((target("avx2")))
+BlockMasks classifyAvx2(const char* block)
+{
+    const auto quote = _mm256_set1_epi8('"');
+    const auto backslash = _mm256_set1_epi8('\\');
+
+    BlockMasks retval;
+    for (std::size_t i = 0; i < BLOCK_SIZE; i += 32)
+    {
+        const auto chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + i));
+
+        const auto ops = _mm256_or_si256(
+            _mm256_or_si256(
+                _mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('{')), _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('}'))),
+                _mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('[')), _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(']')))),
+            _mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(':')), _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(','))));
+
+        const auto shift = static_cast<unsigned>(i);
+        retval.quotes |= std::uint64_t{ static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, quote))) } << shift;
+        retval.backslashes |= std::uint64_t{ static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, backslash))) } << shift;
+        retval.operators |= std::uint64_t{ static_cast<std::uint32_t>(_mm256_movemask_epi8(ops)) } << shift;
+    }
+
+    return retval;
+}
+#endif
+
+// bit i of the result is the xor of bits 0..i, which turns quote positions
+// into a mask that is set from an opening quote up to its closing quote
+std::uint64_t prefixXor(std::uint64_t bits)
+{
+    bits ^= bits << 1;
+    bits ^= bits << 2;
+    bits ^= bits << 4;
+    bits ^= bits << 8;
+    bits ^= bits << 16;
+    bits ^= bits << 32;
+    return bits;
+}
+
+void appendUtf8(std::string& out, std::uint32_t cp)
+{
+    if (cp < 0x80)
+    {
+        out.push_back(static_cast<char>(cp));
+    }
+    else if (cp < 0x800)
+    {
+        out.push_back(static_cast<char>(0xC0 | (cp >> 6)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    }
+    else if (cp < 0x10000)
+    {
+        out.push_back(static_cast<char>(0xE0 | (cp >> 12)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    }
+    else
+    {
+        out.push_back(static_cast<char>(0xF0 | (cp >> 18)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    }
+}
+
+bool parseHex4(std::string_view text, std::uint32_t& value)
+{
+    if (text.size() < 4) return false;
+
+    const auto [ptr, ec] = std::from_chars(text.data(), text.data() + 4, value, 16);
+    return ec == std::errc{} && ptr == text.data() + 4;
+}
+
+} // namespace
+
+JsonIndex::JsonIndex(std::string_view text, Kernel kernel)
+    : _text{ text }
+{
+    // offsets are 32 bit to keep the tape small
+    if (text.size() >= std::numeric_limits<std::uint32_t>::max()) return;
+
+    buildTape(supported(kernel) ? kernel : Kernel::SCALAR);
+    if (_valid) matchBrackets();
+}
+
+JsonIndex::Kernel JsonIndex::bestKernel()
+{
+    if (supported(Kernel::AVX2)) return Kernel::AVX2;
+    if (supported(Kernel::SSE2)) return Kernel::SSE2;
+    return Kernel::SCALAR;
+}
+
+bool JsonIndex::supported(Kernel kernel)
+{
+    switch (kernel)
+    {
+        case Kernel::SCALAR:
+            return true;
+
+        case Kernel::SSE2:
+#ifdef ARCC_JSON_SSE2
+            return true;
+#else
+            return false;
+#endif
+
+        case Kernel::AVX2:
+#ifdef ARCC_JSON_AVX2
+            return __builtin_cpu_supports("avx2");
+#else
+            return false;
+#endif
+    }
+
+    return false;
+}
+
+void JsonIndex::buildTape(Kernel kernel)
+{
+    // most of a reddit response is text, a structural every 8 bytes is plenty
+    _tape.reserve(_text.size() / 8);
+
+    std::uint64_t inString = 0;                 // all ones if the last block ended inside a string
+    std::uint64_t escapeCarry = 0;              // the first byte of this block is escaped
+
+    for (std::size_t offset = 0; offset < _text.size(); offset += BLOCK_SIZE)
+    {
+        const char* block = _text.data() + offset;
+
+        // the kernels always read a whole block, pad the last one with spaces
+        char padded[BLOCK_SIZE];
+        if (_text.size() - offset < BLOCK_SIZE)
+        {
+            std::memset(padded, ' ', BLOCK_SIZE);
+            std::memcpy(padded, block, _text.size() - offset);
+            block = padded;
+        }
+
+        BlockMasks masks;
+        switch (kernel)
+        {
+#ifdef ARCC_JSON_AVX2
+            case Kernel::AVX2: masks = classifyAvx2(block); break;
+#endif
+#ifdef ARCC_JSON_SSE2
+            case Kernel::SSE2: masks = classifySse2(block); break;
+#endif
+            default: masks = classifyScalar(block); break;
+        }
+
+        // backslashes are rare enough that walking them one by one is fine,
+        // a backslash escapes the next byte unless it is escaped itself
+        std::uint64_t escaped = escapeCarry;
+        escapeCarry = 0;
+
+        for (auto bits = masks.backslashes; bits != 0; bits &= bits - 1)
+        {
+            const auto pos = std::countr_zero(bits);
+            if ((escaped >> pos) & 1) continue;
+
+            if (pos == BLOCK_SIZE - 1)
+            {
+                escapeCarry = 1;
+            }
+            else
+            {
+                escaped |= std::uint64_t{ 1 } << (pos + 1);
+            }
+        }
+
+        const auto quotes = masks.quotes & ~escaped;
+        const auto strings = prefixXor(quotes) ^ inString;
+        inString = static_cast<std::uint64_t>(static_cast<std::int64_t>(strings) >> 63);
+
+        for (auto bits = (masks.operators & ~strings) | quotes; bits != 0; bits &= bits - 1)
+        {
+            _tape.push_back(static_cast<std::uint32_t>(offset + std::countr_zero(bits)));
+        }
+    }
+
+    _valid = (inString == 0);
+}
+
+void JsonIndex::matchBrackets()
+{
+    _jumps.assign(_tape.size(), 0);
+
+    std::vector<std::uint32_t> open;
+    for (std::uint32_t i = 0; i < _tape.size(); i++)
+    {
+        const char c = _text[_tape[i]];
+        if (c == '{' || c == '[')
+        {
+            open.push_back(i);
+        }
+        else if (c == '}' || c == ']')
+        {
+            if (open.empty() || _text[_tape[open.back()]] != (c == '}' ? '{' : '['))
+            {
+                _valid = false;
+                return;
+            }
+
+            _jumps[open.back()] = i;
+            open.pop_back();
+        }
+    }
+
+    _valid = open.empty();
+}
+
+std::size_t JsonIndex::skipWhitespace(std::size_t pos) const
+{
+    while (pos < _text.size()
+        && (_text[pos] == ' ' || _text[pos] == '\n' || _text[pos] == '\r' || _text[pos] == '\t'))
+    {
+        pos++;
+    }
+
+    return pos;
+}
+
+JsonIndex::Value JsonIndex::root() const
+{
+    if (!_valid) return Value{};
+
+    if (auto retval = valueAt(0, 0, {}); retval)
+    {
+        return *retval;
+    }
+
+    return Value{};
+}
+
+std::optional<JsonIndex::Value> JsonIndex::valueAt(std::size_t textPos, std::uint32_t tapePos, std::optional<std::string_view> key) const
+{
+    const auto begin = skipWhitespace(textPos);
+    if (begin >= _text.size()) return {};
+
+    Value retval;
+    retval._index = this;
+    retval._key = key.value_or(std::string_view{});
+    retval._member = key.has_value();
+    retval._begin = static_cast<std::uint32_t>(begin);
+    retval._tape = tapePos;
+
+    const bool onTape = tapePos < _tape.size() && _tape[tapePos] == begin;
+    const char c = _text[begin];
+
+    if (onTape && (c == '{' || c == '['))
+    {
+        const auto close = _jumps[tapePos];
+        retval._end = _tape[close] + 1;
+        retval._after = close + 1;
+    }
+    else if (onTape && c == '"')
+    {
+        if (tapePos + 1 >= _tape.size()) return {};
+
+        retval._end = _tape[tapePos + 1] + 1;
+        retval._after = tapePos + 2;
+    }
+    else if (!onTape)
+    {
+        // a number or literal runs up to the next structural
+        auto end = tapePos < _tape.size() ? _tape[tapePos] : _text.size();
+        while (end > begin && (_text[end - 1] == ' ' || _text[end - 1] == '\n' || _text[end - 1] == '\r' || _text[end - 1] == '\t'))
+        {
+            end--;
+        }
+
+        if (end == begin) return {};
+
+        retval._end = static_cast<std::uint32_t>(end);
+        retval._after = tapePos;
+    }
+    else
+    {
+        // a stray `:`, `,` or closing bracket where a value should be
+        return {};
+    }
+
+    return retval;
+}
+
+bool JsonIndex::unescape(std::string_view raw, std::string& out)
+{
+    out.clear();
+    out.reserve(raw.size());
+
+    for (std::size_t i = 0; i < raw.size(); i++)
+    {
+        if (raw[i] != '\\')
+        {
+            out.push_back(raw[i]);
+            continue;
+        }
+
+        if (++i == raw.size()) return false;
+
+        switch (raw[i])
+        {
+            case '"': out.push_back('"'); break;
+            case '\\': out.push_back('\\'); break;
+            case '/': out.push_back('/'); break;
+            case 'b': out.push_back('\b'); break;
+            case 'f': out.push_back('\f'); break;
+            case 'n': out.push_back('\n'); break;
+            case 'r': out.push_back('\r'); break;
+            case 't': out.push_back('\t'); break;
+
+            case 'u':
+            {
+                std::uint32_t cp = 0;
+                if (!parseHex4(raw.substr(i + 1), cp)) return false;
+                i += 4;
+
+                // characters outside the BMP come as a surrogate pair
+                if (cp >= 0xD800 && cp < 0xDC00)
+                {
+                    std::uint32_t low = 0;
+                    if (raw.substr(i + 1, 2) != "\\u" || !parseHex4(raw.substr(i + 3), low)
+                        || low < 0xDC00 || low > 0xDFFF)
+                    {
+                        return false;
+                    }
+
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                    i += 6;
+                }
+
+                appendUtf8(out, cp);
+            }
+            break;
+
+            default:
+                return false;
+        }
+    }
+
+    return true;
+}
+
+JsonIndex::Value::Type JsonIndex::Value::type() const
+{
+    if (_index == nullptr) return Type::NULLVALUE;
+
+    switch (_index->_text[_begin])
+    {
+        case '{': return Type::OBJECT;
+        case '[': return Type::ARRAY;
+        case '"': return Type::STRING;
+        case 't': case 'f': return Type::BOOLEAN;
+        case 'n': return Type::NULLVALUE;
+        default: return Type::NUMBER;
+    }
+}
+
+std::string_view JsonIndex::Value::raw() const
+{
+    if (_index == nullptr) return "null";
+    return _index->_text.substr(_begin, _end - _begin);
+}
+
+std::optional<JsonIndex::Value> JsonIndex::Value::first() const
+{
+    const auto kind = type();
+    if (kind != Type::OBJECT && kind != Type::ARRAY) return {};
+
+    const auto& tape = _index->_tape;
+    const auto& text = _index->_text;
+    const auto close = _index->_jumps[_tape];
+
+    if (_tape + 1 == close) return {};
+
+    if (kind == Type::ARRAY)
+    {
+        return _index->valueAt(tape[_tape] + 1, _tape + 1, {});
+    }
+
+    // `"key"` `:` value, the key's quotes are two entries on the tape
+    const auto keyOpen = _tape + 1;
+    if (keyOpen + 2 >= close || text[tape[keyOpen]] != '"' || text[tape[keyOpen + 2]] != ':') return {};
+
+    const auto key = text.substr(tape[keyOpen] + 1, tape[keyOpen + 1] - tape[keyOpen] - 1);
+    return _index->valueAt(tape[keyOpen + 2] + 1, keyOpen + 3, key);
+}
+
+std::optional<JsonIndex::Value> JsonIndex::Value::next() const
+{
+    if (_index == nullptr) return {};
+
+    const auto& tape = _index->_tape;
+    const auto& text = _index->_text;
+
+    if (_after >= tape.size() || text[tape[_after]] != ',') return {};
+
+    const auto start = _after + 1;
+    if (!_member)
+    {
+        return _index->valueAt(tape[_after] + 1, start, {});
+    }
+
+    if (start + 2 >= tape.size() || text[tape[start]] != '"' || text[tape[start + 2]] != ':') return {};
+
+    const auto key = text.substr(tape[start] + 1, tape[start + 1] - tape[start] - 1);
+    return _index->valueAt(tape[start + 2] + 1, start + 3, key);
+}
+
+std::optional<JsonIndex::Value> JsonIndex::Value::find(std::string_view key) const
+{
+    if (type() != Type::OBJECT) return {};
+
+    for (auto member = first(); member; member = member->next())
+    {
+        if (member->_key == key) return member;
+    }
+
+    return {};
+}
+
+std::size_t JsonIndex::Value::size() const
+{
+    std::size_t retval = 0;
+    for (auto child = first(); child; child = child->next())
+    {
+        retval++;
+    }
+
+    return retval;
+}
+
+std::string_view JsonIndex::Value::rawString() const
+{
+    if (type() != Type::STRING) return {};
+    return _index->_text.substr(_begin + 1, _end - _begin - 2);
+}
+
+std::string JsonIndex::Value::string() const
+{
+    std::string retval;
+
+    const auto text = rawString();
+    if (text.find('\\') == std::string_view::npos)
+    {
+        retval.assign(text);
+    }
+    else if (!unescape(text, retval))
+    {
+        retval.clear();
+    }
+
+    return retval;
+}
+
+} // namespace arcc
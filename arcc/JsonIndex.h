@@ -0,0 +1,165 @@
+// Another Reddit Console Client
+// Copyright (c) 2017-2019, Adalid Claure <aclaure@gmail.com>
+
+#pragma once
+
+#include <charconv>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace arcc
+{
+
+// An index over a JSON text that lets callers pick values out of it without
+// parsing the whole thing into a DOM. Building the index is a single pass
+// that finds every brace, bracket, colon, comma and quote outside of a
+// string, 64 bytes at a time with SSE2 or AVX2 where the CPU has them. The
+// positions go on a tape along with where each object and array ends, so
+// anything a caller does not ask for is stepped over in constant time.
+// Values are only decoded once a caller reaches them through a Value.
+// The index points into the text, which has to outlive it.
+class JsonIndex final
+{
+public:
+    enum class Kernel
+    {
+        SCALAR,
+        SSE2,
+        AVX2
+    };
+
+    class Value;
+
+private:
+    std::string_view                _text;
+    std::vector<std::uint32_t>      _tape;      // text offsets of the structural characters
+    std::vector<std::uint32_t>      _jumps;     // for `{` and `[`, the tape index of the match
+    bool                            _valid = false;
+
+public:
+    explicit JsonIndex(std::string_view text, Kernel kernel = bestKernel());
+
+    JsonIndex(const JsonIndex&) = delete;
+    JsonIndex& operator=(const JsonIndex&) = delete;
+
+    // the fastest kernel this CPU can run
+    static Kernel bestKernel();
+    static bool supported(Kernel kernel);
+
+    // false if quotes, braces or brackets don't match up, a Value from an
+    // invalid index is null
+    bool valid() const { return _valid; }
+
+    Value root() const;
+
+    std::string_view text() const { return _text; }
+    const std::vector<std::uint32_t>& tape() const { return _tape; }
+
+    // `raw` is the text between the quotes of a string
+    static bool unescape(std::string_view raw, std::string& out);
+
+private:
+    void buildTape(Kernel kernel);
+    void matchBrackets();
+
+    std::size_t skipWhitespace(std::size_t pos) const;
+    std::optional<Value> valueAt(std::size_t textPos, std::uint32_t tapePos, std::optional<std::string_view> key) const;
+};
+
+// A cheap handle on one value in a JsonIndex, copy it around freely.
+class JsonIndex::Value final
+{
+    friend class JsonIndex;
+
+    const JsonIndex*    _index = nullptr;
+    std::string_view    _key;                   // raw key when this is an object member
+    bool                _member = false;
+    std::uint32_t       _begin = 0;             // text range of the value
+    std::uint32_t       _end = 0;
+    std::uint32_t       _tape = 0;              // tape index of the value's first structural
+    std::uint32_t       _after = 0;             // tape index just past the value
+
+public:
+    enum class Type
+    {
+        NULLVALUE,
+        BOOLEAN,
+        NUMBER,
+        STRING,
+        ARRAY,
+        OBJECT
+    };
+
+    Value() = default;
+
+    Type type() const;
+    bool isNull() const { return type() == Type::NULLVALUE; }
+    bool isString() const { return type() == Type::STRING; }
+    bool isObject() const { return type() == Type::OBJECT; }
+    bool isArray() const { return type() == Type::ARRAY; }
+
+    // the value's JSON text, exactly as it appears in the document
+    std::string_view raw() const;
+
+    // the key of an object member, still escaped
+    std::string_view key() const { return _key; }
+
+    // the first member of an object or element of an array, and the one
+    // that follows this value in its parent
+    std::optional<Value> first() const;
+    std::optional<Value> next() const;
+
+    template<typename F>
+    void forEach(F&& f) const
+    {
+        for (auto child = first(); child; child = child->next())
+        {
+            f(*child);
+        }
+    }
+
+    // looks a member up by its raw key, skipping over every other member
+    std::optional<Value> find(std::string_view key) const;
+
+    // number of members or elements
+    std::size_t size() const;
+
+    // the text between the quotes of a string, still escaped
+    std::string_view rawString() const;
+
+    // unescaped, empty if this is not a string
+    std::string string() const;
+
+    bool boolean() const { return raw() == "true"; }
+
+    // zero if this is not a number, floats are truncated for integral types
+    template<typename T>
+    T number() const
+    {
+        static_assert(std::is_arithmetic_v<T>);
+        if (type() != Type::NUMBER) return T{};
+
+        const auto text = raw();
+        double value = 0;
+        if (const auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+            ec != std::errc{})
+        {
+            return T{};
+        }
+
+        if constexpr (std::is_unsigned_v<T>)
+        {
+            return value > 0 ? static_cast<T>(value) : T{};
+        }
+        else
+        {
+            return static_cast<T>(value);
+        }
+    }
+};
+
+} // namespace arcc
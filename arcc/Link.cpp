@@ -0,0 +1,217 @@
+// Another Reddit Console Client
+// Copyright (c) 2017-2019, Adalid Claure <aclaure@gmail.com>
+
+#include <cstring>
+#include <stdexcept>
+
+#include "Link.h"
+
+namespace arcc
+{
+
+namespace
+{
+
+// enough for the links and text of a typical 100 item page, the arena
+// grows geometrically past that
+constexpr std::size_t INITIAL_ARENA_SIZE = 48 * 1024;
+
+} // namespace
+
+static std::string_view stringField(const nlohmann::json& data, const char* key)
+{
+    if (const auto it = data.find(key); it != data.end() && it->is_string())
+    {
+        return it->get_ref<const std::string&>();
+    }
+
+    return {};
+}
+
+// reddit is not consistent about numbers, `created_utc` for instance
+// comes as a float, and some fields are null on removed posts
+template<typename T>
+static T numberField(const nlohmann::json& data, const char* key)
+{
+    if (const auto it = data.find(key); it != data.end() && it->is_number())
+    {
+        return it->get<T>();
+    }
+
+    return T{};
+}
+
+Link Link::fromJson(const nlohmann::json& item, LinkPage& page)
+{
+    auto& pool = StringPool::instance();
+    const auto& data = item.at("data");
+
+    Link retval;
+    retval.kind = pool.intern(item.value("kind", "t3"));
+    retval.name = page.store(stringField(data, "name"));
+    retval.title = page.store(stringField(data, "title"));
+    retval.url = page.store(stringField(data, "url"));
+    retval.permalink = page.store(stringField(data, "permalink"));
+    retval.selftext = page.store(stringField(data, "selftext"));
+    retval.author = page.store(stringField(data, "author"));
+    retval.flair = pool.intern(stringField(data, "link_flair_text"));
+
+    if (const auto prefixed = stringField(data, "subreddit_name_prefixed"); !prefixed.empty())
+    {
+        retval.subreddit = pool.intern(prefixed);
+    }
+    else if (const auto subreddit = stringField(data, "subreddit"); !subreddit.empty())
+    {
+        retval.subreddit = pool.intern("r/" + std::string{ subreddit });
+    }
+
+    retval.score = numberField<std::int32_t>(data, "score");
+    retval.ups = numberField<std::uint32_t>(data, "ups");
+    retval.downs = numberField<std::uint32_t>(data, "downs");
+    retval.comments = numberField<std::uint32_t>(data, "num_comments");
+    retval.created = numberField<std::uint32_t>(data, "created_utc");
+
+    if (const auto it = data.find("stickied"); it != data.end() && it->is_boolean())
+    {
+        retval.stickied = it->get<bool>();
+    }
+
+    return retval;
+}
+
+std::size_t Link::memoryUsage() const
+{
+    // interned strings are shared by everyone, so they don't count
+    std::size_t retval = sizeof(Link)
+        + name.size() + title.size() + url.size() + permalink.size() + selftext.size() + author.size()
+        + text.size();
+
+    if (raw)
+    {
+        retval += approximateSize(*raw);
+    }
+
+    return retval;
+}
+
+LinkPage::Storage::Storage()
+    : arena{ INITIAL_ARENA_SIZE }
+{
+}
+
+const Link& LinkPage::at(std::size_t index) const
+{
+    if (index >= size())
+    {
+        throw std::out_of_range("link index out of range");
+    }
+
+    return _storage->links[index];
+}
+
+LinkPage::const_iterator LinkPage::begin() const
+{
+    return _storage ? _storage->links.cbegin() : const_iterator{};
+}
+
+LinkPage::const_iterator LinkPage::end() const
+{
+    return _storage ? _storage->links.cend() : const_iterator{};
+}
+
+void LinkPage::reserve(std::size_t count)
+{
+    storage().links.reserve(count);
+}
+
+void LinkPage::push_back(Link link)
+{
+    storage().links.push_back(std::move(link));
+}
+
+void LinkPage::append(const Link& link)
+{
+    Link copy{ link };
+    copy.name = store(link.name);
+    copy.title = store(link.title);
+    copy.url = store(link.url);
+    copy.permalink = store(link.permalink);
+    copy.selftext = store(link.selftext);
+    copy.author = store(link.author);
+    copy.text = store(link.text);
+
+    push_back(std::move(copy));
+}
+
+std::string_view LinkPage::store(std::string_view text)
+{
+    if (text.empty()) return {};
+
+    auto& pageStorage = storage();
+    auto* buffer = static_cast<char*>(pageStorage.arena.allocate(text.size(), 1));
+    std::memcpy(buffer, text.data(), text.size());
+    pageStorage.textBytes += text.size();
+
+    return { buffer, text.size() };
+}
+
+std::size_t LinkPage::memoryUsage() const
+{
+    if (!_storage) return 0;
+
+    std::size_t retval = sizeof(Storage)
+        + _storage->links.capacity() * sizeof(Link)
+        + _storage->textBytes;
+
+    for (const auto& link : _storage->links)
+    {
+        if (link.raw)
+        {
+            retval += approximateSize(*link.raw);
+        }
+    }
+
+    return retval;
+}
+
+LinkPage::Storage& LinkPage::storage()
+{
+    if (!_storage)
+    {
+        _storage = std::make_shared<Storage>();
+    }
+
+    return *_storage;
+}
+
+std::size_t approximateSize(const FlatJson& value)
+{
+    std::size_t retval = sizeof(FlatJson);
+
+    if (value.is_string())
+    {
+        retval += value.get_ref<const std::string&>().capacity();
+    }
+    else if (value.is_object())
+    {
+        // the members sit side by side in one vector, including the slack
+        const auto& object = value.get_ref<const FlatJson::object_t&>();
+        retval += (object.capacity() - object.size()) * sizeof(FlatJson::object_t::value_type);
+
+        for (const auto& [key, item] : object)
+        {
+            retval += sizeof(std::string) + key.capacity() + approximateSize(item);
+        }
+    }
+    else if (value.is_array())
+    {
+        for (const auto& item : value)
+        {
+            retval += approximateSize(item);
+        }
+    }
+
+    return retval;
+}
+
+} // namespace arcc
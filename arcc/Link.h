@@ -0,0 +1,110 @@
+// Another Reddit Console Client
+// Copyright (c) 2017-2019, Adalid Claure <aclaure@gmail.com>
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "FlatJson.h"
+#include "StringPool.h"
+
+namespace arcc
+{
+
+class LinkPage;
+
+// The parts of a listing item that arcc actually shows. The kind, subreddit
+// and flair come from a small set of values and are interned, the rest live
+// in the arena of the page the link came from and are only good for as long
+// as that page is around.
+// Everything else reddit sends is dropped unless the listing was asked to
+// keep the raw JSON.
+struct Link
+{
+    InternedString                          kind;           // "t3" for posts
+    std::string_view                        name;           // fullname, e.g. "t3_9x2a1"
+    std::string_view                        title;
+    std::string_view                        url;
+    std::string_view                        permalink;
+    std::string_view                        selftext;       // markdown body of a self post, empty otherwise
+    std::string_view                        author;
+    InternedString                          subreddit;      // with its prefix, e.g. "r/cpp"
+    InternedString                          flair;          // empty when there is none
+
+    std::int32_t                            score = 0;
+    std::uint32_t                           ups = 0;
+    std::uint32_t                           downs = 0;
+    std::uint32_t                           comments = 0;
+    std::uint32_t                           created = 0;    // created_utc, seconds since the epoch
+    bool                                    stickied = false;
+
+    std::string_view                        text;           // the item's `data` as reddit sent it, when kept
+    std::shared_ptr<const FlatJson>         raw;            // the item's `data` parsed, when kept
+
+    // `item` is one entry of a listing's `children`, its text is copied
+    // into `page`
+    static Link fromJson(const nlohmann::json& item, LinkPage& page);
+
+    // roughly what the link costs in memory, including the raw JSON
+    std::size_t memoryUsage() const;
+};
+
+// The links of one listing page. Their text is copied into an arena that
+// belongs to the page, so decoding a page takes a handful of allocations
+// and dropping it gives them all back at once. Copies share the links and
+// the arena, the last copy to go frees them. A page is filled in by whoever
+// decodes it and only read after that.
+class LinkPage final
+{
+    struct Storage
+    {
+        std::pmr::monotonic_buffer_resource     arena;
+        std::pmr::vector<Link>                  links{ &arena };
+        std::size_t                             textBytes = 0;
+
+        Storage();
+    };
+
+    using Links = std::pmr::vector<Link>;
+
+    std::shared_ptr<Storage>        _storage;       // null until something is added
+
+public:
+    using const_iterator = Links::const_iterator;
+
+    std::size_t size() const { return _storage ? _storage->links.size() : 0; }
+    bool empty() const { return size() == 0; }
+
+    const Link& at(std::size_t index) const;
+    const Link& operator[](std::size_t index) const { return _storage->links[index]; }
+
+    const_iterator begin() const;
+    const_iterator end() const;
+
+    void reserve(std::size_t count);
+    void push_back(Link link);
+
+    // copies a link from another page, text and all
+    void append(const Link& link);
+
+    // copies `text` into the page's arena
+    std::string_view store(std::string_view text);
+
+    // roughly what the page costs in memory, including any raw JSON
+    std::size_t memoryUsage() const;
+
+private:
+    Storage& storage();
+};
+
+// a rough idea of what a json value costs in memory
+std::size_t approximateSize(const FlatJson& value);
+
+} // namespace arcc
@@ -0,0 +1,484 @@
+// Another Reddit Console Client
+// Copyright (c) 2017-2019, Adalid Claure <aclaure@gmail.com>
+
+#include <algorithm>
+#include <cctype>
+#include <limits>
+#include <stdexcept>
+
+#include <fmt/core.h>
+
+#include "LinkFilter.h"
+
+namespace arcc
+{
+
+namespace
+{
+
+using Field = LinkFilter::Field;
+using Compare = LinkFilter::Compare;
+
+struct FieldName
+{
+    std::string_view    name;
+    Field               field;
+};
+
+// reddit's names, and arcc's own where they differ
+constexpr FieldName FIELD_NAMES[] =
+{
+    { "score", Field::SCORE },
+    { "ups", Field::UPS },
+    { "downs", Field::DOWNS },
+    { "num_comments", Field::COMMENTS },
+    { "comments", Field::COMMENTS },
+    { "created_utc", Field::CREATED },
+    { "created", Field::CREATED },
+    { "stickied", Field::STICKIED },
+    { "name", Field::NAME },
+    { "title", Field::TITLE },
+    { "url", Field::URL },
+    { "permalink", Field::PERMALINK },
+    { "author", Field::AUTHOR },
+    { "subreddit", Field::SUBREDDIT },
+    { "flair", Field::FLAIR },
+    { "link_flair_text", Field::FLAIR }
+};
+
+bool isText(Field field)
+{
+    return field >= Field::NAME;
+}
+
+// ASCII only, std::tolower goes through the locale for every character
+constexpr char lower(char c)
+{
+    return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+bool lowerEqual(char a, char b)
+{
+    return lower(a) == lower(b);
+}
+
+bool containsIgnoringCase(std::string_view haystack, std::string_view needle)
+{
+    return std::search(haystack.begin(), haystack.end(), needle.begin(), needle.end(), lowerEqual) != haystack.end();
+}
+
+template<typename T>
+bool compare(const T& lhs, Compare op, const T& rhs)
+{
+    switch (op)
+    {
+        case Compare::EQUAL:            return lhs == rhs;
+        case Compare::NOT_EQUAL:        return lhs != rhs;
+        case Compare::LESS:             return lhs < rhs;
+        case Compare::LESS_EQUAL:       return lhs <= rhs;
+        case Compare::GREATER:          return lhs > rhs;
+        case Compare::GREATER_EQUAL:    return lhs >= rhs;
+        case Compare::CONTAINS:         break;
+    }
+
+    return false;
+}
+
+} // namespace
+
+// A recursive descent parser that emits the instructions as it goes
+class FilterCompiler
+{
+    using Instruction = LinkFilter::Instruction;
+    using OpCode = LinkFilter::OpCode;
+
+    enum class Type
+    {
+        NUMBER,
+        TEXT
+    };
+
+    struct Operand
+    {
+        Type            type;
+        std::uint16_t   index;          // a field, or a constant offset by FIELD_COUNT
+        bool            literal;
+    };
+
+    LinkFilter&         _filter;
+    std::string_view    _text;
+    std::size_t         _pos = 0;
+
+public:
+    FilterCompiler(LinkFilter& filter, std::string_view text)
+        : _filter{ filter }, _text{ text }
+    {
+    }
+
+    void compile()
+    {
+        if (skipSpace(); _pos == _text.size())
+        {
+            throw std::invalid_argument("the filter is empty");
+        }
+
+        disjunction();
+
+        if (skipSpace(); _pos != _text.size())
+        {
+            fail("unexpected");
+        }
+    }
+
+private:
+    [[noreturn]] void fail(std::string_view what) const
+    {
+        const auto rest = _pos < _text.size() ? fmt::format("'{}'", _text.substr(_pos)) : std::string{ "the end" };
+        throw std::invalid_argument(fmt::format("{} {} at column {} of the filter", what, rest, _pos + 1));
+    }
+
+    void skipSpace()
+    {
+        while (_pos < _text.size() && std::isspace(static_cast<unsigned char>(_text[_pos]))) _pos++;
+    }
+
+    bool accept(std::string_view token)
+    {
+        skipSpace();
+        if (_text.substr(_pos, token.size()) != token) return false;
+
+        _pos += token.size();
+        return true;
+    }
+
+    std::size_t emit(Instruction instruction)
+    {
+        if (_filter._code.size() >= std::numeric_limits<std::uint16_t>::max())
+        {
+            throw std::invalid_argument("the filter is too long");
+        }
+
+        _filter._code.push_back(instruction);
+        return _filter._code.size() - 1;
+    }
+
+    // `a || b || c` tests `a`, then jumps to the end if it is true, and so on
+    void disjunction()
+    {
+        std::vector<std::size_t> jumps;
+
+        conjunction();
+        while (accept("||"))
+        {
+            jumps.push_back(emit({ OpCode::JUMP_IF_TRUE }));
+            conjunction();
+        }
+
+        patch(jumps);
+    }
+
+    void conjunction()
+    {
+        std::vector<std::size_t> jumps;
+
+        unary();
+        while (accept("&&"))
+        {
+            jumps.push_back(emit({ OpCode::JUMP_IF_FALSE }));
+            unary();
+        }
+
+        patch(jumps);
+    }
+
+    void patch(const std::vector<std::size_t>& jumps)
+    {
+        for (const auto jump : jumps)
+        {
+            _filter._code.at(jump).lhs = static_cast<std::uint16_t>(_filter._code.size());
+        }
+    }
+
+    void unary()
+    {
+        // `!=` is a comparison, not a negation
+        if (skipSpace(); _text.substr(_pos, 1) == "!" && _text.substr(_pos, 2) != "!=")
+        {
+            _pos++;
+            unary();
+            emit({ OpCode::NOT });
+        }
+        else if (accept("("))
+        {
+            disjunction();
+            if (!accept(")")) fail("expected ')' but found");
+        }
+        else
+        {
+            comparison();
+        }
+    }
+
+    void comparison()
+    {
+        const auto lhs = operand();
+
+        Compare op;
+        if (accept("==")) op = Compare::EQUAL;
+        else if (accept("!=")) op = Compare::NOT_EQUAL;
+        else if (accept("<=")) op = Compare::LESS_EQUAL;
+        else if (accept(">=")) op = Compare::GREATER_EQUAL;
+        else if (accept("<")) op = Compare::LESS;
+        else if (accept(">")) op = Compare::GREATER;
+        else if (accept("~")) op = Compare::CONTAINS;
+        else
+        {
+            // a field on its own
+            if (lhs.literal)
+            {
+                const bool value = lhs.type == Type::NUMBER
+                    ? _filter._numbers.at(lhs.index - LinkFilter::FIELD_COUNT) != 0
+                    : !_filter._texts.at(lhs.index - LinkFilter::FIELD_COUNT).empty();
+
+                emit({ OpCode::CONSTANT, Compare::EQUAL, value });
+            }
+            else
+            {
+                emit({ OpCode::TEST, Compare::EQUAL, lhs.index });
+            }
+
+            return;
+        }
+
+        const auto start = _pos;
+        const auto rhs = operand();
+
+        if (lhs.type != rhs.type)
+        {
+            _pos = start;
+            fail("cannot compare text with a number, found");
+        }
+
+        if (op == Compare::CONTAINS && lhs.type != Type::TEXT)
+        {
+            _pos = start;
+            fail("'~' only works with text, found");
+        }
+
+        emit({ lhs.type == Type::NUMBER ? OpCode::NUMBER : OpCode::TEXT, op, lhs.index, rhs.index });
+    }
+
+    Operand operand()
+    {
+        skipSpace();
+        if (_pos == _text.size()) fail("expected a field or a value but found");
+
+        const char c = _text[_pos];
+        if (c == '"' || c == '\'')
+        {
+            return constant(quoted(c));
+        }
+
+        if (std::isdigit(static_cast<unsigned char>(c)) || c == '-')
+        {
+            return constant(number());
+        }
+
+        const auto start = _pos;
+        while (_pos < _text.size()
+            && (std::isalnum(static_cast<unsigned char>(_text[_pos])) || _text[_pos] == '_'))
+        {
+            _pos++;
+        }
+
+        const auto name = _text.substr(start, _pos - start);
+        if (name == "true" || name == "false")
+        {
+            return constant(std::int64_t{ name == "true" });
+        }
+
+        const auto found = std::find_if(std::begin(FIELD_NAMES), std::end(FIELD_NAMES),
+            [name](const FieldName& f) { return f.name == name; });
+
+        if (name.empty() || found == std::end(FIELD_NAMES))
+        {
+            _pos = start;
+            fail(name.empty() ? "expected a field or a value but found" : "unknown field, found");
+        }
+
+        return { isText(found->field) ? Type::TEXT : Type::NUMBER, static_cast<std::uint16_t>(found->field), false };
+    }
+
+    std::string quoted(char quote)
+    {
+        const auto start = _pos++;
+
+        std::string retval;
+        while (_pos < _text.size() && _text[_pos] != quote)
+        {
+            // `\"` and `\\`
+            if (_text[_pos] == '\\' && _pos + 1 < _text.size()) _pos++;
+            retval.push_back(_text[_pos++]);
+        }
+
+        if (_pos == _text.size())
+        {
+            _pos = start;
+            fail("unterminated text");
+        }
+
+        _pos++;
+        return retval;
+    }
+
+    std::int64_t number()
+    {
+        const auto start = _pos;
+        if (_text[_pos] == '-') _pos++;
+
+        std::int64_t retval = 0;
+        bool digits = false;
+        while (_pos < _text.size() && std::isdigit(static_cast<unsigned char>(_text[_pos])))
+        {
+            if (retval > (std::numeric_limits<std::int64_t>::max() - 9) / 10)
+            {
+                _pos = start;
+                fail("number out of range");
+            }
+
+            retval = retval * 10 + (_text[_pos++] - '0');
+            digits = true;
+        }
+
+        if (!digits)
+        {
+            _pos = start;
+            fail("expected a number but found");
+        }
+
+        return _text[start] == '-' ? -retval : retval;
+    }
+
+    Operand constant(std::int64_t value)
+    {
+        _filter._numbers.push_back(value);
+        return { Type::NUMBER, index(_filter._numbers.size() - 1), true };
+    }
+
+    Operand constant(std::string value)
+    {
+        _filter._texts.push_back(std::move(value));
+        return { Type::TEXT, index(_filter._texts.size() - 1), true };
+    }
+
+    std::uint16_t index(std::size_t constant) const
+    {
+        if (constant + LinkFilter::FIELD_COUNT > std::numeric_limits<std::uint16_t>::max())
+        {
+            throw std::invalid_argument("the filter is too long");
+        }
+
+        return static_cast<std::uint16_t>(constant + LinkFilter::FIELD_COUNT);
+    }
+};
+
+LinkFilter::LinkFilter(std::string_view expression)
+    : _expression{ expression }
+{
+    FilterCompiler{ *this, _expression }.compile();
+}
+
+bool LinkFilter::matches(const Link& link) const
+{
+    bool flag = false;
+
+    const auto size = _code.size();
+    for (std::size_t pc = 0; pc < size; )
+    {
+        const auto& instruction = _code[pc++];
+        switch (instruction.code)
+        {
+            case OpCode::CONSTANT:
+                flag = instruction.lhs != 0;
+                break;
+
+            case OpCode::TEST:
+                flag = isText(static_cast<Field>(instruction.lhs))
+                    ? !text(link, instruction.lhs).empty()
+                    : number(link, instruction.lhs) != 0;
+                break;
+
+            case OpCode::NUMBER:
+                flag = compare(number(link, instruction.lhs), instruction.compare, number(link, instruction.rhs));
+                break;
+
+            case OpCode::TEXT:
+                flag = instruction.compare == Compare::CONTAINS
+                    ? containsIgnoringCase(text(link, instruction.lhs), text(link, instruction.rhs))
+                    : compare(text(link, instruction.lhs), instruction.compare, text(link, instruction.rhs));
+                break;
+
+            case OpCode::NOT:
+                flag = !flag;
+                break;
+
+            case OpCode::JUMP_IF_FALSE:
+                if (!flag) pc = instruction.lhs;
+                break;
+
+            case OpCode::JUMP_IF_TRUE:
+                if (flag) pc = instruction.lhs;
+                break;
+        }
+    }
+
+    return flag;
+}
+
+std::size_t LinkFilter::select(const LinkPage& page, std::vector<std::uint32_t>& indices) const
+{
+    indices.clear();
+
+    const auto size = page.size();
+    for (std::size_t i = 0; i < size; i++)
+    {
+        if (matches(page[i])) indices.push_back(static_cast<std::uint32_t>(i));
+    }
+
+    return indices.size();
+}
+
+std::int64_t LinkFilter::number(const Link& link, std::uint16_t operand) const
+{
+    switch (static_cast<Field>(operand))
+    {
+        case Field::SCORE:      return link.score;
+        case Field::UPS:        return link.ups;
+        case Field::DOWNS:      return link.downs;
+        case Field::COMMENTS:   return link.comments;
+        case Field::CREATED:    return link.created;
+        case Field::STICKIED:   return link.stickied;
+        default:                break;
+    }
+
+    return _numbers[operand - FIELD_COUNT];
+}
+
+std::string_view LinkFilter::text(const Link& link, std::uint16_t operand) const
+{
+    switch (static_cast<Field>(operand))
+    {
+        case Field::NAME:       return link.name;
+        case Field::TITLE:      return link.title;
+        case Field::URL:        return link.url;
+        case Field::PERMALINK:  return link.permalink;
+        case Field::AUTHOR:     return link.author;
+        case Field::SUBREDDIT:  return link.subreddit;
+        case Field::FLAIR:      return link.flair;
+        default:                break;
+    }
+
+    return _texts[operand - FIELD_COUNT];
+}
+
+} // namespace arcc
@@ -0,0 +1,111 @@
+// Another Reddit Console Client
+// Copyright (c) 2017-2019, Adalid Claure <aclaure@gmail.com>
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Link.h"
+
+namespace arcc
+{
+
+// A predicate over links, e.g.
+//
+//     score > 500 && num_comments < 50 && !stickied && flair ~ "Discussion"
+//
+// Numbers compare with `==`, `!=`, `<`, `<=`, `>` and `>=`, text with `==`,
+// `!=` and `~` (contains, ignoring case). A field on its own is true when it
+// is non-zero or not empty. `&&`, `||`, `!` and parentheses work as in C++.
+//
+// The expression is compiled once into a short list of instructions that
+// leave their result in a single flag, `&&` and `||` jump past what they no
+// longer need to look at. Matching a link walks that list without
+// allocating anything.
+class LinkFilter final
+{
+public:
+    enum class Field : std::uint8_t
+    {
+        // numbers
+        SCORE,
+        UPS,
+        DOWNS,
+        COMMENTS,           // num_comments
+        CREATED,            // created_utc
+        STICKIED,
+
+        // text
+        NAME,
+        TITLE,
+        URL,
+        PERMALINK,
+        AUTHOR,
+        SUBREDDIT,
+        FLAIR
+    };
+
+    enum class OpCode : std::uint8_t
+    {
+        CONSTANT,           // flag = `lhs`
+        TEST,               // flag = field `lhs` is non-zero or not empty
+        NUMBER,             // flag = number `lhs` `compare` number `rhs`
+        TEXT,               // flag = text `lhs` `compare` text `rhs`
+        NOT,                // flag = !flag
+        JUMP_IF_FALSE,      // skip to `lhs` when the flag is false
+        JUMP_IF_TRUE        // skip to `lhs` when the flag is true
+    };
+
+    enum class Compare : std::uint8_t
+    {
+        EQUAL,
+        NOT_EQUAL,
+        LESS,
+        LESS_EQUAL,
+        GREATER,
+        GREATER_EQUAL,
+        CONTAINS
+    };
+
+    // an operand below `FIELD_COUNT` is a field, anything above is an
+    // index into the constants offset by `FIELD_COUNT`
+    static constexpr std::uint16_t FIELD_COUNT = static_cast<std::uint16_t>(Field::FLAIR) + 1;
+
+    struct Instruction
+    {
+        OpCode          code;
+        Compare         compare = Compare::EQUAL;
+        std::uint16_t   lhs = 0;
+        std::uint16_t   rhs = 0;
+    };
+
+private:
+    std::string                     _expression;
+    std::vector<Instruction>        _code;
+    std::vector<std::int64_t>       _numbers;       // number constants
+    std::vector<std::string>        _texts;         // text constants
+
+public:
+    // throws std::invalid_argument if `expression` does not parse
+    explicit LinkFilter(std::string_view expression);
+
+    const std::string& expression() const { return _expression; }
+    const std::vector<Instruction>& code() const { return _code; }
+
+    bool matches(const Link& link) const;
+
+    // the indices of the links on `page` that match, `indices` is cleared
+    // first and can be reused from page to page
+    std::size_t select(const LinkPage& page, std::vector<std::uint32_t>& indices) const;
+
+private:
+    friend class FilterCompiler;
+
+    std::int64_t number(const Link& link, std::uint16_t operand) const;
+    std::string_view text(const Link& link, std::uint16_t operand) const;
+};
+
+} // namespace arcc
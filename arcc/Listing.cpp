@@ -1,16 +1,153 @@
 // Another Reddit Console Client
 // Copyright (c) 2017-2019, Adalid Claure <aclaure@gmail.com>
 
+#include <algorithm>
+#include <ctime>
+
 #include <boost/algorithm/string.hpp>
 
 #include <nlohmann/json.hpp>
 
+#include "ListingStream.h"
 #include "RedditSession.h"
+#include "PostStore.h"
+#include "SearchIndex.h"
+#include "utils.h"
 #include "Listing.h"
 
 namespace arcc
 {
 
+std::optional<ListingData> Listing::fetchPage(RedditSession& session,
+    const std::string& endpoint,
+    const Params& params,
+    RawJson raw,
+    RequestPriority priority,
+    CancelFlag cancel)
+{
+    // reddit quietly caps a page at MAX_PAGE_SIZE items, more than that
+    // takes several requests
+    if (const auto it = params.find("limit"); it != params.end()
+        && utils::isNumeric(it->second) && std::stoul(it->second) > ListingStream::MAX_PAGE_SIZE)
+    {
+        return fetchPages(session, endpoint, params, raw, priority, std::move(cancel));
+    }
+
+    const auto body = session.doGetRequest(endpoint, params, false, priority, std::move(cancel));
+    if (body.empty()) return {};
+
+    auto retval = decodeListing(body, raw);
+    if (!retval)
+    {
+        throw std::runtime_error("the listing response was malformed");
+    }
+
+    return retval;
+}
+
+std::optional<ListingData> Listing::fetchPages(RedditSession& session,
+    const std::string& endpoint,
+    const Params& params,
+    RawJson raw,
+    RequestPriority priority,
+    CancelFlag cancel)
+{
+    if (const auto it = params.find("before"); it != params.end() && !it->second.empty())
+    {
+        return fetchPagesBefore(session, endpoint, params, raw, priority, std::move(cancel));
+    }
+
+    ListingStream stream{ session.weak_from_this(), endpoint, std::stoul(params.at("limit")), params };
+    stream.setKeepRaw(raw);
+    stream.setPriority(priority);
+    stream.setCancel(cancel);
+
+    ListingData retval;
+    for (const auto& link : stream)
+    {
+        if (cancel && *cancel) break;
+        retval.children.append(link);
+    }
+
+    // a page cut short is no page at all
+    if (cancel && *cancel)
+    {
+        throw WebClientError("Request error: cancelled");
+    }
+
+    if (stream.pagesFetched() == 0) return {};
+
+    retval.before = stream.before();
+    retval.after = stream.after();
+    return retval;
+}
+
+std::optional<ListingData> Listing::fetchPagesBefore(RedditSession& session,
+    const std::string& endpoint,
+    const Params& params,
+    RawJson raw,
+    RequestPriority priority,
+    CancelFlag cancel)
+{
+    // each request asks for the items just before the first of the one
+    // before it, so the pages come in last to first
+    std::vector<ListingData> pages;
+    std::size_t remaining = std::stoul(params.at("limit"));
+    std::string before = params.at("before");
+
+    std::optional<std::size_t> count;
+    if (const auto it = params.find("count"); it != params.end() && utils::isNumeric(it->second))
+    {
+        count = std::stoul(it->second);
+    }
+
+    while (remaining > 0 && !before.empty())
+    {
+        Params pageParams{ params };
+        pageParams.insert_or_assign("limit", std::to_string(std::min(remaining, ListingStream::MAX_PAGE_SIZE)));
+        pageParams.insert_or_assign("before", before);
+
+        if (count)
+        {
+            if (*count > 0)
+            {
+                pageParams.insert_or_assign("count", std::to_string(*count));
+            }
+            else
+            {
+                pageParams.erase("count");
+            }
+        }
+
+        auto data = fetchPage(session, endpoint, pageParams, raw, priority, cancel);
+        if (!data || data->children.empty()) break;
+
+        const auto size = data->children.size();
+        remaining -= std::min(remaining, size);
+        if (count) *count -= std::min(*count, size);
+
+        before = data->before;
+        pages.push_back(std::move(*data));
+    }
+
+    if (pages.empty()) return {};
+
+    ListingData retval;
+    retval.before = pages.back().before;
+    retval.after = pages.front().after;
+
+    retval.children.reserve(std::stoul(params.at("limit")) - remaining);
+    for (auto page = pages.rbegin(); page != pages.rend(); ++page)
+    {
+        for (const auto& link : page->children)
+        {
+            retval.children.append(link);
+        }
+    }
+
+    return retval;
+}
+
 Listing::Listing(RedditSessionPtr session,
                  const std::string& endpoint,
                  std::size_t limit)
@@ -21,55 +158,248 @@ Listing::Listing(RedditSessionPtr session, const std::string& endpoint, std::siz
     : _sessionPtr{ session },
     _endpoint{ endpoint },
     _limit{ limit },
-    _params{ params }
+    _params{ params },
+    _cache{ DEFAULT_CACHE_SIZE }
 {}
 
 Listing::Listing(const Listing& other)
     : _sessionPtr{ other._sessionPtr },
     _endpoint{ other.endpoint() },
     _limit{ other.limit() },
-    _params{ other.params() }
+    _params{ other.params() },
+    _keepRaw{ other.keepRaw() },
+    _cache{ other.cacheSize() },
+    _store{ other._store },
+    _index{ other._index }
+{
+    if (other._seen)
+    {
+        _seen.emplace(other._seen->mode());
+    }
+}
+
+Listing::~Listing()
+{
+    // the workers only hold copies and a weak session, but the
+    // sooner they stop the sooner _prefetchers lets us go
+    cancelPrefetch();
+}
+
+void Listing::cancelPrefetch()
+{
+    if (_prefetchCancel)
+    {
+        *_prefetchCancel = true;
+        _prefetchCancel.reset();
+    }
+
+    _prefetched.clear();
+}
+
+void Listing::prefetch()
+{
+    // forget about workers that are done
+    _prefetchers.erase(std::remove_if(_prefetchers.begin(), _prefetchers.end(),
+        [](const std::future<void>& worker)
+        {
+            return worker.wait_for(std::chrono::seconds::zero()) == std::future_status::ready;
+        }), _prefetchers.end());
+
+    if (_prefetched.size() >= _prefetchDepth) return;
+
+    // no point fetching what we are going to serve from the cache
+    if (_prefetched.empty() && _cache.contains(_after)) return;
+
+    std::string cursor = _after;
+    std::size_t count = _count + _limit * _prefetched.size();
+
+    if (!_prefetched.empty())
+    {
+        // carry on from the last page we asked for, once we know where it ends
+        const auto& last = _prefetched.back();
+        if (last.wait_for(std::chrono::seconds::zero()) != std::future_status::ready) return;
+
+        const auto& data = last.get()->data;
+        cursor = data ? data->after : std::string{};
+    }
+
+    if (cursor.empty()) return;
+
+    if (!_prefetchCancel)
+    {
+        _prefetchCancel = std::make_shared<std::atomic_bool>(false);
+    }
+
+    std::vector<std::promise<PrefetchedPtr>> promises(_prefetchDepth - _prefetched.size());
+    for (auto& promise : promises)
+    {
+        _prefetched.push_back(promise.get_future().share());
+    }
+
+    _prefetchers.push_back(std::async(std::launch::async,
+        [session = _sessionPtr, endpoint = _endpoint, limit = _limit, params = _params, raw = rawJson(),
+            cursor, count, cancel = _prefetchCancel, promises = std::move(promises)]() mutable
+        {
+            for (auto& promise : promises)
+            {
+                auto page = std::make_shared<Prefetched>();
+                page->cursor = cursor;
+                count += limit;
+
+                if (auto locked = session.lock(); locked && !cursor.empty() && !*cancel)
+                {
+                    Params pageParams{ params };
+                    pageParams.insert_or_assign("limit", std::to_string(limit));
+                    pageParams.insert_or_assign("count", std::to_string(count));
+                    pageParams.insert_or_assign("after", cursor);
+
+                    try
+                    {
+                        page->data = fetchPage(*locked, endpoint, pageParams, raw, RequestPriority::BACKGROUND, cancel);
+                    }
+                    catch (const std::exception&)
+                    {
+                        // getNextPage() will simply ask again
+                    }
+                }
+
+                cursor = page->data ? page->data->after : std::string{};
+                promise.set_value(std::move(page));
+            }
+        }));
+}
+
+std::optional<ListingData> Listing::takePrefetched()
 {
+    if (_prefetched.empty()) return {};
+
+    auto next = std::move(_prefetched.front());
+    _prefetched.pop_front();
+
+    // waits if the worker is still on it, which still beats starting over
+    auto page = next.get();
+    if (page->cursor != _after || !page->data)
+    {
+        cancelPrefetch();
+        return {};
+    }
+
+    return std::move(page->data);
 }
 
-Listing::Page Listing::processResponse(nlohmann::json response)
+Listing::Page Listing::processResponse(ListingData response)
 {
-    Listing::Page retval;
+    // an empty cursor means there is nothing more in that direction
+    _before = std::move(response.before);
+    _after = std::move(response.after);
 
-    const auto& data = response.at("data");
+    if (_index)
+    {
+        _index->add(response.children);
+    }
+
+    return std::move(response.children);
+}
 
-    if (data.find("before") != data.end()
-        && !data["before"].is_null())
+void Listing::setDeduplicate(std::optional<SeenSet::Mode> mode)
+{
+    _seen.reset();
+    if (mode)
     {
-        _before = data["before"];
+        _seen.emplace(*mode);
     }
+}
 
-    if (data.find("after") != data.end()
-        && !data["after"].is_null())
+Listing::Page Listing::dropSeen(Page page)
+{
+    if (!_seen) return page;
+
+    std::vector<bool> fresh;
+    fresh.reserve(page.size());
+
+    for (const auto& link : page)
+    {
+        fresh.push_back(_seen->insert(link.name));
+    }
+
+    if (std::all_of(fresh.begin(), fresh.end(), [](bool v) { return v; }))
     {
-        _after = data["after"];
+        return page;
     }
 
-    return data.value("children", Page{});
+    Page retval;
+    retval.reserve(page.size());
+
+    for (std::size_t i = 0; i < page.size(); i++)
+    {
+        if (fresh[i]) retval.append(page[i]);
+    }
+
+    return retval;
+}
+
+void Listing::save(const Page& page) const
+{
+    if (!_store || page.empty()) return;
+
+    try
+    {
+        _store->put(PostStore::key(_endpoint, _params), page, static_cast<std::uint32_t>(std::time(nullptr)));
+    }
+    catch (const std::exception&)
+    {
+        // the store is only a cache, the page is still good
+    }
+}
+
+Listing::Page Listing::remember(Page page)
+{
+    const std::size_t cost = _after.size() + _before.size() + page.memoryUsage();
+    CachedPage cached{ page, _after, _before, _count };
+
+    _cache.put(_key, std::move(cached), cost);
+    return page;
+}
+
+Listing::Page Listing::restore(const CachedPage& cached)
+{
+    _after = cached.after;
+    _before = cached.before;
+    _count = cached.count;
+
+    prefetch();
+    return cached.page;
 }
 
 Listing::Page Listing::getFirstPage()
 {
+    cancelPrefetch();
+
+    _key.clear();
+    _trail.clear();
+    _count = 0;
+
+    _furthest = 0;
+    if (_seen) _seen->clear();
+
+    if (const auto cached = _cache.get(_key); cached)
+    {
+        return dropSeen(restore(*cached));
+    }
+
     if (auto session = _sessionPtr.lock(); session)
     {
         Params params{ _params };
         params.insert_or_assign("limit", std::to_string(_limit));
 
-        const auto jsontext = session->doGetRequest(_endpoint, params);
-        if (!jsontext.empty())
+        if (auto reply = fetchPage(*session, _endpoint, params, rawJson()); reply)
         {
-            const auto reply = nlohmann::json::parse(jsontext);
-            if (reply.find("data") == reply.end())
-            {
-                throw std::runtime_error("the listing response was malformed");
-            }
+            auto page = processResponse(std::move(*reply));
+            save(page);
 
-            return processResponse(reply);
+            page = remember(dropSeen(std::move(page)));
+            prefetch();
+            return page;
         }
     }
     
@@ -84,8 +414,29 @@ Listing::Page Listing::getNextPage()
         return Listing::Page{};
     }
 
+    if (const auto cached = _cache.get(_after); cached)
+    {
+        // whatever was fetched ahead is for a page we already have
+        cancelPrefetch();
+
+        _trail.push_back(_key);
+        _key = _after;
+
+        auto page = restore(*cached);
+        if (_trail.size() > _furthest)
+        {
+            // cached before the listing started over
+            _furthest = _trail.size();
+            page = dropSeen(std::move(page));
+        }
+
+        return page;
+    }
+
     if (auto session = _sessionPtr.lock(); session)
     {
+        const auto key = _after;
+
         _before.clear();
         _count += _limit;
 
@@ -94,16 +445,39 @@ Listing::Page Listing::getNextPage()
         params.insert_or_assign("count", std::to_string(_count));
         params.insert_or_assign("after", _after);
 
-        const auto jsontext = session->doGetRequest(_endpoint, params);
-        if (!jsontext.empty())
+        auto reply = takePrefetched();
+        if (!reply)
         {
-            const auto reply = nlohmann::json::parse(jsontext);
-            if (reply.find("data") == reply.end())
+            reply = fetchPage(*session, _endpoint, params, rawJson());
+        }
+
+        if (reply)
+        {
+            _trail.push_back(_key);
+            _key = key;
+
+            auto page = processResponse(std::move(*reply));
+            const bool unseen = _trail.size() > _furthest;
+            if (unseen)
             {
-                throw std::runtime_error("the listing response was malformed");
+                _furthest = _trail.size();
+                page = dropSeen(std::move(page));
             }
 
-            return processResponse(reply);
+            page = remember(std::move(page));
+            prefetch();
+
+            if (unseen && _seen && page.empty() && !_after.empty())
+            {
+                // nothing but repeats, carry on to the page after it
+                _key = _trail.back();
+                _trail.pop_back();
+                _furthest--;
+
+                return getNextPage();
+            }
+
+            return page;
         }
     }
 
@@ -113,6 +487,19 @@ Listing::Page Listing::getNextPage()
 
 Listing::Page Listing::getPreviousPage()
 {
+    if (!_trail.empty())
+    {
+        // show exactly what was shown before, if we still have it
+        if (const auto cached = _cache.get(_trail.back()); cached)
+        {
+            cancelPrefetch();
+
+            _key = _trail.back();
+            _trail.pop_back();
+            return restore(*cached);
+        }
+    }
+
     if (_before.empty()
         || (_count - _limit) <= 0)
     {
@@ -120,6 +507,9 @@ Listing::Page Listing::getPreviousPage()
         return Listing::Page{};
     }
 
+    // whatever was fetched ahead belongs to the page we are leaving
+    cancelPrefetch();
+
     if (auto session = _sessionPtr.lock(); session)
     {
         _after.clear();
@@ -134,16 +524,47 @@ Listing::Page Listing::getPreviousPage()
             params.insert_or_assign("count", std::to_string(_count));
         }
 
-        const auto jsontext = session->doGetRequest(_endpoint, params);
-        if (!jsontext.empty())
+        if (auto reply = fetchPage(*session, _endpoint, params, rawJson()); reply)
         {
-            const auto reply = nlohmann::json::parse(jsontext);
-            if (reply.find("data") == reply.end())
+            auto page = processResponse(std::move(*reply));
+            if (!_trail.empty())
             {
-                throw std::runtime_error("the listing response was malformed");
+                _key = _trail.back();
+                _trail.pop_back();
+                page = remember(std::move(page));
             }
 
-            return processResponse(reply);
+            prefetch();
+            return page;
+        }
+    }
+
+    return Listing::Page{};
+}
+
+Listing::Page Listing::refresh()
+{
+    cancelPrefetch();
+    _cache.clear();
+
+    if (auto session = _sessionPtr.lock(); session)
+    {
+        Params params{ _params };
+        params.insert_or_assign("limit", std::to_string(_limit));
+
+        if (!_key.empty())
+        {
+            params.insert_or_assign("count", std::to_string(_count));
+            params.insert_or_assign("after", _key);
+        }
+
+        if (auto reply = fetchPage(*session, _endpoint, params, rawJson()); reply)
+        {
+            auto page = remember(processResponse(std::move(*reply)));
+            if (_key.empty()) save(page);
+
+            prefetch();
+            return page;
         }
     }
 
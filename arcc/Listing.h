@@ -3,12 +3,22 @@
 
 #pragma once
 
+#include <deque>
+#include <future>
 #include <string>
 #include <memory>
 #include <optional>
+#include <vector>
 
 #include <nlohmann/json.hpp>
 
+#include "Link.h"
+#include "ListingDecoder.h"
+#include "LruCache.h"
+#include "RateLimiter.h"
+#include "SeenSet.h"
+#include "Transport.h"
+
 namespace arcc
 {
 
@@ -18,9 +28,29 @@ using RedditSessionPtr = std::weak_ptr<RedditSession>;
 class Listing;
 using ListingPtr = std::unique_ptr<Listing>;
 
+class PostStore;
+class SearchIndex;
+
 using Params = std::map<std::string, std::string>;
 
-class Listing
+// Anything the console can page through
+class ListingBase
+{
+public:
+    virtual ~ListingBase() = default;
+
+    virtual LinkPage getFirstPage() = 0;
+    virtual LinkPage getNextPage() = 0;
+    virtual LinkPage getPreviousPage() = 0;
+
+    // fetches the current page again, or starts over where that makes more sense
+    virtual LinkPage refresh() = 0;
+
+    // stops any work on pages nobody has asked for yet
+    virtual void cancelPrefetch() {}
+};
+
+class Listing : public ListingBase
 {
     friend class RedditSession;
 
@@ -31,22 +61,65 @@ class Listing
 
     std::string                 _after;
     std::string                 _before;
-    std::size_t                 _count;
+    std::size_t                 _count = 0;
 
     Params                      _params;
+    bool                        _keepRaw = false;
+
+    // a page as it was shown along with the cursors around it, keyed by the
+    // `after` it was requested with ("" for the first page)
+    struct CachedPage
+    {
+        LinkPage                page;           // shares its links with the page handed out
+        std::string             after;
+        std::string             before;
+        std::size_t             count = 0;
+    };
+
+    LruCache<std::string, CachedPage>   _cache;
+    std::string                         _key;               // cache key of the current page
+    std::vector<std::string>            _trail;             // keys of the pages before it, oldest first
+
+    // fullnames shown so far, a page further along than any before it is
+    // shown without them since the listing may have shifted under us
+    std::optional<SeenSet>              _seen;
+    std::size_t                         _furthest = 0;      // deepest page shown, as a trail length
+
+    // where the first page is saved for next time, if anywhere
+    std::shared_ptr<PostStore>          _store;
+
+    // where every page decoded is indexed, if anywhere
+    std::shared_ptr<SearchIndex>        _index;
+
+    // a page fetched ahead of time by a background worker
+    struct Prefetched
+    {
+        std::string                 cursor;         // the `after` it was requested with
+        std::optional<ListingData>  data;           // empty if the request failed
+    };
+
+    using PrefetchedPtr = std::shared_ptr<Prefetched>;
+
+    std::size_t                                     _prefetchDepth = 0;
+    CancelFlag                                      _prefetchCancel;
+    std::deque<std::shared_future<PrefetchedPtr>>   _prefetched;    // in page order, starting at `_after`
+    std::vector<std::future<void>>                  _prefetchers;   // destroying these waits for the workers
 
 public:
     
-    using Page = nlohmann::json::value_type;
-    using Items = std::optional<std::reference_wrapper<const nlohmann::json>>;
+    using Page = LinkPage;
+
+    // how much memory a listing may spend on pages it has already shown
+    static constexpr std::size_t DEFAULT_CACHE_SIZE = 4 * 1024 * 1024;
 
     Listing(const Listing& other);
     Listing(RedditSessionPtr session, const std::string& endpoint, std::size_t limit);
     Listing(RedditSessionPtr session, const std::string& endpoint, std::size_t limit, const Params& params);
+    ~Listing() override;
 
-    [[maybe_unused]] Listing::Page getFirstPage();
-    [[maybe_unused]] Listing::Page getNextPage();
-    [[maybe_unused]] Listing::Page getPreviousPage();
+    [[maybe_unused]] Listing::Page getFirstPage() override;
+    [[maybe_unused]] Listing::Page getNextPage() override;
+    [[maybe_unused]] Listing::Page getPreviousPage() override;
 
     std::string endpoint() const { return _endpoint; }
     std::string after() const { return _after; }
@@ -57,9 +130,76 @@ public:
     const Params& params() const { return _params; }
     void setParams(const Params& v) { _params = v; }
 
+    // whether each Link holds on to the JSON it was decoded from, which
+    // costs far more memory than the Link itself
+    bool keepRaw() const { return _keepRaw; }
+    void setKeepRaw(bool v) { _keepRaw = v; }
+
+    // how many pages past the current one are fetched in the background
+    std::size_t prefetchDepth() const { return _prefetchDepth; }
+    void setPrefetchDepth(std::size_t depth) { _prefetchDepth = depth; }
+
+    // whether items already shown are left out of later pages, and how
+    // they are remembered, off by default
+    bool deduplicate() const { return _seen.has_value(); }
+    void setDeduplicate(std::optional<SeenSet::Mode> mode);
+
+    // saves every first page fetched from reddit to `store`
+    void setStore(std::shared_ptr<PostStore> store) { _store = std::move(store); }
+
+    // adds every page fetched from reddit to `index`
+    void setIndex(std::shared_ptr<SearchIndex> index) { _index = std::move(index); }
+
+    // drops every prefetched page and aborts the requests still running
+    void cancelPrefetch() override;
+
+    // memory the page cache may use, in bytes (roughly)
+    std::size_t cacheSize() const { return _cache.maxCost(); }
+    void setCacheSize(std::size_t bytes) { _cache.setMaxCost(bytes); }
+
+    // drops all cached pages and fetches the current page again
+    [[maybe_unused]] Listing::Page refresh() override;
+
+    // asks for a single page of the `limit` in `params`, however many
+    // requests that takes, returns nothing if the request failed and
+    // throws if the response was malformed
+    static std::optional<ListingData> fetchPage(RedditSession& session,
+        const std::string& endpoint,
+        const Params& params,
+        RawJson raw,
+        RequestPriority priority = RequestPriority::INTERACTIVE,
+        CancelFlag cancel = nullptr);
+
 private:
 
-    Page processResponse(nlohmann::json reponse);
+    RawJson rawJson() const { return _keepRaw ? RawJson::PARSED : RawJson::NONE; }
+
+    Page processResponse(ListingData response);
+    Page dropSeen(Page page);
+    void save(const Page& page) const;
+    Page remember(Page page);
+    Page restore(const CachedPage& cached);
+
+    void prefetch();
+    std::optional<ListingData> takePrefetched();
+
+    // puts a page of more than ListingStream::MAX_PAGE_SIZE items together
+    // from as many requests as it takes
+    static std::optional<ListingData> fetchPages(RedditSession& session,
+        const std::string& endpoint,
+        const Params& params,
+        RawJson raw,
+        RequestPriority priority,
+        CancelFlag cancel);
+
+    // the same going back from a `before` cursor, which a ListingStream
+    // cannot do since it only walks forward
+    static std::optional<ListingData> fetchPagesBefore(RedditSession& session,
+        const std::string& endpoint,
+        const Params& params,
+        RawJson raw,
+        RequestPriority priority,
+        CancelFlag cancel);
 };
 
 } // namespace
@@ -0,0 +1,213 @@
+// Another Reddit Console Client
+// Copyright (c) 2017-2019, Adalid Claure <aclaure@gmail.com>
+
+#include <algorithm>
+#include <array>
+
+#include "JsonIndex.h"
+#include "ListingDecoder.h"
+
+namespace arcc
+{
+
+namespace
+{
+
+enum class Field
+{
+    AUTHOR,
+    CREATED,
+    DOWNS,
+    FLAIR,
+    NAME,
+    COMMENTS,
+    PERMALINK,
+    SCORE,
+    SELFTEXT,
+    STICKIED,
+    SUBREDDIT,
+    SUBREDDIT_PREFIXED,
+    TITLE,
+    UPS,
+    URL
+};
+
+// the keys of a child's `data` that end up in a Link, sorted by key
+constexpr std::array<std::pair<std::string_view, Field>, 15> LINK_FIELDS
+{{
+    { "author", Field::AUTHOR },
+    { "created_utc", Field::CREATED },
+    { "downs", Field::DOWNS },
+    { "link_flair_text", Field::FLAIR },
+    { "name", Field::NAME },
+    { "num_comments", Field::COMMENTS },
+    { "permalink", Field::PERMALINK },
+    { "score", Field::SCORE },
+    { "selftext", Field::SELFTEXT },
+    { "stickied", Field::STICKIED },
+    { "subreddit", Field::SUBREDDIT },
+    { "subreddit_name_prefixed", Field::SUBREDDIT_PREFIXED },
+    { "title", Field::TITLE },
+    { "ups", Field::UPS },
+    { "url", Field::URL },
+}};
+
+static_assert(std::is_sorted(LINK_FIELDS.begin(), LINK_FIELDS.end(),
+    [](const auto& a, const auto& b) { return a.first < b.first; }));
+
+constexpr std::optional<Field> findField(std::string_view key)
+{
+    const auto it = std::lower_bound(LINK_FIELDS.begin(), LINK_FIELDS.end(), key,
+        [](const auto& field, std::string_view k) { return field.first < k; });
+
+    if (it != LINK_FIELDS.end() && it->first == key) return it->second;
+    return {};
+}
+
+class Decoder
+{
+    RawJson         _raw;
+    std::string     _scratch;           // unescaped strings on their way to the pool or the page
+
+public:
+    explicit Decoder(RawJson raw)
+        : _raw{ raw }
+    {
+    }
+
+    bool decode(const JsonIndex& index, ListingData& out)
+    {
+        if (!index.valid()) return false;
+
+        const auto data = index.root().find("data");
+        if (!data || !data->isObject()) return false;
+
+        bool ok = true;
+        data->forEach([&](const JsonIndex::Value& member)
+            {
+                if (member.key() == "after") out.after = member.string();
+                else if (member.key() == "before") out.before = member.string();
+                else if (member.key() == "children" && member.isArray())
+                {
+                    out.children.reserve(member.size());
+                    member.forEach([&](const JsonIndex::Value& item) { ok = child(item, out.children) && ok; });
+                }
+            });
+
+        return ok;
+    }
+
+private:
+    // the unescaped text of a string, good until the next call
+    std::string_view text(const JsonIndex::Value& value)
+    {
+        if (!value.isString()) return {};
+
+        auto raw = value.rawString();
+        if (raw.find('\\') != std::string_view::npos)
+        {
+            if (!JsonIndex::unescape(raw, _scratch)) return {};
+            raw = _scratch;
+        }
+
+        return raw;
+    }
+
+    InternedString intern(const JsonIndex::Value& value)
+    {
+        return StringPool::instance().intern(text(value));
+    }
+
+    bool child(const JsonIndex::Value& item, LinkPage& children)
+    {
+        if (!item.isObject()) return true;
+
+        const auto data = item.find("data");
+        if (!data || !data->isObject()) return true;
+
+        Link link;
+        if (const auto kind = item.find("kind"); kind)
+        {
+            link.kind = intern(*kind);
+        }
+
+        if (link.kind.empty()) link.kind = StringPool::instance().intern("t3");
+
+        linkData(*data, link, children);
+
+        if (_raw == RawJson::TEXT)
+        {
+            // the index is over the page's own copy of the response
+            link.text = data->raw();
+        }
+        else if (_raw == RawJson::PARSED)
+        {
+            auto raw = FlatJson::parse(data->raw(), nullptr, false);
+            if (raw.is_discarded()) return false;
+
+            link.raw = std::make_shared<const FlatJson>(std::move(raw));
+        }
+
+        children.push_back(std::move(link));
+        return true;
+    }
+
+    void linkData(const JsonIndex::Value& data, Link& link, LinkPage& page)
+    {
+        InternedString subreddit;
+
+        data.forEach([&](const JsonIndex::Value& value)
+            {
+                const auto field = findField(value.key());
+                if (!field) return;
+
+                switch (*field)
+                {
+                    case Field::AUTHOR: link.author = page.store(text(value)); break;
+                    case Field::FLAIR: link.flair = intern(value); break;
+                    case Field::SUBREDDIT: subreddit = intern(value); break;
+                    case Field::SUBREDDIT_PREFIXED: link.subreddit = intern(value); break;
+
+                    case Field::NAME: link.name = page.store(text(value)); break;
+                    case Field::PERMALINK: link.permalink = page.store(text(value)); break;
+                    case Field::SELFTEXT: link.selftext = page.store(text(value)); break;
+                    case Field::TITLE: link.title = page.store(text(value)); break;
+                    case Field::URL: link.url = page.store(text(value)); break;
+
+                    case Field::COMMENTS: link.comments = value.number<std::uint32_t>(); break;
+                    case Field::CREATED: link.created = value.number<std::uint32_t>(); break;
+                    case Field::DOWNS: link.downs = value.number<std::uint32_t>(); break;
+                    case Field::SCORE: link.score = value.number<std::int32_t>(); break;
+                    case Field::UPS: link.ups = value.number<std::uint32_t>(); break;
+
+                    case Field::STICKIED: link.stickied = value.boolean(); break;
+                }
+            });
+
+        // same fallback as Link::fromJson()
+        if (link.subreddit.empty() && !subreddit.empty())
+        {
+            _scratch.assign("r/").append(subreddit);
+            link.subreddit = StringPool::instance().intern(_scratch);
+        }
+    }
+};
+
+} // namespace
+
+std::optional<ListingData> decodeListing(std::string_view text, RawJson raw)
+{
+    ListingData retval;
+    if (raw == RawJson::TEXT)
+    {
+        text = retval.children.store(text);
+    }
+
+    const JsonIndex index{ text };
+    Decoder decoder{ raw };
+
+    if (!decoder.decode(index, retval)) return {};
+    return retval;
+}
+
+} // namespace arcc
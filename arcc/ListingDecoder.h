@@ -0,0 +1,40 @@
+// Another Reddit Console Client
+// Copyright (c) 2017-2019, Adalid Claure <aclaure@gmail.com>
+
+#pragma once
+
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "Link.h"
+
+namespace arcc
+{
+
+// what a decoded Link keeps of the JSON it came from besides its fields
+enum class RawJson
+{
+    NONE,
+    TEXT,           // Link::text, the item's `data` as reddit sent it
+    PARSED          // Link::raw, the item's `data` parsed
+};
+
+// a listing response reduced to what Listing needs from it
+struct ListingData
+{
+    std::string         after;              // empty when reddit sent null
+    std::string         before;
+    LinkPage            children;
+};
+
+// Decodes a listing response straight into Links without building a DOM.
+// Only the fields a Link holds are decoded, everything else (`preview`,
+// `media`, `all_awardings`, ...) is stepped over on a JsonIndex. `raw` says
+// what else is kept of each child's `data`, TEXT copies the response into
+// the page once and points each Link at its slice of it, PARSED parses it
+// into Link::raw. Returns nothing if the response is not a listing or is
+// malformed.
+std::optional<ListingData> decodeListing(std::string_view text, RawJson raw = RawJson::NONE);
+
+} // namespace arcc
@@ -0,0 +1,204 @@
+// Another Reddit Console Client
+// Copyright (c) 2017-2019, Adalid Claure <aclaure@gmail.com>
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#include "RedditSession.h"
+#include "utils.h"
+#include "ListingStream.h"
+
+namespace arcc
+{
+
+ListingStream::ListingStream(RedditSessionPtr session, const std::string& endpoint, std::size_t limit, const Params& params)
+    : _sessionPtr{ session },
+      _endpoint{ endpoint },
+      _limit{ limit },
+      _params{ params },
+      _cancel{ std::make_shared<std::atomic_bool>(false) }
+{
+}
+
+ListingStream::~ListingStream()
+{
+    {
+        std::lock_guard<std::mutex> lock{ _mutex };
+        *_cancel = true;
+    }
+
+    _cv.notify_all();
+
+    // the cancel flag also aborts a request that is under way, unless it
+    // went out with the caller's flag
+    if (_worker.joinable()) _worker.join();
+}
+
+void ListingStream::setPageSize(std::size_t v)
+{
+    _pageSize = std::clamp<std::size_t>(v, 1, MAX_PAGE_SIZE);
+}
+
+void ListingStream::setDepth(std::size_t v)
+{
+    _depth = std::max<std::size_t>(v, 1);
+}
+
+ListingStream::Iterator ListingStream::begin()
+{
+    if (_worker.joinable() || *_cancel)
+    {
+        throw std::runtime_error("a listing stream can only be walked once");
+    }
+
+    _worker = std::thread{ &ListingStream::run, this };
+    return Iterator{ *this };
+}
+
+std::size_t ListingStream::pagesFetched()
+{
+    std::lock_guard<std::mutex> lock{ _mutex };
+    return _fetched;
+}
+
+std::string ListingStream::before()
+{
+    std::lock_guard<std::mutex> lock{ _mutex };
+    return _before;
+}
+
+std::string ListingStream::after()
+{
+    std::lock_guard<std::mutex> lock{ _mutex };
+    return _after;
+}
+
+void ListingStream::run()
+{
+    // the first request goes out with whatever cursor the params have
+    std::string after;
+    std::size_t offset = 0;
+    std::size_t count = 0;
+
+    if (const auto it = _params.find("count"); it != _params.end() && utils::isNumeric(it->second))
+    {
+        offset = std::stoul(it->second);
+    }
+
+    while (count < _limit)
+    {
+        {
+            // wait for the reader to make room
+            std::unique_lock<std::mutex> lock{ _mutex };
+            _cv.wait(lock, [this] { return _pages.size() < _depth || cancelled(); });
+            if (cancelled()) break;
+        }
+
+        auto session = _sessionPtr.lock();
+        if (!session) break;
+
+        Params params{ _params };
+        params.insert_or_assign("limit", std::to_string(std::min(_pageSize, _limit - count)));
+        if (!after.empty())
+        {
+            params.insert_or_assign("count", std::to_string(offset + count));
+            params.insert_or_assign("after", after);
+        }
+
+        std::optional<ListingData> data;
+        try
+        {
+            data = Listing::fetchPage(*session, _endpoint, params, _keepRaw, _priority, _external ? _external : _cancel);
+        }
+        catch (const std::exception&)
+        {
+            std::lock_guard<std::mutex> lock{ _mutex };
+            _error = std::current_exception();
+            break;
+        }
+
+        if (!data || data->children.empty()) break;
+
+        count += data->children.size();
+        after = data->after;
+
+        {
+            std::lock_guard<std::mutex> lock{ _mutex };
+            if (_fetched == 0) _before = std::move(data->before);
+            _after = std::move(data->after);
+
+            _pages.push_back(std::move(data->children));
+            _fetched++;
+        }
+
+        _cv.notify_all();
+
+        if (after.empty()) break;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock{ _mutex };
+        _done = true;
+    }
+
+    _cv.notify_all();
+}
+
+std::optional<LinkPage> ListingStream::pop()
+{
+    std::unique_lock<std::mutex> lock{ _mutex };
+    _cv.wait(lock, [this] { return !_pages.empty() || _done; });
+
+    if (!_pages.empty())
+    {
+        auto retval = std::move(_pages.front());
+        _pages.pop_front();
+
+        lock.unlock();
+        _cv.notify_all();
+
+        return retval;
+    }
+
+    if (_error)
+    {
+        std::rethrow_exception(std::exchange(_error, nullptr));
+    }
+
+    return {};
+}
+
+ListingStream::Iterator::Iterator(ListingStream& stream)
+    : _stream{ &stream }
+{
+    nextPage();
+}
+
+ListingStream::Iterator& ListingStream::Iterator::operator++()
+{
+    if (++_index >= _page.size())
+    {
+        nextPage();
+    }
+
+    return *this;
+}
+
+void ListingStream::Iterator::nextPage()
+{
+    // drop our share of the page we are done with before waiting on the next
+    _page = LinkPage{};
+    _index = 0;
+
+    if (auto page = _stream->pop(); page)
+    {
+        _page = std::move(*page);
+    }
+    else
+    {
+        _stream = nullptr;
+    }
+}
+
+} // namespace arcc
@@ -0,0 +1,142 @@
+// Another Reddit Console Client
+// Copyright (c) 2017-2019, Adalid Claure <aclaure@gmail.com>
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <iterator>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+
+#include "Listing.h"
+
+namespace arcc
+{
+
+// Walks the first `limit` items of a listing one at a time, however many
+// that is. The items are requested a page at a time, since reddit never
+// sends more than 100 of them at once, and a worker keeps fetching up to
+// `depth` pages ahead of whoever is reading, so no more than that is ever
+// held in memory. The stream ends after `limit` items, when reddit says
+// there is nothing after the last page, or when a request fails. An `after`
+// and `count` in `params` start the stream that far into the listing.
+//
+//     ListingStream stream{ session, "/r/cpp/new", 10000 };
+//     for (const auto& link : stream) { ... }
+//
+// A Link is only good until the iterator moves past the page it came on.
+class ListingStream final
+{
+public:
+    static constexpr std::size_t MAX_PAGE_SIZE = 100;
+
+    class Iterator;
+
+private:
+    RedditSessionPtr            _sessionPtr;
+    const std::string           _endpoint;
+    const std::size_t           _limit;
+    Params                      _params;
+    std::size_t                 _pageSize = MAX_PAGE_SIZE;
+    std::size_t                 _depth = 2;
+    RawJson                     _keepRaw = RawJson::NONE;
+    RequestPriority             _priority = RequestPriority::BACKGROUND;
+
+    std::mutex                  _mutex;
+    std::condition_variable     _cv;
+    std::deque<LinkPage>        _pages;                 // fetched and not read yet, guarded by _mutex
+    std::size_t                 _fetched = 0;           // guarded by _mutex
+    bool                        _done = false;          // no more pages are coming, guarded by _mutex
+    std::string                 _before;                // of the first page, guarded by _mutex
+    std::string                 _after;                 // of the last page, guarded by _mutex
+    std::exception_ptr          _error;                 // guarded by _mutex
+
+    CancelFlag                  _cancel;
+    CancelFlag                  _external;              // the caller's, if it gave us one
+    std::thread                 _worker;
+
+public:
+    ListingStream(RedditSessionPtr session, const std::string& endpoint, std::size_t limit, const Params& params = Params{});
+    ~ListingStream();
+
+    ListingStream(const ListingStream&) = delete;
+    ListingStream& operator=(const ListingStream&) = delete;
+
+    std::string endpoint() const { return _endpoint; }
+    std::size_t limit() const { return _limit; }
+
+    // the settings below only take effect if changed before begin()
+
+    // items asked for in each request, at most MAX_PAGE_SIZE
+    std::size_t pageSize() const { return _pageSize; }
+    void setPageSize(std::size_t v);
+
+    // how many pages are fetched ahead of the reader, at least one
+    std::size_t depth() const { return _depth; }
+    void setDepth(std::size_t v);
+
+    RawJson keepRaw() const { return _keepRaw; }
+    void setKeepRaw(RawJson v) { _keepRaw = v; }
+
+    // stops the stream and aborts its request once set, for whoever has
+    // to call it off from elsewhere; a request under way is then left to
+    // this flag instead of being aborted when the stream goes
+    void setCancel(CancelFlag v) { _external = std::move(v); }
+
+    // a crawl goes in the background, something the user waits on should not
+    RequestPriority priority() const { return _priority; }
+    void setPriority(RequestPriority v) { _priority = v; }
+
+    // starts fetching, a stream can only be walked once; the iterator
+    // rethrows if a response was malformed
+    Iterator begin();
+    std::default_sentinel_t end() const { return {}; }
+
+    // pages that have arrived so far
+    std::size_t pagesFetched();
+
+    // the cursors around the items streamed so far, what a Listing needs
+    // to page on from them
+    std::string before();
+    std::string after();
+
+private:
+    void run();
+    bool cancelled() const { return *_cancel || (_external && *_external); }
+
+    // blocks until the worker has the next page, nothing once it is done
+    std::optional<LinkPage> pop();
+};
+
+class ListingStream::Iterator final
+{
+    ListingStream*      _stream = nullptr;          // null at the end
+    LinkPage            _page;
+    std::size_t         _index = 0;
+
+public:
+    using iterator_concept = std::input_iterator_tag;
+    using value_type = Link;
+    using difference_type = std::ptrdiff_t;
+
+    Iterator() = default;
+    explicit Iterator(ListingStream& stream);
+
+    const Link& operator*() const { return _page[_index]; }
+    const Link* operator->() const { return &_page[_index]; }
+
+    Iterator& operator++();
+    void operator++(int) { ++*this; }
+
+    bool operator==(std::default_sentinel_t) const { return _stream == nullptr; }
+
+private:
+    void nextPage();
+};
+
+} // namespace arcc
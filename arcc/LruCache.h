@@ -0,0 +1,106 @@
+// Another Reddit Console Client
+// Copyright (c) 2017-2019, Adalid Claure <aclaure@gmail.com>
+
+#pragma once
+
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+namespace arcc
+{
+
+// A least recently used cache bounded by the total cost of its values
+// rather than their number, the caller decides what a value costs (usually
+// its size in bytes). A value that alone costs more than the cap is not
+// kept at all. Not thread safe.
+template<typename Key, typename Value>
+class LruCache final
+{
+    struct Entry
+    {
+        Key             key;
+        Value           value;
+        std::size_t     cost;
+    };
+
+    using Entries = std::list<Entry>;
+
+    Entries                                                 _entries;   // most recently used first
+    std::unordered_map<Key, typename Entries::iterator>     _index;
+    std::size_t                                             _maxCost;
+    std::size_t                                             _cost = 0;
+
+public:
+    explicit LruCache(std::size_t maxCost)
+        : _maxCost{ maxCost }
+    {
+    }
+
+    // returns nullptr on a miss, the pointer is good until the next put()
+    const Value* get(const Key& key)
+    {
+        const auto it = _index.find(key);
+        if (it == _index.end()) return nullptr;
+
+        _entries.splice(_entries.begin(), _entries, it->second);
+        return &(it->second->value);
+    }
+
+    bool contains(const Key& key) const
+    {
+        return _index.find(key) != _index.end();
+    }
+
+    void put(const Key& key, Value value, std::size_t cost)
+    {
+        erase(key);
+        if (cost > _maxCost) return;
+
+        _entries.push_front(Entry{ key, std::move(value), cost });
+        _index.emplace(key, _entries.begin());
+        _cost += cost;
+
+        trim();
+    }
+
+    void erase(const Key& key)
+    {
+        if (const auto it = _index.find(key); it != _index.end())
+        {
+            _cost -= it->second->cost;
+            _entries.erase(it->second);
+            _index.erase(it);
+        }
+    }
+
+    void clear()
+    {
+        _entries.clear();
+        _index.clear();
+        _cost = 0;
+    }
+
+    std::size_t size() const { return _entries.size(); }
+    std::size_t cost() const { return _cost; }
+
+    std::size_t maxCost() const { return _maxCost; }
+    void setMaxCost(std::size_t maxCost)
+    {
+        _maxCost = maxCost;
+        trim();
+    }
+
+private:
+    void trim()
+    {
+        while (_cost > _maxCost && !_entries.empty())
+        {
+            _cost -= _entries.back().cost;
+            _index.erase(_entries.back().key);
+            _entries.pop_back();
+        }
+    }
+};
+
+} // namespace arcc
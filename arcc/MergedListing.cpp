@@ -0,0 +1,256 @@
+// Another Reddit Console Client
+// Copyright (c) 2017-2019, Adalid Claure <aclaure@gmail.com>
+
+#include <algorithm>
+#include <cmath>
+#include <future>
+#include <queue>
+
+#include "RedditSession.h"
+#include "SearchIndex.h"
+#include "MergedListing.h"
+
+namespace arcc
+{
+
+namespace
+{
+
+// the epoch and decay of reddit's hot ranking, every 12.5 hours of age
+// cost a post as much as a tenfold lower score
+constexpr double HOT_EPOCH = 1134028003;
+constexpr double HOT_DECAY = 45000;
+
+} // namespace
+
+MergedListing::MergedListing(RedditSessionPtr session, const std::vector<std::string>& endpoints,
+    std::size_t limit, const Params& params, MergeOrder order)
+    : _sessionPtr{ session },
+      _limit{ limit },
+      _params{ params },
+      _order{ order }
+{
+    for (const auto& endpoint : endpoints)
+    {
+        _sources.push_back(Source{ endpoint, std::string{}, 0, LinkPage{}, 0 });
+    }
+}
+
+std::vector<std::string> MergedListing::endpoints() const
+{
+    std::vector<std::string> retval;
+    for (const auto& source : _sources)
+    {
+        retval.push_back(source.endpoint);
+    }
+
+    return retval;
+}
+
+double MergedListing::rank(const Link& link, MergeOrder order)
+{
+    switch (order)
+    {
+        case MergeOrder::CREATED:
+            return link.created;
+
+        case MergeOrder::SCORE:
+            return link.score;
+
+        case MergeOrder::HOT:
+        {
+            const double score = link.score;
+            const double sign = score > 0 ? 1 : (score < 0 ? -1 : 0);
+            return sign * std::log10(std::max(std::abs(score), 1.0)) + (link.created - HOT_EPOCH) / HOT_DECAY;
+        }
+    }
+
+    return 0;
+}
+
+LinkPage MergedListing::getFirstPage()
+{
+    auto session = _sessionPtr.lock();
+    if (!session) return LinkPage{};
+
+    _pages.clear();
+    _merged = 0;
+    _current = 0;
+
+    restart(*session);
+
+    auto page = merge();
+    if (!page.empty())
+    {
+        _pages.put(0, page, page.memoryUsage());
+        _merged = 1;
+    }
+
+    return page;
+}
+
+LinkPage MergedListing::getNextPage()
+{
+    if (_merged == 0) return LinkPage{};
+
+    if (_current + 1 < _merged)
+    {
+        return pageAt(++_current);
+    }
+
+    auto page = merge();
+    if (!page.empty())
+    {
+        _current = _merged++;
+        _pages.put(_current, page, page.memoryUsage());
+    }
+
+    return page;
+}
+
+LinkPage MergedListing::getPreviousPage()
+{
+    if (_merged == 0 || _current == 0) return LinkPage{};
+    return pageAt(--_current);
+}
+
+LinkPage MergedListing::refresh()
+{
+    return getFirstPage();
+}
+
+void MergedListing::restart(RedditSession& session)
+{
+    for (auto& source : _sources)
+    {
+        source = Source{ source.endpoint, std::string{}, 0, LinkPage{}, 0 };
+    }
+
+    // every source at once, the first page needs something from all of them
+    std::vector<std::future<void>> requests;
+    for (auto& source : _sources)
+    {
+        requests.push_back(std::async(std::launch::async,
+            [this, &session, &source] { fetch(session, source); }));
+    }
+
+    for (auto& request : requests)
+    {
+        request.get();
+    }
+}
+
+LinkPage MergedListing::pageAt(std::size_t index)
+{
+    if (const auto cached = _pages.get(index); cached)
+    {
+        return *cached;
+    }
+
+    auto session = _sessionPtr.lock();
+    if (!session) return LinkPage{};
+
+    // the sources have moved past this page, so the only way back to it
+    // is to merge every page up to it again, after which they are only
+    // that far along
+    restart(*session);
+
+    LinkPage page;
+    for (std::size_t i = 0; i <= index; i++)
+    {
+        page = merge();
+        _pages.put(i, page, page.memoryUsage());
+    }
+
+    _merged = index + 1;
+    return page;
+}
+
+void MergedListing::fetch(RedditSession& session, Source& source) const
+{
+    Params params{ _params };
+    params.insert_or_assign("limit", std::to_string(_limit));
+    if (!source.after.empty())
+    {
+        params.insert_or_assign("count", std::to_string(source.count));
+        params.insert_or_assign("after", source.after);
+    }
+
+    auto data = Listing::fetchPage(session, source.endpoint, params, RawJson::NONE);
+
+    source.index = 0;
+    if (data)
+    {
+        if (_index)
+        {
+            _index->add(data->children);
+        }
+
+        source.count += data->children.size();
+        source.after = std::move(data->after);
+        source.page = std::move(data->children);
+    }
+    else
+    {
+        // a failed request ends this source rather than the whole listing
+        source.after.clear();
+        source.page = LinkPage{};
+    }
+}
+
+void MergedListing::refill(Source& source)
+{
+    if (!source.exhausted() || source.after.empty()) return;
+
+    if (auto session = _sessionPtr.lock(); session)
+    {
+        fetch(*session, source);
+    }
+}
+
+LinkPage MergedListing::merge()
+{
+    // the rank of each source's next item, best on top and the earlier
+    // source first on a tie
+    using Head = std::pair<double, std::size_t>;
+    const auto lower = [](const Head& a, const Head& b)
+        {
+            return a.first < b.first || (a.first == b.first && a.second > b.second);
+        };
+
+    std::priority_queue<Head, std::vector<Head>, decltype(lower)> heads{ lower };
+    for (std::size_t i = 0; i < _sources.size(); i++)
+    {
+        auto& source = _sources.at(i);
+        refill(source);
+
+        if (!source.exhausted())
+        {
+            heads.emplace(rank(source.page[source.index], _order), i);
+        }
+    }
+
+    LinkPage retval;
+    retval.reserve(_limit);
+
+    while (retval.size() < _limit && !heads.empty())
+    {
+        const auto index = heads.top().second;
+        heads.pop();
+
+        auto& source = _sources.at(index);
+        retval.append(source.page[source.index++]);
+
+        // only go back to reddit if this page still needs more items
+        if (retval.size() < _limit) refill(source);
+
+        if (!source.exhausted())
+        {
+            heads.emplace(rank(source.page[source.index], _order), index);
+        }
+    }
+
+    return retval;
+}
+
+} // namespace arcc
@@ -0,0 +1,99 @@
+// Another Reddit Console Client
+// Copyright (c) 2017-2019, Adalid Claure <aclaure@gmail.com>
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Listing.h"
+#include "LruCache.h"
+
+namespace arcc
+{
+
+// what merged items are sorted by, highest first
+enum class MergeOrder
+{
+    CREATED,        // newest first
+    SCORE,
+    HOT             // reddit's hot ranking, score decayed by age
+};
+
+// Pages through several listings as if they were one, e.g. `/r/a/new` and
+// `/r/b/new` merged into a single newest-first listing. The first page of
+// every source is requested at once, after that each source keeps its own
+// `after` cursor and its next page is only fetched once the merge has used
+// up the one before. Each page is taken off a heap of the sources' next
+// items, so it costs log(sources) per item.
+class MergedListing final : public ListingBase
+{
+    struct Source
+    {
+        std::string     endpoint;
+        std::string     after;                  // empty once there is nothing more
+        std::size_t     count = 0;              // items received so far
+        LinkPage        page;                   // the page being merged
+        std::size_t     index = 0;              // next item on it
+
+        bool exhausted() const { return index >= page.size(); }
+    };
+
+    RedditSessionPtr            _sessionPtr;
+    const std::size_t           _limit;
+    Params                      _params;
+    const MergeOrder            _order;
+
+    // where every page fetched is indexed, if anywhere
+    std::shared_ptr<SearchIndex> _index;
+
+    std::vector<Source>         _sources;
+
+    // merged pages keyed by their index, with the same budget as a Listing
+    LruCache<std::size_t, LinkPage> _pages{ Listing::DEFAULT_CACHE_SIZE };
+    std::size_t                 _merged = 0;            // pages merged so far
+    std::size_t                 _current = 0;           // index of the page shown
+
+public:
+    MergedListing(RedditSessionPtr session, const std::vector<std::string>& endpoints,
+        std::size_t limit, const Params& params, MergeOrder order);
+
+    LinkPage getFirstPage() override;
+    LinkPage getNextPage() override;
+    LinkPage getPreviousPage() override;
+
+    // starts over from the first page of every source
+    LinkPage refresh() override;
+
+    // adds every page fetched from reddit to `index`
+    void setIndex(std::shared_ptr<SearchIndex> index) { _index = std::move(index); }
+
+    std::size_t limit() const { return _limit; }
+    MergeOrder order() const { return _order; }
+
+    // memory the merged pages may use, in bytes (roughly)
+    std::size_t cacheSize() const { return _pages.maxCost(); }
+    void setCacheSize(std::size_t bytes) { _pages.setMaxCost(bytes); }
+
+    std::vector<std::string> endpoints() const;
+
+    // the value items are sorted by, higher comes first
+    static double rank(const Link& link, MergeOrder order);
+
+private:
+    // puts every source back at its first page
+    void restart(RedditSession& session);
+
+    // the page at `index`, merged over again from the start if it has
+    // been dropped from the cache
+    LinkPage pageAt(std::size_t index);
+
+    void fetch(RedditSession& session, Source& source) const;
+
+    // fetches the next page of a source that has run out, if it has one
+    void refill(Source& source);
+
+    LinkPage merge();
+};
+
+} // namespace arcc
@@ -0,0 +1,121 @@
+// Another Reddit Console Client
+// Copyright (c) 2017-2019, Adalid Claure <aclaure@gmail.com>
+
+#include <algorithm>
+#include <cmath>
+
+#include "NetStats.h"
+
+namespace arcc
+{
+
+namespace
+{
+
+std::uint32_t highestBit(std::uint64_t value)
+{
+    std::uint32_t retval = 0;
+    while (value >>= 1) retval++;
+    return retval;
+}
+
+} // namespace
+
+std::uint32_t LatencyHistogram::bucketIndex(std::uint64_t value)
+{
+    if (value < (SUB_BUCKETS * 2))
+    {
+        return static_cast<std::uint32_t>(value);
+    }
+
+    // keep the top SUB_BUCKET_BITS+1 bits, the exponent picks the row
+    const auto exponent = highestBit(value) - SUB_BUCKET_BITS;
+    const auto mantissa = static_cast<std::uint32_t>(value >> exponent);
+    return exponent * SUB_BUCKETS + mantissa;
+}
+
+std::uint64_t LatencyHistogram::bucketHighest(std::uint32_t index)
+{
+    if (index < (SUB_BUCKETS * 2))
+    {
+        return index;
+    }
+
+    const std::uint64_t exponent = index / SUB_BUCKETS - 1;
+    const std::uint64_t mantissa = index - exponent * SUB_BUCKETS;
+    return ((mantissa + 1) << exponent) - 1;
+}
+
+void LatencyHistogram::record(std::uint64_t value)
+{
+    _counts.at(bucketIndex(value))++;
+
+    _min = _count == 0 ? value : std::min(_min, value);
+    _max = std::max(_max, value);
+    _sum += value;
+    _count++;
+}
+
+std::uint64_t LatencyHistogram::percentile(double pct) const
+{
+    if (_count == 0) return 0;
+
+    const auto target = static_cast<std::uint64_t>(
+        std::ceil(std::clamp(pct, 0.0, 100.0) / 100.0 * static_cast<double>(_count)));
+
+    std::uint64_t seen = 0;
+    for (std::uint32_t idx = 0; idx < BUCKET_COUNT; idx++)
+    {
+        seen += _counts[idx];
+        if (seen >= std::max<std::uint64_t>(target, 1))
+        {
+            return std::clamp(bucketHighest(idx), _min, _max);
+        }
+    }
+
+    return _max;
+}
+
+NetStats& NetStats::instance()
+{
+    static NetStats stats;
+    return stats;
+}
+
+void NetStats::record(const std::string& host, const WebClient::Timings& timings)
+{
+    std::lock_guard<std::mutex> lock{ _mutex };
+    auto& stats = _hosts[host];
+
+    stats.requests++;
+    stats.bytes += timings.bytesReceived;
+
+    stats.nameLookup.record(timings.nameLookup);
+    stats.connect.record(timings.connect);
+    stats.tlsHandshake.record(timings.tlsHandshake);
+    stats.firstByte.record(timings.firstByte);
+    stats.total.record(timings.total);
+}
+
+void NetStats::recordError(const std::string& host)
+{
+    std::lock_guard<std::mutex> lock{ _mutex };
+    auto& stats = _hosts[host];
+
+    stats.requests++;
+    stats.errors++;
+}
+
+std::map<std::string, HostStats> NetStats::snapshot() const
+{
+    std::lock_guard<std::mutex> lock{ _mutex };
+    return _hosts;
+}
+
+void NetStats::reset()
+{
+    std::lock_guard<std::mutex> lock{ _mutex };
+    _hosts.clear();
+}
+
+} // namespace arcc
@@ -0,0 +1,82 @@
+// Another Reddit Console Client
+// Copyright (c) 2017-2019, Adalid Claure <aclaure@gmail.com>
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+
+#include "WebClient.h"
+
+namespace arcc
+{
+
+// HDR style histogram of microsecond values. Values below 32 are counted
+// exactly, above that every power of two is split into 16 linear buckets
+// which bounds the error of any reported value to about 6%.
+class LatencyHistogram
+{
+    static constexpr std::uint32_t SUB_BUCKET_BITS = 4;
+    static constexpr std::uint32_t SUB_BUCKETS = 1u << SUB_BUCKET_BITS;
+    static constexpr std::uint32_t BUCKET_COUNT = (65 - SUB_BUCKET_BITS) * SUB_BUCKETS;
+
+    std::array<std::uint64_t, BUCKET_COUNT>     _counts = {};
+    std::uint64_t                               _count = 0;
+    std::uint64_t                               _sum = 0;
+    std::uint64_t                               _min = 0;
+    std::uint64_t                               _max = 0;
+
+public:
+    void record(std::uint64_t value);
+    void record(std::chrono::microseconds value)
+    {
+        record(static_cast<std::uint64_t>(std::max<std::int64_t>(value.count(), 0)));
+    }
+
+    // highest value in the bucket that holds the given percentile (0-100]
+    std::uint64_t percentile(double pct) const;
+
+    std::uint64_t count() const { return _count; }
+    std::uint64_t min() const { return _min; }
+    std::uint64_t max() const { return _max; }
+    double mean() const { return _count > 0 ? static_cast<double>(_sum) / _count : 0.0; }
+
+    static std::uint32_t bucketIndex(std::uint64_t value);
+    static std::uint64_t bucketHighest(std::uint32_t index);
+};
+
+struct HostStats
+{
+    std::uint64_t       requests = 0;
+    std::uint64_t       errors = 0;
+    std::uint64_t       bytes = 0;
+
+    LatencyHistogram    nameLookup;
+    LatencyHistogram    connect;
+    LatencyHistogram    tlsHandshake;
+    LatencyHistogram    firstByte;
+    LatencyHistogram    total;
+};
+
+// process wide per-host request statistics, fed by the AsyncWebClient
+class NetStats final
+{
+    mutable std::mutex                  _mutex;
+    std::map<std::string, HostStats>    _hosts;
+
+public:
+    static NetStats& instance();
+
+    void record(const std::string& host, const WebClient::Timings& timings);
+    void recordError(const std::string& host);
+
+    std::map<std::string, HostStats> snapshot() const;
+    void reset();
+};
+
+} // namespace arcc
@@ -0,0 +1,574 @@
+// Another Reddit Console Client
+// Copyright (c) 2017-2019, Adalid Claure <aclaure@gmail.com>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <unordered_set>
+
+#include <boost/filesystem.hpp>
+#include <fmt/core.h>
+
+#include "SeenSet.h"
+#include "StringPool.h"
+#include "PostStore.h"
+
+namespace arcc
+{
+
+namespace
+{
+
+namespace bip = boost::interprocess;
+
+constexpr char MAGIC[8] = { 'A', 'R', 'C', 'C', 'P', 'O', 'S', 'T' };
+constexpr std::uint32_t VERSION = 1;
+
+// records start on 8 byte boundaries so the offsets in a snapshot are
+// aligned in the mapping
+constexpr std::uint64_t ALIGNMENT = 8;
+
+struct FileHeader
+{
+    char                magic[8];
+    std::uint32_t       version;
+    std::uint32_t       reserved;
+};
+
+enum class RecordType : std::uint8_t
+{
+    LINK = 1,
+    SNAPSHOT = 2
+};
+
+struct RecordHeader
+{
+    std::uint32_t       size;           // all of the record, padding included
+    RecordType          type;
+    std::uint8_t        reserved[3];
+};
+
+// followed by the text of each field, one after the other
+struct LinkFields
+{
+    std::int32_t        score;
+    std::uint32_t       ups;
+    std::uint32_t       downs;
+    std::uint32_t       comments;
+    std::uint32_t       created;
+    std::uint8_t        stickied;
+    std::uint8_t        reserved[3];
+    std::uint16_t       lengths[8];     // kind, name, title, url, permalink, author, subreddit, flair
+};
+
+// followed by `count` offsets of link records and then the listing's key
+struct SnapshotFields
+{
+    std::uint32_t       saved;
+    std::uint32_t       count;
+    std::uint16_t       keyLength;
+    std::uint16_t       reserved[3];
+};
+
+constexpr auto LINK_TEXT = sizeof(RecordHeader) + sizeof(LinkFields);
+constexpr auto SNAPSHOT_OFFSETS = sizeof(RecordHeader) + sizeof(SnapshotFields);
+
+static_assert(sizeof(FileHeader) % ALIGNMENT == 0);
+static_assert(sizeof(RecordHeader) == 8 && sizeof(LinkFields) == 40 && sizeof(SnapshotFields) == 16);
+
+FileHeader fileHeader()
+{
+    FileHeader retval{ {}, VERSION, 0 };
+    std::memcpy(retval.magic, MAGIC, sizeof(MAGIC));
+    return retval;
+}
+
+template<typename T>
+T read(const char* data)
+{
+    T retval;
+    std::memcpy(&retval, data, sizeof(T));
+    return retval;
+}
+
+template<typename T>
+void append(std::string& out, const T& value)
+{
+    out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+// writes the record's size into its header once it is all there
+void finish(std::string& out, std::size_t start)
+{
+    out.resize(start + (out.size() - start + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT, '\0');
+
+    const auto size = static_cast<std::uint32_t>(out.size() - start);
+    std::memcpy(out.data() + start, &size, sizeof(size));
+}
+
+std::string_view fieldText(std::string_view text)
+{
+    // a record keeps at most 64K of any one field, which only a very odd
+    // url would ever need
+    return text.substr(0, 0xffff);
+}
+
+} // namespace
+
+PostStore::PostStore(const std::string& filename)
+    : _filename{ filename }
+{
+    load();
+}
+
+std::string PostStore::key(const std::string& endpoint, const Params& params)
+{
+    std::string retval{ endpoint };
+
+    char separator = '?';
+    for (const auto& [name, value] : params)
+    {
+        if (name == "after" || name == "before" || name == "count" || name == "limit") continue;
+
+        retval.append(1, separator).append(name).append("=").append(value);
+        separator = '&';
+    }
+
+    return retval;
+}
+
+void PostStore::put(const std::string& listing, const LinkPage& page, std::uint32_t saved)
+{
+    std::lock_guard<std::mutex> lock{ _mutex };
+
+    // someone else has written to the file since we last looked
+    if (boost::system::error_code error; boost::filesystem::file_size(_filename, error) != _end || error)
+    {
+        load();
+    }
+
+    _buffer.clear();
+
+    try
+    {
+        std::vector<std::uint64_t> offsets;
+        offsets.reserve(page.size());
+
+        for (const auto& link : page)
+        {
+            offsets.push_back(appendLink(link));
+        }
+
+        const auto start = _buffer.size();
+        const auto key = fieldText(listing);
+
+        append(_buffer, RecordHeader{ 0, RecordType::SNAPSHOT, {} });
+        append(_buffer, SnapshotFields{ saved, static_cast<std::uint32_t>(offsets.size()),
+            static_cast<std::uint16_t>(key.size()), {} });
+
+        for (const auto offset : offsets)
+        {
+            append(_buffer, offset);
+        }
+
+        _buffer.append(key);
+        finish(_buffer, start);
+
+        _snapshots.insert_or_assign(std::string{ key }, _end + start);
+        flush();
+    }
+    catch (...)
+    {
+        // the indexes may point at records that never made it
+        _buffer.clear();
+        load();
+        throw;
+    }
+
+    if (_end >= _compactAt)
+    {
+        if (liveBytes() * 2 <= _end)
+        {
+            rewrite();
+        }
+
+        _compactAt = std::max(MIN_COMPACT_SIZE, _end * 2);
+    }
+}
+
+std::optional<PostStore::Snapshot> PostStore::get(const std::string& listing, std::size_t limit) const
+{
+    std::lock_guard<std::mutex> lock{ _mutex };
+
+    const auto found = _snapshots.find(listing);
+    if (found == _snapshots.end()) return {};
+
+    const auto* record = _data + found->second;
+    const auto fields = read<SnapshotFields>(record + sizeof(RecordHeader));
+
+    Snapshot retval;
+    retval.saved = fields.saved;
+
+    const auto count = std::min<std::size_t>(fields.count, limit);
+    retval.page.reserve(count);
+
+    for (std::size_t i = 0; i < count; i++)
+    {
+        retval.page.append(readLink(read<std::uint64_t>(record + SNAPSHOT_OFFSETS + i * sizeof(std::uint64_t))));
+    }
+
+    return retval;
+}
+
+bool PostStore::find(std::string_view fullname, LinkPage& page) const
+{
+    std::lock_guard<std::mutex> lock{ _mutex };
+
+    const auto found = _links.find(SeenSet::key(fullname));
+    if (found == _links.end()) return false;
+
+    const auto link = readLink(found->second);
+    if (link.name != fullname) return false;
+
+    page.append(link);
+    return true;
+}
+
+void PostStore::compact()
+{
+    std::lock_guard<std::mutex> lock{ _mutex };
+
+    rewrite();
+    _compactAt = std::max(MIN_COMPACT_SIZE, _end * 2);
+}
+
+PostStore::Stats PostStore::stats() const
+{
+    std::lock_guard<std::mutex> lock{ _mutex };
+
+    Stats retval;
+    retval.fileBytes = _end;
+    retval.liveBytes = liveBytes();
+    retval.links = _links.size();
+    retval.snapshots = _snapshots.size();
+
+    return retval;
+}
+
+void PostStore::load()
+{
+    namespace bfs = boost::filesystem;
+
+    unmap();
+    _links.clear();
+    _snapshots.clear();
+
+    boost::system::error_code error;
+    const auto size = bfs::exists(_filename, error) ? bfs::file_size(_filename, error) : 0;
+
+    bool valid = size >= sizeof(FileHeader);
+    if (valid)
+    {
+        FileHeader header;
+        std::ifstream in{ _filename, std::ios::binary };
+        if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)))
+        {
+            throw std::runtime_error(fmt::format("could not read '{}'", _filename));
+        }
+
+        if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0)
+        {
+            // not ours to overwrite
+            throw std::runtime_error(fmt::format("'{}' is not a post store", _filename));
+        }
+
+        // an older layout is just a cache we no longer understand
+        valid = header.version == VERSION;
+    }
+
+    if (!valid)
+    {
+        const auto header = fileHeader();
+
+        std::ofstream out{ _filename, std::ios::binary | std::ios::trunc };
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        if (!out.flush())
+        {
+            throw std::runtime_error(fmt::format("could not create '{}'", _filename));
+        }
+    }
+
+    map();
+
+    // the latest record of everything, stopping at the first one that is
+    // not whole, which is what a crash in the middle of a write leaves
+    const auto mapped = static_cast<std::uint64_t>(_region.get_size());
+    std::uint64_t pos = sizeof(FileHeader);
+
+    while (pos + sizeof(RecordHeader) <= mapped)
+    {
+        const auto header = read<RecordHeader>(_data + pos);
+        if (header.size < sizeof(RecordHeader) || header.size % ALIGNMENT != 0 || pos + header.size > mapped) break;
+
+        if (header.type == RecordType::LINK)
+        {
+            if (header.size < LINK_TEXT) break;
+
+            const auto fields = read<LinkFields>(_data + pos + sizeof(RecordHeader));
+
+            std::uint64_t text = 0;
+            for (const auto length : fields.lengths) text += length;
+            if (LINK_TEXT + text > header.size) break;
+
+            const std::string_view name{ _data + pos + LINK_TEXT + fields.lengths[0], fields.lengths[1] };
+            _links.insert_or_assign(SeenSet::key(name), pos);
+        }
+        else if (header.type == RecordType::SNAPSHOT)
+        {
+            if (header.size < SNAPSHOT_OFFSETS) break;
+
+            const auto fields = read<SnapshotFields>(_data + pos + sizeof(RecordHeader));
+            if (SNAPSHOT_OFFSETS + fields.count * sizeof(std::uint64_t) + fields.keyLength > header.size) break;
+
+            // every link must have been written before the snapshot
+            bool links = true;
+            for (std::uint32_t i = 0; i < fields.count && links; i++)
+            {
+                const auto offset = read<std::uint64_t>(_data + pos + SNAPSHOT_OFFSETS + i * sizeof(std::uint64_t));
+                links = offset >= sizeof(FileHeader) && offset % ALIGNMENT == 0 && offset + LINK_TEXT <= pos
+                    && read<RecordHeader>(_data + offset).type == RecordType::LINK
+                    && offset + read<RecordHeader>(_data + offset).size <= pos;
+            }
+
+            if (!links) break;
+
+            const std::string_view key{ _data + pos + SNAPSHOT_OFFSETS + fields.count * sizeof(std::uint64_t), fields.keyLength };
+            _snapshots.insert_or_assign(std::string{ key }, pos);
+        }
+        else
+        {
+            break;
+        }
+
+        pos += header.size;
+    }
+
+    _end = pos;
+
+    if (_end < mapped)
+    {
+        // cut off the broken tail so the next record goes where it belongs
+        unmap();
+        bfs::resize_file(_filename, _end);
+        map();
+    }
+
+    _compactAt = std::max(MIN_COMPACT_SIZE, _end * 2);
+}
+
+void PostStore::map()
+{
+    try
+    {
+        _file = bip::file_mapping{ _filename.c_str(), bip::read_only };
+        _region = bip::mapped_region{ _file, bip::read_only };
+        _data = static_cast<const char*>(_region.get_address());
+    }
+    catch (const bip::interprocess_exception& ex)
+    {
+        unmap();
+        throw std::runtime_error(fmt::format("could not map '{}': {}", _filename, ex.what()));
+    }
+}
+
+void PostStore::unmap()
+{
+    // Windows will not resize or replace a file that is mapped
+    _region = bip::mapped_region{};
+    _file = bip::file_mapping{};
+    _data = nullptr;
+}
+
+void PostStore::flush()
+{
+    if (_buffer.empty()) return;
+
+    {
+        std::ofstream out{ _filename, std::ios::binary | std::ios::app };
+        out.write(_buffer.data(), static_cast<std::streamsize>(_buffer.size()));
+
+        if (!out.flush())
+        {
+            throw std::runtime_error(fmt::format("could not write to '{}'", _filename));
+        }
+    }
+
+    _end += _buffer.size();
+    _buffer.clear();
+
+    unmap();
+    map();
+}
+
+void PostStore::rewrite()
+{
+    namespace bfs = boost::filesystem;
+
+    std::string out;
+    out.reserve(static_cast<std::size_t>(liveBytes()));
+    append(out, fileHeader());
+
+    // links shared by several snapshots are only copied once
+    std::unordered_map<std::uint64_t, std::uint64_t> moved;
+
+    for (const auto& [listing, offset] : _snapshots)
+    {
+        const auto* record = _data + offset;
+        const auto size = read<RecordHeader>(record).size;
+        const auto fields = read<SnapshotFields>(record + sizeof(RecordHeader));
+
+        std::vector<std::uint64_t> offsets;
+        offsets.reserve(fields.count);
+
+        for (std::uint32_t i = 0; i < fields.count; i++)
+        {
+            const auto old = read<std::uint64_t>(record + SNAPSHOT_OFFSETS + i * sizeof(std::uint64_t));
+
+            auto [it, added] = moved.emplace(old, out.size());
+            if (added)
+            {
+                out.append(_data + old, read<RecordHeader>(_data + old).size);
+            }
+
+            offsets.push_back(it->second);
+        }
+
+        const auto start = out.size();
+        out.append(record, size);
+        std::memcpy(out.data() + start + SNAPSHOT_OFFSETS, offsets.data(), offsets.size() * sizeof(std::uint64_t));
+    }
+
+    const auto temp = _filename + ".compact";
+    {
+        std::ofstream file{ temp, std::ios::binary | std::ios::trunc };
+        file.write(out.data(), static_cast<std::streamsize>(out.size()));
+
+        if (!file.flush())
+        {
+            boost::system::error_code error;
+            bfs::remove(temp, error);
+            throw std::runtime_error(fmt::format("could not write '{}'", temp));
+        }
+    }
+
+    unmap();
+    bfs::rename(temp, _filename);
+    load();
+}
+
+Link PostStore::readLink(std::uint64_t offset) const
+{
+    auto& pool = StringPool::instance();
+
+    const auto fields = read<LinkFields>(_data + offset + sizeof(RecordHeader));
+    const char* text = _data + offset + LINK_TEXT;
+
+    std::string_view parts[8];
+    for (std::size_t i = 0; i < 8; i++)
+    {
+        parts[i] = std::string_view{ text, fields.lengths[i] };
+        text += fields.lengths[i];
+    }
+
+    // the page the link is appended to copies the rest
+    Link retval;
+    retval.kind = pool.intern(parts[0]);
+    retval.name = parts[1];
+    retval.title = parts[2];
+    retval.url = parts[3];
+    retval.permalink = parts[4];
+    retval.author = parts[5];
+    retval.subreddit = pool.intern(parts[6]);
+    retval.flair = pool.intern(parts[7]);
+    retval.score = fields.score;
+    retval.ups = fields.ups;
+    retval.downs = fields.downs;
+    retval.comments = fields.comments;
+    retval.created = fields.created;
+    retval.stickied = fields.stickied != 0;
+
+    return retval;
+}
+
+std::uint64_t PostStore::appendLink(const Link& link)
+{
+    const std::string_view parts[8] =
+    {
+        fieldText(link.kind), fieldText(link.name), fieldText(link.title), fieldText(link.url),
+        fieldText(link.permalink), fieldText(link.author), fieldText(link.subreddit), fieldText(link.flair)
+    };
+
+    LinkFields fields{ link.score, link.ups, link.downs, link.comments, link.created,
+        static_cast<std::uint8_t>(link.stickied), {}, {} };
+
+    for (std::size_t i = 0; i < 8; i++)
+    {
+        fields.lengths[i] = static_cast<std::uint16_t>(parts[i].size());
+    }
+
+    const auto start = _buffer.size();
+    append(_buffer, RecordHeader{ 0, RecordType::LINK, {} });
+    append(_buffer, fields);
+    for (const auto& part : parts) _buffer.append(part);
+    finish(_buffer, start);
+
+    const std::string_view record{ _buffer.data() + start, _buffer.size() - start };
+    const auto key = SeenSet::key(link.name);
+
+    // the same link as last time, just point at that
+    if (const auto found = _links.find(key); found != _links.end())
+    {
+        const auto* previous = found->second < _end
+            ? _data + found->second
+            : _buffer.data() + (found->second - _end);
+
+        if (read<RecordHeader>(previous).size == record.size()
+            && std::memcmp(previous, record.data(), record.size()) == 0)
+        {
+            _buffer.resize(start);
+            return found->second;
+        }
+    }
+
+    const auto offset = _end + start;
+    _links.insert_or_assign(key, offset);
+
+    return offset;
+}
+
+std::uint64_t PostStore::liveBytes() const
+{
+    std::uint64_t retval = sizeof(FileHeader);
+    std::unordered_set<std::uint64_t> links;
+
+    for (const auto& [listing, offset] : _snapshots)
+    {
+        const auto* record = _data + offset;
+        const auto fields = read<SnapshotFields>(record + sizeof(RecordHeader));
+        retval += read<RecordHeader>(record).size;
+
+        for (std::uint32_t i = 0; i < fields.count; i++)
+        {
+            const auto link = read<std::uint64_t>(record + SNAPSHOT_OFFSETS + i * sizeof(std::uint64_t));
+            if (links.insert(link).second)
+            {
+                retval += read<RecordHeader>(_data + link).size;
+            }
+        }
+    }
+
+    return retval;
+}
+
+} // namespace arcc
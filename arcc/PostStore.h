@@ -0,0 +1,116 @@
+// Another Reddit Console Client
+// Copyright (c) 2017-2019, Adalid Claure <aclaure@gmail.com>
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include "Link.h"
+
+namespace arcc
+{
+
+using Params = std::map<std::string, std::string>;
+
+// Keeps the first page of every listing arcc has shown in a file, so the
+// next `list` of the same thing can show something before reddit answers,
+// or when it cannot be reached at all.
+//
+// The file is a log that is only ever appended to and is read through a
+// memory mapping. It holds two kinds of records, a link, and a snapshot
+// that names a listing (e.g. "/r/cpp/hot") and points at the link records
+// it was made of. A link that comes back unchanged is not written again.
+// Opening the file reads it once to find the latest record of every link
+// and every listing, after that reading a snapshot is a hash lookup and a
+// copy of its links into a page. Older records are dropped by compacting
+// the file into a new one, which happens by itself every time the file has
+// doubled since the last time, as long as at least half of it is garbage.
+//
+// The file is in the machine's byte order and meant for the machine that
+// wrote it. It is locked against other threads, but not other processes.
+class PostStore final
+{
+public:
+    struct Snapshot
+    {
+        LinkPage            page;
+        std::uint32_t       saved = 0;      // seconds since the epoch
+    };
+
+    struct Stats
+    {
+        std::uint64_t       fileBytes = 0;
+        std::uint64_t       liveBytes = 0;  // what compacting would keep
+        std::size_t         links = 0;      // distinct links
+        std::size_t         snapshots = 0;  // distinct listings
+    };
+
+    // compaction is not worth it below this
+    static constexpr std::uint64_t MIN_COMPACT_SIZE = 1024 * 1024;
+
+private:
+    mutable std::mutex                                  _mutex;
+    const std::string                                   _filename;
+
+    boost::interprocess::file_mapping                   _file;
+    boost::interprocess::mapped_region                  _region;
+    const char*                                         _data = nullptr;
+    std::uint64_t                                       _end = 0;           // end of the last whole record
+
+    std::unordered_map<std::uint64_t, std::uint64_t>    _links;             // SeenSet::key(fullname) to its latest record
+    std::unordered_map<std::string, std::uint64_t>      _snapshots;         // listing to its latest snapshot record
+    std::uint64_t                                       _compactAt = MIN_COMPACT_SIZE;
+
+    std::string                                         _buffer;            // records waiting to be written
+
+public:
+    // opens `filename`, or creates it, and throws std::runtime_error if it
+    // cannot be read or written
+    explicit PostStore(const std::string& filename);
+
+    PostStore(const PostStore&) = delete;
+    PostStore& operator=(const PostStore&) = delete;
+
+    const std::string& filename() const { return _filename; }
+
+    // the name a listing is stored under, its endpoint and parameters
+    // other than its cursors and page size
+    static std::string key(const std::string& endpoint, const Params& params);
+
+    // replaces the snapshot of `listing`
+    void put(const std::string& listing, const LinkPage& page, std::uint32_t saved);
+
+    // the latest snapshot of `listing`, at most `limit` links of it
+    std::optional<Snapshot> get(const std::string& listing, std::size_t limit) const;
+
+    // the latest record of a link, copied into `page`
+    bool find(std::string_view fullname, LinkPage& page) const;
+
+    // writes what is still in use to a new file and swaps it in
+    void compact();
+
+    Stats stats() const;
+
+private:
+    void load();
+    void map();
+    void unmap();
+    void flush();
+    void rewrite();
+
+    Link readLink(std::uint64_t offset) const;
+    std::uint64_t appendLink(const Link& link);
+
+    std::uint64_t liveBytes() const;
+};
+
+} // namespace arcc
@@ -0,0 +1,164 @@
+// Another Reddit Console Client
+// Copyright (c) 2017-2019, Adalid Claure <aclaure@gmail.com>
+
+#include <algorithm>
+#include <cstdlib>
+#include <optional>
+#include <string>
+
+#include "RateLimiter.h"
+
+namespace arcc
+{
+
+namespace
+{
+    // never crawl slower than this, even when the window is nearly used up
+    constexpr double MIN_RATE = 0.01;
+
+    // how long to back off after a 429 that told us nothing else
+    constexpr std::chrono::milliseconds DEFAULT_BACKOFF{ 1000 };
+
+    std::optional<double> headerValue(const WebClient::Headers& headers, const std::string& name)
+    {
+        if (auto it = headers.find(name); it != headers.end())
+        {
+            char* end = nullptr;
+            const double value = std::strtod(it->second.c_str(), &end);
+            if (end != it->second.c_str())
+            {
+                return value;
+            }
+        }
+
+        return {};
+    }
+}
+
+RateLimiter::RateLimiter(double rate, double burst)
+    : _tokens{ burst },
+      _capacity{ burst },
+      _rate{ rate },
+      _defaultRate{ rate },
+      _lastRefill{ Clock::now() },
+      _pausedUntil{ Clock::now() }
+{
+}
+
+void RateLimiter::refill(Clock::time_point now)
+{
+    const std::chrono::duration<double> elapsed = now - _lastRefill;
+    _tokens = std::min(_capacity, _tokens + elapsed.count() * _rate);
+    _lastRefill = now;
+}
+
+void RateLimiter::acquire(RequestPriority priority)
+{
+    std::unique_lock<std::mutex> lock{ _mutex };
+
+    const Ticket ticket{ static_cast<int>(priority), _nextTicket++ };
+    _waiting.insert(ticket);
+
+    while (true)
+    {
+        const auto now = Clock::now();
+        refill(now);
+
+        if (*_waiting.begin() != ticket)
+        {
+            // someone more important or earlier is ahead of us
+            _cv.wait(lock);
+            continue;
+        }
+
+        if (now < _pausedUntil)
+        {
+            _cv.wait_until(lock, _pausedUntil);
+            continue;
+        }
+
+        if (_tokens >= 1.0)
+        {
+            _tokens -= 1.0;
+            _waiting.erase(ticket);
+
+            // let the next in line check its turn
+            _cv.notify_all();
+            return;
+        }
+
+        const std::chrono::duration<double> untilNext{ (1.0 - _tokens) / _rate };
+        _cv.wait_for(lock, untilNext);
+    }
+}
+
+void RateLimiter::update(const WebClient::Headers& headers, long status)
+{
+    const auto remaining = headerValue(headers, "x-ratelimit-remaining");
+    const auto used = headerValue(headers, "x-ratelimit-used");
+    const auto reset = headerValue(headers, "x-ratelimit-reset");
+
+    if (remaining && reset)
+    {
+        update(*remaining, used.value_or(0.0), *reset);
+    }
+
+    if (status == 429)
+    {
+        const auto retry = headerValue(headers, "retry-after");
+        const auto wait = retry ? std::chrono::milliseconds{ static_cast<std::int64_t>(*retry * 1000) }
+            : reset ? std::chrono::milliseconds{ static_cast<std::int64_t>(*reset * 1000) }
+            : DEFAULT_BACKOFF;
+
+        pause(std::max(wait, DEFAULT_BACKOFF));
+    }
+}
+
+void RateLimiter::update(double remaining, [[maybe_unused]] double used, double resetSeconds)
+{
+    std::lock_guard<std::mutex> lock{ _mutex };
+
+    const auto now = Clock::now();
+    refill(now);
+
+    if (remaining < 1.0)
+    {
+        // the window is spent, nothing goes out until it resets and
+        // then we start over at the default pace
+        _tokens = 0;
+        _rate = _defaultRate;
+        _pausedUntil = std::max(_pausedUntil, now + 
+            std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>{ resetSeconds }));
+    }
+    else
+    {
+        // spread what is left evenly over the rest of the window, and
+        // never allow a burst bigger than what the server will accept
+        _rate = std::max(MIN_RATE, remaining / std::max(resetSeconds, 1.0));
+        _tokens = std::min(_tokens, remaining);
+    }
+
+    _cv.notify_all();
+}
+
+void RateLimiter::pause(std::chrono::milliseconds duration)
+{
+    std::lock_guard<std::mutex> lock{ _mutex };
+    _tokens = 0;
+    _pausedUntil = std::max(_pausedUntil, Clock::now() + duration);
+    _cv.notify_all();
+}
+
+double RateLimiter::rate() const
+{
+    std::lock_guard<std::mutex> lock{ _mutex };
+    return _rate;
+}
+
+std::size_t RateLimiter::waiting() const
+{
+    std::lock_guard<std::mutex> lock{ _mutex };
+    return _waiting.size();
+}
+
+} // namespace arcc
@@ -0,0 +1,68 @@
+// Another Reddit Console Client
+// Copyright (c) 2017-2019, Adalid Claure <aclaure@gmail.com>
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <set>
+#include <utility>
+
+#include "WebClient.h"
+
+namespace arcc
+{
+
+// Requests with a lower value always go first
+enum class RequestPriority
+{
+    INTERACTIVE = 0,        // the user is waiting on it
+    BACKGROUND = 1          // prefetching and other speculative work
+};
+
+// Token bucket that spaces out requests to stay within reddit's rate limit.
+// The refill rate follows the `X-Ratelimit-*` headers of every response so
+// the remaining budget is spread evenly over what is left of the window.
+// Callers queue in acquire() ordered by priority and then arrival.
+class RateLimiter final
+{
+    using Clock = std::chrono::steady_clock;
+    using Ticket = std::pair<int, std::uint64_t>;               // priority, arrival
+
+    mutable std::mutex          _mutex;
+    std::condition_variable     _cv;
+
+    double                      _tokens;
+    double                      _capacity;                      // the largest burst we allow
+    double                      _rate;                          // tokens per second
+    const double                _defaultRate;                   // used whenever a new window starts
+    Clock::time_point           _lastRefill;
+    Clock::time_point           _pausedUntil;                   // set when the window is exhausted
+
+    std::uint64_t               _nextTicket = 0;
+    std::set<Ticket>            _waiting;
+
+public:
+    // reddit allows 100 requests a minute for OAuth clients
+    explicit RateLimiter(double rate = 100.0 / 60.0, double burst = 10.0);
+
+    // blocks until the caller may send a request
+    void acquire(RequestPriority priority = RequestPriority::INTERACTIVE);
+
+    // adjusts the bucket to the limits reported by a response
+    void update(const WebClient::Headers& headers, long status);
+    void update(double remaining, double used, double resetSeconds);
+
+    // stop handing out tokens for a while, such as after a 429
+    void pause(std::chrono::milliseconds duration);
+
+    double rate() const;
+    std::size_t waiting() const;
+
+private:
+    void refill(Clock::time_point now);
+};
+
+} // namespace arcc
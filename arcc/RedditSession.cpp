@@ -13,12 +13,25 @@
 #include "core.h"
 #include "utils.h"
 #include "OAuth2Login.h"
+#include "WebClient.h"
 
 #include "RedditSession.h"
 
 namespace arcc
 {
 
+namespace
+{
+    // a throttled request is retried this many times once the limiter allows it
+    constexpr auto MAX_RATELIMIT_RETRIES = 1u;
+
+    // renew the token this long before it expires unless told otherwise
+    constexpr auto DEFAULT_REFRESH_MARGIN = std::chrono::seconds{ 300 };
+
+    // how long the refresher waits before trying again after a failed refresh
+    constexpr auto REFRESH_RETRY_DELAY = std::chrono::seconds{ 30 };
+}
+
 std::string buildQueryParamString(const Params& params)
 {
     std::string retval;
@@ -40,15 +53,17 @@ std::string buildQueryParamString(const Params& params)
 }
 
 RedditSession::RedditSession()
-    : _expiry { 0 }
+    : _token { std::make_shared<const Token>() },
+        _location { std::make_shared<const std::string>() },
+        _refreshMargin { DEFAULT_REFRESH_MARGIN }
 {
     const std::string userAgent = fmt::format("{}:{}:v{} (by /u/ll)"
         ,utils::getOsString()
         ,APP_TITLE
         ,VERSION);
 
-    _webclient.setUserAgent(userAgent);
-    _webclient.setHeader("Authorization: bearer " + _accessToken);
+    _userAgent = userAgent;
+    setTransport(std::make_shared<WebClient>());
 }
 
 // RedditSession::RedditSession(const std::string& accessToken, const std::string& refreshToken, double expiry)
@@ -57,36 +72,69 @@ RedditSession::RedditSession()
 // }
 
 RedditSession::RedditSession(const std::string& accessToken, const std::string& refreshToken, double expiry, time_t lastRefresh)
-    : _accessToken(accessToken), 
-        _refreshToken(refreshToken), 
-        _expiry(expiry),
-        _loggedIn(true)
+    : _location { std::make_shared<const std::string>() },
+        _refreshMargin { DEFAULT_REFRESH_MARGIN }
 {
     const std::string userAgent = fmt::format("{}:{}:v{} (by /u/wolosocu)"
         ,utils::getOsString() 
         ,APP_TITLE 
         ,VERSION);
 
-    _webclient.setUserAgent(userAgent);
-    _webclient.setHeader("Authorization: bearer " + _accessToken);
+    auto token = std::make_shared<Token>();
+    token->accessToken = accessToken;
+    token->refreshToken = refreshToken;
+    token->expiry = expiry;
+    token->loggedIn = true;
 
     if (lastRefresh != 0)
     {
-        _lastRefresh = lastRefresh;
+        token->lastRefresh = lastRefresh;
     }
     else
     {
-        _lastRefresh = std::time(nullptr);
+        token->lastRefresh = std::time(nullptr);
     }
+
+    _token.store(std::move(token));
+
+    _userAgent = userAgent;
+    setTransport(std::make_shared<WebClient>());
 }
 
-std::string RedditSession::doGetRequest(
-    const std::string& endpoint,
-    const Params& params,
-    bool verbose)
+RedditSession::~RedditSession()
 {
-    doRefreshToken();
+    {
+        std::lock_guard<std::mutex> lock{ _refresherMutex };
+        _stopRefresher = true;
+    }
+
+    _refresherCv.notify_all();
+    if (_refresher.joinable())
+    {
+        _refresher.join();
+    }
+}
+
+void RedditSession::setRefreshMargin(std::chrono::seconds margin)
+{
+    {
+        std::lock_guard<std::mutex> lock{ _refresherMutex };
+        _refreshMargin = margin;
+    }
+
+    // the refresher may now be due sooner or later than it thinks
+    _refresherCv.notify_all();
+}
+
+void RedditSession::setTransport(TransportPtr transport)
+{
+    transport->setUserAgent(_userAgent);
+    transport->setHeader("Authorization: bearer " + accessToken());
+    _transport.store(std::move(transport));
+}
 
+std::string RedditSession::buildRequestUrl(const std::string& endpoint, const Params& params) const
+{
     // clean the endpoint since a malformed endpoint can
     // cause timeouts and other non-descript behavior
     std::string cleanpoint { endpoint };
@@ -97,20 +145,54 @@ std::string RedditSession::doGetRequest(
         if (cleanpoint.at(cleanpoint.size()-1) == '/') cleanpoint.pop_back();
     }
 
-    _lastRequest = _oauthUrl + cleanpoint + buildQueryParamString(params);
+    return _apiUrl + cleanpoint + buildQueryParamString(params);
+}
+
+std::string RedditSession::doGetRequest(
+    const std::string& endpoint,
+    const Params& params,
+    bool verbose,
+    RequestPriority priority,
+    CancelFlag cancel)
+{
+    ensureToken();
+
+    const std::string url = buildRequestUrl(endpoint, params);
     
     if (verbose)
     {
-        std::cout << "request url: " << _lastRequest << std::endl;
+        std::cout << "request url: " << url << std::endl;
     }
 
-    auto result = _webclient.doRequest(_lastRequest);
-    if (verbose)
-    {
-        std::cout << "response: " << result << std::endl;
-    }
+    auto fetch = [&]()
+        {
+            const auto transport = _transport.load();
 
-    return result.data;
+            Transport::Reply result;
+            for (auto attempt = 0u; attempt <= MAX_RATELIMIT_RETRIES; attempt++)
+            {
+                _limiter.acquire(priority);
+
+                if (cancel && *cancel)
+                {
+                    throw WebClientError("Request error: cancelled");
+                }
+
+                result = transport->send(Transport::Request{ url, std::string{}, Transport::Method::GET, nullptr, cancel }).get();
+                _limiter.update(result.headers, result.status);
+
+                if (result.status != 429) break;
+            }
+
+            if (verbose)
+            {
+                std::cout << "response: " << result << std::endl;
+            }
+
+            return std::move(result.data);
+        };
+
+    return cancel ? fetch() : _textFlights.run(url, fetch);
 }
 
 bool RedditSession::load(const std::string& filename)
@@ -124,12 +206,16 @@ bool RedditSession::load(const std::string& filename)
         nl::json j = nl::json::parse(in);
         in.close();
 
-        _accessToken = j["accessToken"].get<std::string>();
-        _refreshToken = j["refreshToken"].get<std::string>();
-        _expiry = j["expiry"].get<double>();
-        _lastRefresh = j["time"].get<time_t>();
+        auto token = std::make_shared<Token>();
+        token->accessToken = j["accessToken"].get<std::string>();
+        token->refreshToken = j["refreshToken"].get<std::string>();
+        token->expiry = j["expiry"].get<double>();
+        token->lastRefresh = j["time"].get<time_t>();
+        token->loggedIn = !token->accessToken.empty() && !token->refreshToken.empty();
 
-        _loggedIn = !_accessToken.empty() && !_refreshToken.empty();
+        _transport.load()->setHeader("Authorization: bearer " + token->accessToken);
+        _token.store(std::move(token));
+        _refresherCv.notify_all();
         return true;
     }
 
@@ -145,11 +231,12 @@ void RedditSession::save(const std::string& filename)
 
     nl::json j;
 
-    j["accessToken"] = _accessToken;
-    j["refreshToken"] = _refreshToken;
-    j["expiry"] = _expiry;
-    j["time"] = _lastRefresh;
-    j["location"] = _location;
+    const auto token = _token.load();
+    j["accessToken"] = token->accessToken;
+    j["refreshToken"] = token->refreshToken;
+    j["expiry"] = token->expiry;
+    j["time"] = token->lastRefresh;
+    j["location"] = location();
 
     std::ofstream out(sessionfile.string());
     out << j;
@@ -158,55 +245,163 @@ void RedditSession::save(const std::string& filename)
 
 void RedditSession::reset()
 {
-    _accessToken.clear();
-    _refreshToken.clear();
-    _expiry = 0;
-    _lastRefresh = 0;
-    _location.clear();
+    _token.store(std::make_shared<const Token>());
+    setLocation(std::string{});
 }
 
-void RedditSession::doRefreshToken()
+bool RedditSession::Token::needsRefresh(std::chrono::seconds margin) const
+{
+    if (expiry <= 0) return true;
+
+    const std::time_t elapsed_seconds = std::time(nullptr) - lastRefresh;
+    return elapsed_seconds + margin.count() >= expiry;
+}
+
+void RedditSession::ensureToken()
+{
+    // started by the first request so that nothing goes out before the
+    // transport and urls are set up
+    std::call_once(_refresherStarted,
+        [this]() { _refresher = std::thread(&RedditSession::runRefresher, this); });
+
+    if (!_token.load()->needsRefresh(std::chrono::seconds::zero())) return;
+
+    // the refresher normally gets there first, so this only blocks
+    // on a fresh session or when the background refresh failed
+    renewToken(std::chrono::seconds::zero());
+}
+
+bool RedditSession::renewToken(std::chrono::seconds margin)
+{
+    return _refreshFlight.run(0,
+        [this, margin]()
+        {
+            // whoever held the flight before us may have just renewed it
+            if (!_token.load()->needsRefresh(margin)) return true;
+
+            return doRefreshToken();
+        });
+}
+
+bool RedditSession::doRefreshToken()
 {
     constexpr auto REDDIT_CLIENT_ID = "client_id??";
-    
-    std::time_t elapsed_seconds = std::time(nullptr) - _lastRefresh;
-    if (elapsed_seconds > _expiry || _expiry == 0)
+
+    const auto current = _token.load();
+    const auto transport = _transport.load();
+
+    // same kind of transport, but without our bearer header
+    auto client = transport->makeSibling();
+    std::string postData;
+
+    if (current->loggedIn)
+    {
+        client->setBasicAuth(REDDIT_CLIENT_ID,"");
+        postData = fmt::format("grant_type=refresh_token&refresh_token={}", current->refreshToken);
+    }
+    else
     {
-        WebClient client;
-        std::string postData;
+        client->setBasicAuth(REDDIT_CLIENT_ID,"client_secret??");
+        postData = "grant_type=https://oauth.reddit.com/grants/installed_client&\\&device_id=34jr438r043j0438j043";
+    }
+
+    auto result = client->doRequest(_authUrl + "/api/v1/access_token", postData, Transport::Method::POST);
 
-        if (loggedIn())
+    // besides load() and reset() on the console thread only the refresh
+    // flight replaces the token, so building on `current` is safe
+    auto token = std::make_shared<Token>(*current);
+
+    const auto jreply = result.status == 200
+        ? nlohmann::json::parse(result.data, nullptr, false) : nlohmann::json{};
+
+    if (!jreply.is_object() || !jreply.contains("access_token"))
+    {
+        // reddit turns a refresh token down with a 400 or 401, whose body
+        // never reaches us, or with an `invalid_grant` error
+        const bool rejected = result.status == 400 || result.status == 401
+            || (jreply.is_object() && jreply.value("error", "") == "invalid_grant");
+
+        // a token that still works is kept for the refresher to try again,
+        // only a rejected refresh token or an expired one leave us a guest
+        if (current->loggedIn && (rejected || current->needsRefresh(std::chrono::seconds::zero())))
         {
-            client.setBasicAuth(REDDIT_CLIENT_ID,"");
-            postData = fmt::format("grant_type=refresh_token&refresh_token={}", _refreshToken);
+            token->loggedIn = false;
+            _token.store(std::move(token));
         }
-        else
+
+        return false;
+    }
+
+    token->accessToken = jreply.at("access_token").get<std::string>();
+    token->expiry = jreply.value("expires_in", token->expiry);
+    token->lastRefresh = std::time(nullptr);
+    token->loggedIn = !token->accessToken.empty();
+
+    // in-flight requests keep the header they started with
+    transport->setHeader("Authorization: bearer " + token->accessToken);
+    _token.store(std::move(token));
+
+    {
+        // saving is left to the refresher so the caller can get on with its request
+        std::lock_guard<std::mutex> lock{ _refresherMutex };
+        _savePending = true;
+    }
+
+    _refresherCv.notify_all();
+    return true;
+}
+
+void RedditSession::runRefresher()
+{
+    std::unique_lock<std::mutex> lock{ _refresherMutex };
+
+    while (!_stopRefresher)
+    {
+        if (_savePending)
         {
-            client.setBasicAuth(REDDIT_CLIENT_ID,"client_secret??");
-            postData = "grant_type=https://oauth.reddit.com/grants/installed_client&\\&device_id=34jr438r043j0438j043";
-        }
+            _savePending = false;
+            auto callback = _refreshCallback;
 
-        auto result = client.doRequest("https://www.reddit.com/api/v1/access_token", postData, WebClient::Method::POST);
+            lock.unlock();
+            if (callback) callback();
+            lock.lock();
+            continue;
+        }
 
-        if (result.status == 200)
+        const auto token = _token.load();
+        if (token->expiry <= 0)
         {
-            auto jreply = nlohmann::json::parse(result.data);
+            // nothing to renew until someone gets a first token
+            _refresherCv.wait(lock);
+            continue;
+        }
 
-            _accessToken = jreply["access_token"].get<std::string>();
-            _webclient.setHeader("Authorization: bearer " + _accessToken);
+        if (!token->needsRefresh(_refreshMargin))
+        {
+            const auto due = std::chrono::system_clock::from_time_t(token->lastRefresh)
+                + std::chrono::seconds{ static_cast<std::int64_t>(token->expiry) } - _refreshMargin;
 
-            _lastRefresh = std::time(nullptr);
+            _refresherCv.wait_until(lock, due);
+            continue;
+        }
 
-            if (_refreshCallback)
-            {
-                _refreshCallback();
-            }
+        const auto margin = _refreshMargin;
+        lock.unlock();
 
-            _loggedIn = !_accessToken.empty();
+        bool renewed = false;
+        try
+        {
+            renewed = renewToken(margin);
         }
-        else
+        catch (const std::exception&)
+        {
+            // a network hiccup, try again later
+        }
+
+        lock.lock();
+        if (!renewed && !_stopRefresher)
         {
-            _loggedIn = false;
+            _refresherCv.wait_for(lock, REFRESH_RETRY_DELAY);
         }
     }
 }
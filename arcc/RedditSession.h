@@ -4,13 +4,20 @@
 #pragma once
 
 #include <string>
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
+#include <thread>
 
 #include <boost/format.hpp>
 
 #include "Listing.h"
-#include "WebClient.h"
+#include "RateLimiter.h"
+#include "SingleFlight.h"
+#include "Snapshot.h"
+#include "Transport.h"
 
 namespace arcc
 {
@@ -18,49 +25,102 @@ namespace arcc
 class RedditSession;
 using RedditSessionPtr = std::weak_ptr<RedditSession>;
 
+// Every request method may be called from any number of threads at once.
+// Each request gets its own pooled handle from the transport, the token and
+// transport are shared as snapshots that are swapped whole.
 class RedditSession final 
     : public std::enable_shared_from_this<RedditSession>
 {
-    std::function<void(void)>   _refreshCallback;
+    // an immutable snapshot of the OAuth state, a new token means a new
+    // snapshot so that request threads never have to take a lock
+    struct Token
+    {
+        std::string     accessToken;
+        std::string     refreshToken;
+        double          expiry = 0;             // number of seconds until the session needs refresh
+        time_t          lastRefresh = 0;        // keep track so we know when to refresh our token
+        bool            loggedIn = false;
+
+        bool needsRefresh(std::chrono::seconds margin) const;
+    };
+
+    // set these up before the first request, they are not synchronized
+    std::string                 _apiUrl = "https://oauth.reddit.com";
+    std::string                 _authUrl = "https://www.reddit.com";
+    std::string                 _redditClientID;
+    std::string                 _userAgent;
 
-    const std::string           _oauthUrl = "https://oauth.reddit.com";
+    Snapshot<const Token>       _token;
+    Snapshot<Transport>         _transport;             // our "connection" to www.reddit.com
+    RateLimiter                 _limiter;               // keeps us within reddit's API limits
 
-    std::string                 _accessToken;
-    std::string                 _refreshToken;
+    // identical GETs that are already in flight are shared instead of resent
+    SingleFlight<std::string, std::string>      _textFlights;
 
-    std::string                 _redditClientID;
-    
-    double                      _expiry;                // number of seconds until the session needs refresh
-    time_t                      _lastRefresh;           // keep track so we know when to refresh our token
-    WebClient                   _webclient;             // our "connection" to www.reddit.com
+    // callers that find the token expired at the same time share one refresh
+    SingleFlight<int, bool>                     _refreshFlight;
+
+    Snapshot<const std::string> _location;
+
+    // the refresher's bookkeeping, guarded by `_refresherMutex`
+    mutable std::mutex          _refresherMutex;
+    std::function<void(void)>   _refreshCallback;
+    std::chrono::seconds        _refreshMargin;         // how long before expiry the refresher renews
+    bool                        _savePending = false;   // a new token still has to go through _refreshCallback
+    bool                        _stopRefresher = false;
 
-    bool                        _loggedIn = false;
-    std::string                 _lastRequest;
-    std::string                 _location;
+    std::condition_variable     _refresherCv;
+    std::once_flag              _refresherStarted;
+    std::thread                 _refresher;             // renews the token ahead of expiry
 
 public:
 
     RedditSession();
     // RedditSession(const std::string& accessToken, const std::string& refreshToken, double expiry);
     RedditSession(const std::string& accessToken, const std::string& refreshToken, double expiry, time_t lastRefresh);
+    ~RedditSession();
+
+    RedditSession(const RedditSession&) = delete;
+    RedditSession& operator=(const RedditSession&) = delete;
 
+    // returns the body of the response, empty if the request failed, throws
+    // WebClientError if the transfer failed or was cancelled
     std::string doGetRequest(const std::string& endpoint,
                               const Params& params = Params{},
-                              bool verbose = false);
+                              bool verbose = false,
+                              RequestPriority priority = RequestPriority::INTERACTIVE,
+                              CancelFlag cancel = nullptr);
+
+    std::string accessToken() const { return _token.load()->accessToken; }
+    std::string refreshToken() const { return _token.load()->refreshToken; }
+    double expiry() const { return _token.load()->expiry; }
+    time_t lastRefresh() const { return _token.load()->lastRefresh; }
+    bool loggedIn() const { return _token.load()->loggedIn; }
 
-    std::string accessToken() const { return _accessToken; }
-    std::string refreshToken() const { return _refreshToken; }
-    double expiry() const { return _expiry; }
-    time_t lastRefresh() const { return _lastRefresh; }
+    // the token is renewed in the background this long before it expires
+    std::chrono::seconds refreshMargin() const { std::lock_guard<std::mutex> lock{ _refresherMutex }; return _refreshMargin; }
+    void setRefreshMargin(std::chrono::seconds margin);
 
-    std::string location() const { return _location; }
-    void setLocation(const std::string& val) { _location = val; }
+    std::string location() const { return *_location.load(); }
+    void setLocation(const std::string& val) { _location.store(std::make_shared<const std::string>(val)); }
 
-    bool loggedIn() const { return _loggedIn; }
-    std::string lastRequest() const { return _lastRequest; }
+    // where API requests and token refreshes go, normally reddit itself
+    // but these can point at a local mock server instead
+    std::string apiUrl() const { return _apiUrl; }
+    void setApiUrl(const std::string& val) { _apiUrl = val; }
 
+    std::string authUrl() const { return _authUrl; }
+    void setAuthUrl(const std::string& val) { _authUrl = val; }
+
+    // swap the transport used for every request, e.g. to record or replay
+    // a session, the user agent and bearer token carry over
+    void setTransport(TransportPtr transport);
+    TransportPtr transport() const { return _transport.load(); }
+
+    // called on the refresher thread after the token was renewed
     void setRefreshCallback(std::function<void(void)> cb)
     {
+        std::lock_guard<std::mutex> lock{ _refresherMutex };
         _refreshCallback = cb;
     }
 
@@ -70,7 +130,12 @@ public:
     void reset();
 
 private:
-    void doRefreshToken();   
+    void ensureToken();
+    bool renewToken(std::chrono::seconds margin);
+    bool doRefreshToken();
+    void runRefresher();
+
+    std::string buildRequestUrl(const std::string& endpoint, const Params& params) const;
 };
 
 std::ostream & operator<<(std::ostream& os, const arcc::Params& params);
@@ -0,0 +1,837 @@
+// Another Reddit Console Client
+// Copyright (c) 2017-2019, Adalid Claure <aclaure@gmail.com>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+
+#include <boost/filesystem.hpp>
+#include <fmt/core.h>
+
+#include "SeenSet.h"
+#include "StringPool.h"
+#include "SearchIndex.h"
+
+namespace arcc
+{
+
+namespace
+{
+
+constexpr char MAGIC[8] = { 'A', 'R', 'C', 'C', 'F', 'I', 'N', 'D' };
+constexpr std::uint32_t VERSION = 1;
+constexpr std::size_t HEADER_SIZE = sizeof(MAGIC) + 2 * sizeof(std::uint32_t);
+
+// replaced records are only dropped once there are this many bytes of them
+// and they outweigh the live ones
+constexpr std::size_t MIN_COMPACT_GARBAGE = 1024 * 1024;
+
+// the order the text of a link is kept in a record
+enum Text : std::size_t
+{
+    KIND,
+    NAME,
+    TITLE,
+    URL,
+    PERMALINK,
+    AUTHOR,
+    SUBREDDIT,
+    FLAIR,
+    TEXT_COUNT
+};
+
+// a varint is 7 bits a byte, least significant first, with the high bit
+// set on every byte but the last
+void putVarint(std::string& out, std::uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+
+    out.push_back(static_cast<char>(value));
+}
+
+// reads varints and bytes off a buffer, and remembers if it ever ran past
+// the end instead of throwing so a damaged file is one check at the end
+class Reader
+{
+    std::string_view    _data;
+    std::size_t         _pos = 0;
+    bool                _ok = true;
+
+public:
+    explicit Reader(std::string_view data, std::size_t pos = 0)
+        : _data{ data },
+          _pos{ pos }
+    {
+    }
+
+    bool ok() const { return _ok; }
+    bool atEnd() const { return _pos == _data.size(); }
+    std::size_t position() const { return _pos; }
+
+    std::uint64_t varint()
+    {
+        std::uint64_t retval = 0;
+
+        for (unsigned shift = 0; shift < 64 && _pos < _data.size(); shift += 7)
+        {
+            const auto byte = static_cast<std::uint8_t>(_data[_pos++]);
+            retval |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0) return retval;
+        }
+
+        _ok = false;
+        return 0;
+    }
+
+    std::string_view bytes(std::uint64_t count)
+    {
+        if (count > _data.size() - _pos)
+        {
+            _ok = false;
+            return {};
+        }
+
+        const auto retval = _data.substr(_pos, count);
+        _pos += count;
+        return retval;
+    }
+};
+
+struct Record
+{
+    std::int32_t                                score = 0;
+    std::uint32_t                               ups = 0;
+    std::uint32_t                               downs = 0;
+    std::uint32_t                               comments = 0;
+    std::uint32_t                               created = 0;
+    bool                                        stickied = false;
+    std::array<std::string_view, TEXT_COUNT>    text;
+};
+
+// a record is its size as a varint followed by the numbers of a link, the
+// score zigzag encoded, and then the size and bytes of each of its texts
+bool readRecord(Reader& in, Record& out)
+{
+    Reader body{ in.bytes(in.varint()) };
+    if (!in.ok()) return false;
+
+    const auto score = static_cast<std::uint32_t>(body.varint());
+    out.score = static_cast<std::int32_t>((score >> 1) ^ (~(score & 1) + 1));
+    out.ups = static_cast<std::uint32_t>(body.varint());
+    out.downs = static_cast<std::uint32_t>(body.varint());
+    out.comments = static_cast<std::uint32_t>(body.varint());
+    out.created = static_cast<std::uint32_t>(body.varint());
+    out.stickied = body.varint() != 0;
+
+    for (auto& text : out.text)
+    {
+        text = body.bytes(body.varint());
+    }
+
+    return body.ok() && body.atEnd();
+}
+
+// the size of the record at `offset`, its own size included
+std::size_t recordSize(std::string_view records, std::uint64_t offset)
+{
+    Reader in{ records, offset };
+    in.bytes(in.varint());
+    return in.position() - offset;
+}
+
+bool isWordChar(char c)
+{
+    const auto byte = static_cast<unsigned char>(c);
+    return (byte >= 'a' && byte <= 'z')
+        || (byte >= '0' && byte <= '9')
+        || byte == '_'
+        || byte >= 0x80;                    // anything outside ASCII is taken as it is
+}
+
+void lowerInto(std::string& out, std::string_view text)
+{
+    const auto start = out.size();
+    out.append(text);
+
+    for (auto it = out.begin() + start; it != out.end(); ++it)
+    {
+        if (*it >= 'A' && *it <= 'Z') *it = static_cast<char>(*it - 'A' + 'a');
+    }
+}
+
+// calls `fn` with the offset and size of every word in lowercase `text`,
+// which is a run of letters, digits and underscores followed by any `+`
+// or `#` so that "c++" and "c#" are words, of at least two characters
+template<typename Fn>
+void splitWords(std::string_view text, Fn&& fn)
+{
+    std::size_t i = 0;
+    while (i < text.size())
+    {
+        if (!isWordChar(text[i]))
+        {
+            i++;
+            continue;
+        }
+
+        const auto start = i;
+        while (i < text.size() && isWordChar(text[i])) i++;
+        while (i < text.size() && (text[i] == '+' || text[i] == '#')) i++;
+
+        const auto size = std::min(i - start, SearchIndex::MAX_WORD_SIZE);
+        if (size >= 2) fn(start, size);
+    }
+}
+
+struct Hit
+{
+    std::uint32_t   doc;
+    float           score;
+};
+
+using Hits = std::vector<Hit>;
+
+// both sets of hits are sorted by document, and so are the results
+Hits intersect(const Hits& a, const Hits& b)
+{
+    Hits retval;
+    retval.reserve(std::min(a.size(), b.size()));
+
+    auto i = a.begin();
+    auto j = b.begin();
+    while (i != a.end() && j != b.end())
+    {
+        if (i->doc < j->doc) ++i;
+        else if (j->doc < i->doc) ++j;
+        else
+        {
+            retval.push_back({ i->doc, i->score + j->score });
+            ++i;
+            ++j;
+        }
+    }
+
+    return retval;
+}
+
+Hits subtract(const Hits& a, const Hits& b)
+{
+    Hits retval;
+    retval.reserve(a.size());
+
+    auto j = b.begin();
+    for (const auto& hit : a)
+    {
+        while (j != b.end() && j->doc < hit.doc) ++j;
+        if (j == b.end() || j->doc != hit.doc) retval.push_back(hit);
+    }
+
+    return retval;
+}
+
+// sorts hits that may repeat a document and adds up the scores of each
+void merge(Hits& hits)
+{
+    std::sort(hits.begin(), hits.end(), [](const Hit& a, const Hit& b) { return a.doc < b.doc; });
+
+    auto out = hits.begin();
+    for (auto it = hits.begin(); it != hits.end(); ++it)
+    {
+        if (out != hits.begin() && std::prev(out)->doc == it->doc)
+        {
+            std::prev(out)->score += it->score;
+        }
+        else
+        {
+            *out++ = *it;
+        }
+    }
+
+    hits.erase(out, hits.end());
+}
+
+struct Term
+{
+    std::string     word;
+    bool            prefix = false;
+};
+
+// alternatives joined by OR, each a list of words that must all be there
+// (a query word like "cmake-gui" is two index words)
+struct Clause
+{
+    std::vector<std::vector<Term>>  alternatives;
+    bool                            excluded = false;
+};
+
+std::vector<Clause> parseQuery(std::string_view query)
+{
+    std::vector<Clause> retval;
+    bool join = false;
+    bool exclude = false;
+
+    std::size_t pos = 0;
+    while (pos < query.size())
+    {
+        const auto start = query.find_first_not_of(" \t", pos);
+        if (start == std::string_view::npos) break;
+
+        pos = std::min(query.find_first_of(" \t", start), query.size());
+        auto token = query.substr(start, pos - start);
+
+        if (token == "OR")
+        {
+            if (retval.empty() || join || exclude)
+            {
+                throw std::invalid_argument("'OR' needs a word on either side");
+            }
+
+            join = true;
+            continue;
+        }
+
+        if (token == "NOT")
+        {
+            exclude = true;
+            continue;
+        }
+
+        bool excluded = std::exchange(exclude, false);
+        if (token.size() > 1 && token.front() == '-')
+        {
+            excluded = true;
+            token.remove_prefix(1);
+        }
+
+        const auto prefix = token.find_last_not_of('*') + 1 < token.size();
+        token = token.substr(0, token.find_last_not_of('*') + 1);
+
+        std::string lowered;
+        lowerInto(lowered, token);
+
+        std::vector<Term> terms;
+        splitWords(lowered, [&](std::size_t offset, std::size_t size)
+            {
+                terms.push_back({ lowered.substr(offset, size), false });
+            });
+
+        // nothing the index would have kept, like "a"
+        if (terms.empty()) continue;
+
+        terms.back().prefix = prefix;
+
+        if (std::exchange(join, false))
+        {
+            if (excluded || retval.back().excluded)
+            {
+                throw std::invalid_argument("a word left out with '-' or 'NOT' cannot be part of an 'OR'");
+            }
+
+            retval.back().alternatives.push_back(std::move(terms));
+        }
+        else
+        {
+            retval.push_back(Clause{ { std::move(terms) }, excluded });
+        }
+    }
+
+    if (join) throw std::invalid_argument("'OR' needs a word on either side");
+    if (exclude) throw std::invalid_argument("'NOT' needs a word after it");
+
+    if (std::none_of(retval.begin(), retval.end(), [](const Clause& c) { return !c.excluded; }))
+    {
+        throw std::invalid_argument(fmt::format("'{}' has no words to look for", query));
+    }
+
+    return retval;
+}
+
+} // namespace
+
+void SearchIndex::forEachWord(std::string_view text, const std::function<void(std::string_view)>& fn)
+{
+    std::string lowered;
+    lowerInto(lowered, text);
+
+    splitWords(lowered, [&](std::size_t offset, std::size_t size)
+        {
+            fn(std::string_view{ lowered }.substr(offset, size));
+        });
+}
+
+void SearchIndex::lower(std::string_view text, std::uint32_t weight)
+{
+    const auto start = _lowered.size();
+    lowerInto(_lowered, text);
+    _lowered.push_back(' ');
+
+    splitWords(std::string_view{ _lowered }.substr(start), [&](std::size_t offset, std::size_t size)
+        {
+            _scratch.push_back({ static_cast<std::uint32_t>(start + offset), static_cast<std::uint32_t>(size), weight });
+        });
+}
+
+void SearchIndex::appendRecord(const Link& link)
+{
+    const auto start = _records.size();
+
+    const auto score = static_cast<std::uint32_t>(link.score);
+    putVarint(_records, (score << 1) ^ static_cast<std::uint32_t>(link.score >> 31));
+    putVarint(_records, link.ups);
+    putVarint(_records, link.downs);
+    putVarint(_records, link.comments);
+    putVarint(_records, link.created);
+    putVarint(_records, link.stickied ? 1 : 0);
+
+    for (const auto text : { std::string_view{ link.kind }, link.name, link.title, link.url, link.permalink,
+        std::string_view{ link.author }, std::string_view{ link.subreddit }, std::string_view{ link.flair } })
+    {
+        putVarint(_records, text.size());
+        _records.append(text);
+    }
+
+    // the size goes in front of the record once it is known
+    std::string size;
+    putVarint(size, _records.size() - start);
+    _records.insert(start, size);
+}
+
+bool SearchIndex::add(const Link& link)
+{
+    if (link.name.empty()) return false;
+
+    std::lock_guard lock{ _mutex };
+
+    const auto key = SeenSet::key(link.name);
+    if (const auto it = _documents.find(key); it != _documents.end())
+    {
+        auto& offset = _offsets[it->second];
+
+        Reader in{ _records, offset };
+        Record record;
+
+        // two fullnames that are not reddit's own can share a key, the
+        // first one keeps it
+        if (!readRecord(in, record) || record.text[NAME] != link.name) return false;
+
+        _garbage += recordSize(_records, offset);
+        offset = _records.size();
+        appendRecord(link);
+        _modified = true;
+
+        if (_garbage >= MIN_COMPACT_GARBAGE && _garbage * 2 > _records.size())
+        {
+            compact();
+        }
+
+        return false;
+    }
+
+    const auto doc = static_cast<std::uint32_t>(_offsets.size());
+    _offsets.push_back(_records.size());
+    appendRecord(link);
+    _documents.emplace(key, doc);
+
+    _lowered.clear();
+    _scratch.clear();
+    lower(link.title, TITLE_WEIGHT);
+    lower(link.selftext, TEXT_WEIGHT);
+    lower(link.author, TAG_WEIGHT);
+    lower(link.subreddit, TAG_WEIGHT);
+    lower(link.flair, TAG_WEIGHT);
+
+    const auto word = [this](const Word& w) { return std::string_view{ _lowered }.substr(w.offset, w.size); };
+    std::sort(_scratch.begin(), _scratch.end(),
+        [&](const Word& a, const Word& b) { return word(a) < word(b); });
+
+    for (auto it = _scratch.begin(); it != _scratch.end();)
+    {
+        const auto text = word(*it);
+
+        std::uint32_t weight = 0;
+        for (; it != _scratch.end() && word(*it) == text; ++it)
+        {
+            weight += it->weight;
+        }
+
+        auto postings = _words.find(text);
+        if (postings == _words.end())
+        {
+            postings = _words.emplace(std::string{ text }, Postings{}).first;
+        }
+
+        putVarint(postings->second.bytes, doc - postings->second.last);
+        putVarint(postings->second.bytes, weight);
+        postings->second.last = doc;
+        postings->second.count++;
+    }
+
+    _modified = true;
+    return true;
+}
+
+void SearchIndex::add(const LinkPage& page)
+{
+    for (const auto& link : page)
+    {
+        add(link);
+    }
+}
+
+SearchIndex::Result SearchIndex::search(std::string_view query) const
+{
+    const auto clauses = parseQuery(query);
+
+    std::lock_guard lock{ _mutex };
+
+    const auto documents = static_cast<double>(_offsets.size());
+
+    // rarer words count for more, and a word that is in a link many times
+    // or in its title counts for more but not by as much
+    const auto append = [documents](const Postings& postings, Hits& out)
+        {
+            const auto idf = std::log(1.0 + documents / postings.count);
+
+            Reader in{ postings.bytes };
+            std::uint32_t doc = 0;
+
+            if (out.empty()) out.reserve(postings.count);
+            for (std::uint32_t i = 0; i < postings.count; i++)
+            {
+                doc += static_cast<std::uint32_t>(in.varint());
+                const auto weight = static_cast<double>(in.varint());
+                out.push_back({ doc, static_cast<float>(idf * (1.0 + std::log(weight))) });
+            }
+        };
+
+    const auto termHits = [&](const Term& term)
+        {
+            Hits retval;
+            if (!term.prefix)
+            {
+                if (const auto it = _words.find(term.word); it != _words.end())
+                {
+                    append(it->second, retval);
+                }
+
+                return retval;
+            }
+
+            std::size_t expansions = 0;
+            for (auto it = _words.lower_bound(term.word);
+                it != _words.end() && it->first.starts_with(term.word) && expansions < MAX_EXPANSIONS;
+                ++it, ++expansions)
+            {
+                append(it->second, retval);
+            }
+
+            if (expansions > 1) merge(retval);
+            return retval;
+        };
+
+    const auto clauseHits = [&](const Clause& clause)
+        {
+            Hits retval;
+            for (const auto& terms : clause.alternatives)
+            {
+                auto hits = termHits(terms.front());
+                for (auto it = std::next(terms.begin()); it != terms.end() && !hits.empty(); ++it)
+                {
+                    hits = intersect(hits, termHits(*it));
+                }
+
+                retval.insert(retval.end(), hits.begin(), hits.end());
+            }
+
+            if (clause.alternatives.size() > 1) merge(retval);
+            return retval;
+        };
+
+    std::vector<Hits> included;
+    std::vector<Hits> excluded;
+    for (const auto& clause : clauses)
+    {
+        (clause.excluded ? excluded : included).push_back(clauseHits(clause));
+    }
+
+    // the smallest set first keeps every intersection small
+    std::sort(included.begin(), included.end(),
+        [](const Hits& a, const Hits& b) { return a.size() < b.size(); });
+
+    auto hits = std::move(included.front());
+    for (auto it = std::next(included.begin()); it != included.end() && !hits.empty(); ++it)
+    {
+        hits = intersect(hits, *it);
+    }
+
+    for (const auto& other : excluded)
+    {
+        if (hits.empty()) break;
+        hits = subtract(hits, other);
+    }
+
+    Result retval;
+    retval.matches = hits.size();
+
+    const auto ranked = std::min(hits.size(), MAX_RESULTS);
+    std::partial_sort(hits.begin(), hits.begin() + static_cast<std::ptrdiff_t>(ranked), hits.end(),
+        [](const Hit& a, const Hit& b) { return a.score != b.score ? a.score > b.score : a.doc > b.doc; });
+
+    retval.docs.reserve(ranked);
+    std::transform(hits.begin(), hits.begin() + static_cast<std::ptrdiff_t>(ranked),
+        std::back_inserter(retval.docs), [](const Hit& hit) { return hit.doc; });
+
+    return retval;
+}
+
+LinkPage SearchIndex::links(std::span<const std::uint32_t> docs) const
+{
+    auto& pool = StringPool::instance();
+
+    LinkPage retval;
+    retval.reserve(docs.size());
+
+    std::lock_guard lock{ _mutex };
+
+    for (const auto doc : docs)
+    {
+        if (doc >= _offsets.size()) continue;
+
+        Reader in{ _records, _offsets[doc] };
+        Record record;
+        if (!readRecord(in, record)) continue;
+
+        Link link;
+        link.kind = pool.intern(record.text[KIND]);
+        link.name = retval.store(record.text[NAME]);
+        link.title = retval.store(record.text[TITLE]);
+        link.url = retval.store(record.text[URL]);
+        link.permalink = retval.store(record.text[PERMALINK]);
+        link.author = retval.store(record.text[AUTHOR]);
+        link.subreddit = pool.intern(record.text[SUBREDDIT]);
+        link.flair = pool.intern(record.text[FLAIR]);
+
+        link.score = record.score;
+        link.ups = record.ups;
+        link.downs = record.downs;
+        link.comments = record.comments;
+        link.created = record.created;
+        link.stickied = record.stickied;
+
+        retval.push_back(std::move(link));
+    }
+
+    return retval;
+}
+
+std::size_t SearchIndex::size() const
+{
+    std::lock_guard lock{ _mutex };
+    return _offsets.size();
+}
+
+SearchIndex::Stats SearchIndex::stats() const
+{
+    std::lock_guard lock{ _mutex };
+
+    Stats retval;
+    retval.documents = _offsets.size();
+    retval.words = _words.size();
+    retval.documentBytes = _records.size() - _garbage;
+
+    for (const auto& [word, postings] : _words)
+    {
+        retval.postingBytes += postings.bytes.size();
+    }
+
+    return retval;
+}
+
+bool SearchIndex::modified() const
+{
+    std::lock_guard lock{ _mutex };
+    return _modified;
+}
+
+void SearchIndex::compact()
+{
+    if (_garbage == 0) return;
+
+    std::string records;
+    records.reserve(_records.size() - _garbage);
+
+    for (auto& offset : _offsets)
+    {
+        const auto size = recordSize(_records, offset);
+        const auto start = records.size();
+        records.append(_records, offset, size);
+        offset = start;
+    }
+
+    _records = std::move(records);
+    _garbage = 0;
+}
+
+void SearchIndex::save(const std::string& filename)
+{
+    namespace bfs = boost::filesystem;
+
+    std::lock_guard lock{ _mutex };
+    compact();
+
+    const auto temp = filename + ".tmp";
+    std::ofstream out{ temp, std::ios::binary | std::ios::trunc };
+    if (!out)
+    {
+        throw std::runtime_error(fmt::format("could not write '{}'", temp));
+    }
+
+    std::string buffer{ MAGIC, sizeof(MAGIC) };
+    buffer.append(reinterpret_cast<const char*>(&VERSION), sizeof(VERSION));
+    buffer.append(sizeof(std::uint32_t), '\0');
+
+    putVarint(buffer, _offsets.size());
+    out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    out.write(_records.data(), static_cast<std::streamsize>(_records.size()));
+
+    buffer.clear();
+    putVarint(buffer, _words.size());
+
+    for (const auto& [word, postings] : _words)
+    {
+        putVarint(buffer, word.size());
+        buffer.append(word);
+        putVarint(buffer, postings.count);
+        putVarint(buffer, postings.last);
+        putVarint(buffer, postings.bytes.size());
+        buffer.append(postings.bytes);
+
+        if (buffer.size() >= 64 * 1024)
+        {
+            out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            buffer.clear();
+        }
+    }
+
+    out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    out.close();
+
+    if (!out)
+    {
+        throw std::runtime_error(fmt::format("could not write '{}'", temp));
+    }
+
+    bfs::rename(temp, filename);
+    _modified = false;
+}
+
+void SearchIndex::load(const std::string& filename)
+{
+    namespace bfs = boost::filesystem;
+
+    decltype(_words) words;
+    decltype(_records) records;
+    decltype(_offsets) offsets;
+    decltype(_documents) documents;
+
+    if (bfs::exists(filename))
+    {
+        std::ifstream in{ filename, std::ios::binary };
+        if (!in)
+        {
+            throw std::runtime_error(fmt::format("could not open '{}'", filename));
+        }
+
+        const std::string data{ std::istreambuf_iterator<char>{ in }, std::istreambuf_iterator<char>{} };
+
+        std::uint32_t version = 0;
+        if (data.size() >= HEADER_SIZE)
+        {
+            std::memcpy(&version, data.data() + sizeof(MAGIC), sizeof(version));
+        }
+
+        if (data.size() < HEADER_SIZE
+            || std::memcmp(data.data(), MAGIC, sizeof(MAGIC)) != 0
+            || version != VERSION)
+        {
+            throw std::runtime_error(fmt::format("'{}' is not a search index", filename));
+        }
+
+        const auto damaged = [&filename]()
+            {
+                return std::runtime_error(fmt::format("'{}' is damaged", filename));
+            };
+
+        Reader reader{ data, HEADER_SIZE };
+
+        const auto count = reader.varint();
+        if (!reader.ok() || count >= UINT32_MAX) throw damaged();
+
+        const auto first = reader.position();
+        for (std::uint64_t doc = 0; doc < count; doc++)
+        {
+            offsets.push_back(reader.position() - first);
+
+            Record record;
+            if (!readRecord(reader, record)) throw damaged();
+
+            documents.emplace(SeenSet::key(record.text[NAME]), static_cast<std::uint32_t>(doc));
+        }
+
+        records.assign(data, first, reader.position() - first);
+
+        const auto wordCount = reader.varint();
+        for (std::uint64_t i = 0; i < wordCount && reader.ok(); i++)
+        {
+            const auto word = reader.bytes(reader.varint());
+
+            Postings postings;
+            postings.count = static_cast<std::uint32_t>(reader.varint());
+            postings.last = static_cast<std::uint32_t>(reader.varint());
+            postings.bytes = reader.bytes(reader.varint());
+
+            // the postings have to lead to documents that exist, in order,
+            // or a search could read past the records
+            Reader check{ postings.bytes };
+            std::uint64_t doc = 0;
+            for (std::uint32_t n = 0; n < postings.count && check.ok(); n++)
+            {
+                const auto delta = check.varint();
+                if (n > 0 && delta == 0) throw damaged();
+
+                doc += delta;
+                check.varint();
+            }
+
+            if (!reader.ok() || !check.ok() || !check.atEnd()
+                || postings.count == 0 || doc != postings.last || doc >= count
+                || (!words.empty() && std::prev(words.end())->first >= word))
+            {
+                throw damaged();
+            }
+
+            words.emplace_hint(words.end(), std::string{ word }, std::move(postings));
+        }
+
+        if (!reader.ok() || !reader.atEnd()) throw damaged();
+    }
+
+    std::lock_guard lock{ _mutex };
+    _words = std::move(words);
+    _records = std::move(records);
+    _offsets = std::move(offsets);
+    _documents = std::move(documents);
+    _garbage = 0;
+    _modified = false;
+}
+
+} // namespace arcc
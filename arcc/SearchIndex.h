@@ -0,0 +1,141 @@
+// Another Reddit Console Client
+// Copyright (c) 2017-2019, Adalid Claure <aclaure@gmail.com>
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "Link.h"
+
+namespace arcc
+{
+
+// A full-text index of every link arcc has decoded, so posts that were
+// seen once can be found again without asking reddit.
+//
+// The title, self text, author, subreddit and flair of a link are split
+// into lowercase words, and each word keeps a posting list of the links it
+// appears in. Links are numbered in the order they are added, so a posting
+// list only ever grows at its end and is kept as the difference to the
+// previous number followed by how much the word weighs in that link, both
+// as varints, which takes two or three bytes a posting. Words in the title
+// weigh more than words in the self text. Along with the postings the index
+// keeps what it takes to show a link again, but not its self text.
+//
+// A query is a list of words that must all appear. A word can be followed
+// by `*` to match every word it starts, joined to the next one with `OR`
+// so that either will do, or preceded by `-` or `NOT` to leave out the
+// links that have it. Matches are ranked by how rare the words they have
+// are and how much those weigh in them, newer links first on a tie.
+//
+// A link that is added again only has what is shown of it updated, its
+// words stay the ones it was first indexed with. The index is locked
+// against other threads, and saved and loaded as a whole.
+class SearchIndex final
+{
+public:
+    // how much a word counts for depending on where it was found
+    static constexpr std::uint32_t TITLE_WEIGHT = 3;
+    static constexpr std::uint32_t TAG_WEIGHT = 2;          // author, subreddit and flair
+    static constexpr std::uint32_t TEXT_WEIGHT = 1;
+
+    // longer words are cut to this
+    static constexpr std::size_t MAX_WORD_SIZE = 32;
+
+    // a query asks for no more than this many matches, and a prefix
+    // stands for no more than this many words
+    static constexpr std::size_t MAX_RESULTS = 1000;
+    static constexpr std::size_t MAX_EXPANSIONS = 256;
+
+    struct Result
+    {
+        std::vector<std::uint32_t>  docs;           // best match first, at most MAX_RESULTS
+        std::size_t                 matches = 0;    // all of them
+    };
+
+    struct Stats
+    {
+        std::size_t     documents = 0;
+        std::size_t     words = 0;
+        std::size_t     postingBytes = 0;
+        std::size_t     documentBytes = 0;
+    };
+
+private:
+    struct Postings
+    {
+        std::string     bytes;          // (document delta, weight) varint pairs
+        std::uint32_t   last = 0;       // the last document in it
+        std::uint32_t   count = 0;      // documents in it
+    };
+
+    // a word of the document being added, pointing into `_lowered`
+    struct Word
+    {
+        std::uint32_t   offset;
+        std::uint32_t   size;
+        std::uint32_t   weight;
+    };
+
+    mutable std::mutex                                  _mutex;
+
+    std::map<std::string, Postings, std::less<>>        _words;
+    std::string                                         _records;       // what every document shows, back to back
+    std::vector<std::uint64_t>                          _offsets;       // document to its record in `_records`
+    std::unordered_map<std::uint64_t, std::uint32_t>    _documents;     // SeenSet::key(fullname) to document
+    std::size_t                                         _garbage = 0;   // bytes of records that were replaced
+    bool                                                _modified = false;
+
+    std::string                                         _lowered;       // scratch space for add()
+    std::vector<Word>                                   _scratch;
+
+public:
+    SearchIndex() = default;
+
+    SearchIndex(const SearchIndex&) = delete;
+    SearchIndex& operator=(const SearchIndex&) = delete;
+
+    // adds a link, or updates it if it is already there, and returns
+    // whether it was new
+    bool add(const Link& link);
+    void add(const LinkPage& page);
+
+    // throws std::invalid_argument when the query has nothing to look for
+    Result search(std::string_view query) const;
+
+    // copies documents into a page, in the order given
+    LinkPage links(std::span<const std::uint32_t> docs) const;
+
+    std::size_t size() const;
+    Stats stats() const;
+
+    // whether anything was added since the index was loaded or saved
+    bool modified() const;
+
+    // replaces what is in the index with what is in `filename`, nothing if
+    // the file does not exist, and throws std::runtime_error if it cannot
+    // be read
+    void load(const std::string& filename);
+
+    // writes the index to `filename` through a temporary file, so a
+    // failure leaves the old one alone
+    void save(const std::string& filename);
+
+    // calls `fn` with every word of `text` the way the index sees them
+    static void forEachWord(std::string_view text, const std::function<void(std::string_view)>& fn);
+
+private:
+    void lower(std::string_view text, std::uint32_t weight);
+    void appendRecord(const Link& link);
+    void compact();
+};
+
+} // namespace arcc
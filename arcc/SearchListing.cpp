@@ -0,0 +1,51 @@
+// Another Reddit Console Client
+// Copyright (c) 2017-2019, Adalid Claure <aclaure@gmail.com>
+
+#include <algorithm>
+
+#include "SearchListing.h"
+
+namespace arcc
+{
+
+SearchListing::SearchListing(std::shared_ptr<const SearchIndex> index, const std::string& query, std::size_t limit)
+    : _index{ std::move(index) },
+      _query{ query },
+      _limit{ std::max<std::size_t>(limit, 1) },
+      _result{ _index->search(_query) }
+{
+}
+
+LinkPage SearchListing::getFirstPage()
+{
+    _current = 0;
+    return page(_current);
+}
+
+LinkPage SearchListing::getNextPage()
+{
+    if ((_current + 1) * _limit >= _result.docs.size()) return LinkPage{};
+    return page(++_current);
+}
+
+LinkPage SearchListing::getPreviousPage()
+{
+    if (_current == 0) return LinkPage{};
+    return page(--_current);
+}
+
+LinkPage SearchListing::refresh()
+{
+    _result = _index->search(_query);
+    return getFirstPage();
+}
+
+LinkPage SearchListing::page(std::size_t index) const
+{
+    const auto first = std::min(index * _limit, _result.docs.size());
+    const auto count = std::min(_limit, _result.docs.size() - first);
+
+    return _index->links(std::span{ _result.docs }.subspan(first, count));
+}
+
+} // namespace arcc
@@ -0,0 +1,49 @@
+// Another Reddit Console Client
+// Copyright (c) 2017-2019, Adalid Claure <aclaure@gmail.com>
+
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "Listing.h"
+#include "SearchIndex.h"
+
+namespace arcc
+{
+
+// Pages through the results of a search, best match first, `limit` links
+// at a time. The query runs once up front and again on a refresh, which
+// picks up whatever was indexed since.
+class SearchListing final : public ListingBase
+{
+    std::shared_ptr<const SearchIndex>  _index;
+    const std::string                   _query;
+    const std::size_t                   _limit;
+
+    SearchIndex::Result                 _result;
+    std::size_t                         _current = 0;   // index of the page shown
+
+public:
+    // throws std::invalid_argument if the query has nothing to look for
+    SearchListing(std::shared_ptr<const SearchIndex> index, const std::string& query, std::size_t limit);
+
+    LinkPage getFirstPage() override;
+    LinkPage getNextPage() override;
+    LinkPage getPreviousPage() override;
+
+    // runs the query again and starts over from the first page
+    LinkPage refresh() override;
+
+    const std::string& query() const { return _query; }
+    std::size_t limit() const { return _limit; }
+
+    // how many links matched, and how many of them can be paged through
+    std::size_t matches() const { return _result.matches; }
+    std::size_t ranked() const { return _result.docs.size(); }
+
+private:
+    LinkPage page(std::size_t index) const;
+};
+
+} // namespace arcc
@@ -0,0 +1,202 @@
+// Another Reddit Console Client
+// Copyright (c) 2017-2019, Adalid Claure <aclaure@gmail.com>
+
+#include <algorithm>
+#include <cmath>
+
+#include "SeenSet.h"
+
+namespace arcc
+{
+
+namespace
+{
+
+constexpr std::size_t INITIAL_SLOTS = 1024;     // a power of two
+
+// ids have gone past 6 digits and will need a long time to reach 11,
+// which is as many as fit next to the kind
+constexpr std::size_t MAX_ID_LENGTH = 11;
+constexpr unsigned KIND_SHIFT = 57;
+
+// a 64 bit mix, keys that only differ in their low digits would otherwise
+// land in neighbouring slots
+std::uint64_t mix(std::uint64_t x)
+{
+    x += 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+int base36(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'z') return c - 'a' + 10;
+    return -1;
+}
+
+} // namespace
+
+SeenSet::SeenSet(Mode mode, std::size_t capacity, double falsePositives)
+    : _mode{ mode }
+{
+    if (_mode == Mode::BLOOM)
+    {
+        // the usual optimum, bits = -n ln(p) / ln(2)^2 and ln(2) bits/n hashes
+        const double n = static_cast<double>(std::max<std::size_t>(capacity, 1));
+        const double p = std::clamp(falsePositives, 1e-9, 0.5);
+        const double bits = std::ceil(-n * std::log(p) / (std::log(2.0) * std::log(2.0)));
+
+        _slots.resize(static_cast<std::size_t>(bits) / 64 + 1);
+        _hashes = std::clamp<std::size_t>(static_cast<std::size_t>(std::round(bits / n * std::log(2.0))), 1, 16);
+    }
+    else
+    {
+        _slots.resize(INITIAL_SLOTS);
+    }
+}
+
+std::uint64_t SeenSet::key(std::string_view fullname)
+{
+    // "t3_9x2a1" is kind 3 and id 9x2a1
+    if (fullname.size() > 3 && fullname.size() <= 3 + MAX_ID_LENGTH
+        && fullname[0] == 't' && fullname[1] >= '1' && fullname[1] <= '9' && fullname[2] == '_')
+    {
+        std::uint64_t id = 0;
+        bool valid = true;
+
+        for (const auto c : fullname.substr(3))
+        {
+            const auto digit = base36(c);
+            if (digit < 0)
+            {
+                valid = false;
+                break;
+            }
+
+            id = id * 36 + static_cast<std::uint64_t>(digit);
+        }
+
+        if (valid)
+        {
+            return (static_cast<std::uint64_t>(fullname[1] - '0') << KIND_SHIFT) | id;
+        }
+    }
+
+    // FNV-1a, with the top bit set so it never collides with a fullname
+    std::uint64_t hash = 0xcbf29ce484222325ull;
+    for (const auto c : fullname)
+    {
+        hash = (hash ^ static_cast<unsigned char>(c)) * 0x100000001b3ull;
+    }
+
+    return hash | (1ull << 63);
+}
+
+bool SeenSet::insert(std::string_view fullname)
+{
+    const auto k = key(fullname);
+
+    if (_mode == Mode::EXACT)
+    {
+        // keep the table at most 70% full
+        if ((_size + 1) * 10 > _slots.size() * 7) grow();
+
+        if (!insertExact(k)) return false;
+
+        _size++;
+        return true;
+    }
+
+    const auto bits = _slots.size() * 64;
+    const auto h1 = mix(k);
+    const auto h2 = mix(h1) | 1;
+
+    bool added = false;
+    for (std::size_t i = 0; i < _hashes; i++)
+    {
+        const auto bit = (h1 + i * h2) % bits;
+        auto& word = _slots[bit / 64];
+        const auto mask = 1ull << (bit % 64);
+
+        added = added || (word & mask) == 0;
+        word |= mask;
+    }
+
+    if (added) _size++;
+    return added;
+}
+
+bool SeenSet::contains(std::string_view fullname) const
+{
+    const auto k = key(fullname);
+
+    if (_mode == Mode::EXACT)
+    {
+        const auto mask = _slots.size() - 1;
+        for (auto slot = mix(k) & mask; _slots[slot] != 0; slot = (slot + 1) & mask)
+        {
+            if (_slots[slot] == k) return true;
+        }
+
+        return false;
+    }
+
+    const auto bits = _slots.size() * 64;
+    const auto h1 = mix(k);
+    const auto h2 = mix(h1) | 1;
+
+    for (std::size_t i = 0; i < _hashes; i++)
+    {
+        const auto bit = (h1 + i * h2) % bits;
+        if ((_slots[bit / 64] & (1ull << (bit % 64))) == 0) return false;
+    }
+
+    return true;
+}
+
+void SeenSet::clear()
+{
+    if (_mode == Mode::EXACT)
+    {
+        // give back what a long crawl grew
+        _slots.assign(INITIAL_SLOTS, 0);
+        _slots.shrink_to_fit();
+    }
+    else
+    {
+        std::fill(_slots.begin(), _slots.end(), 0);
+    }
+
+    _size = 0;
+}
+
+bool SeenSet::insertExact(std::uint64_t key)
+{
+    // linear probing, keys are never 0 since fullnames carry their kind
+    const auto mask = _slots.size() - 1;
+    auto slot = mix(key) & mask;
+
+    while (_slots[slot] != 0)
+    {
+        if (_slots[slot] == key) return false;
+        slot = (slot + 1) & mask;
+    }
+
+    _slots[slot] = key;
+    return true;
+}
+
+void SeenSet::grow()
+{
+    std::vector<std::uint64_t> old(_slots.size() * 2, 0);
+    old.swap(_slots);
+
+    for (const auto key : old)
+    {
+        if (key != 0) insertExact(key);
+    }
+}
+
+} // namespace arcc
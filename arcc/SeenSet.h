@@ -0,0 +1,63 @@
+// Another Reddit Console Client
+// Copyright (c) 2017-2019, Adalid Claure <aclaure@gmail.com>
+
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace arcc
+{
+
+// Remembers which things (by fullname, e.g. "t3_9x2a1") have been seen.
+// A fullname is packed into a single 64 bit key, its kind and its base36
+// id, so the exact mode costs around 16 bytes a name in an open addressing
+// table. The Bloom mode has a fixed size, about 1.2 MB for a million names
+// at the default 1% false positives, in exchange for now and then taking a
+// name it has never seen for one it has. Not thread safe.
+class SeenSet final
+{
+public:
+    enum class Mode
+    {
+        EXACT,
+        BLOOM
+    };
+
+    static constexpr std::size_t DEFAULT_BLOOM_CAPACITY = 1000000;
+    static constexpr double DEFAULT_FALSE_POSITIVES = 0.01;
+
+private:
+    Mode                            _mode;
+    std::vector<std::uint64_t>      _slots;         // keys (0 is empty), or the Bloom filter's bits
+    std::size_t                     _size = 0;      // names inserted
+    std::size_t                     _hashes = 0;    // bits set per name in the Bloom filter
+
+public:
+    // `capacity` and `falsePositives` size the Bloom filter and are
+    // ignored by the exact mode, which grows as needed
+    explicit SeenSet(Mode mode = Mode::EXACT,
+        std::size_t capacity = DEFAULT_BLOOM_CAPACITY,
+        double falsePositives = DEFAULT_FALSE_POSITIVES);
+
+    Mode mode() const { return _mode; }
+
+    // true the first time a name is inserted
+    bool insert(std::string_view fullname);
+    bool contains(std::string_view fullname) const;
+
+    void clear();
+
+    std::size_t size() const { return _size; }
+    std::size_t memoryUsage() const { return sizeof(SeenSet) + _slots.capacity() * sizeof(std::uint64_t); }
+
+    // the kind and the base36 id for fullnames, a hash for anything else
+    static std::uint64_t key(std::string_view fullname);
+
+private:
+    bool insertExact(std::uint64_t key);
+    void grow();
+};
+
+} // namespace arcc
@@ -7,39 +7,54 @@
 #include <regex>
 #include <vector>
 
-#include <boost/tokenizer.hpp>
 #include <boost/algorithm/string.hpp>
 
 namespace arcc
 {
 
-// https://stackoverflow.com/questions/18378798/use-boost-program-options-to-parse-an-arbitrary-string
 /// @brief Tokenize a string.  The tokens will be separated by each non-quoted
-///        space or equal character.  Empty tokens are removed.
+///        space.  A quote is closed by the same character that opened it, so
+///        `--where='flair ~ "Discussion"'` keeps its inner quotes.  Empty 
+///        tokens are removed.
 ///
 /// @param input The string to tokenize.
 ///
 /// @return Vector of tokens.
 std::vector<std::string> tokenizeArgs(const std::string& input)
 {
-  typedef boost::escaped_list_separator<char> separator_type;
-  separator_type separator("",    // The escape characters.
-                           " ",    // The separator characters.
-                           "\"\'"); // The quote characters.
-
-  // Tokenize the intput.
-  boost::tokenizer<separator_type> tokens(input, separator);
-
-  // Copy non-empty tokens from the tokenizer into the result.
-  std::vector<std::string> result;
-  std::copy_if(tokens.begin(), tokens.end(), std::back_inserter(result), 
-          [](const std::string& s) { return !s.empty(); });
-  return result;
+    std::vector<std::string> result;
+    std::string token;
+    char quote = 0;
+
+    for (const auto c : input)
+    {
+        if (quote != 0)
+        {
+            if (c == quote) quote = 0;
+            else token.push_back(c);
+        }
+        else if (c == '"' || c == '\'')
+        {
+            quote = c;
+        }
+        else if (c == ' ')
+        {
+            if (!token.empty()) result.push_back(std::move(token));
+            token.clear();
+        }
+        else
+        {
+            token.push_back(c);
+        }
+    }
+
+    if (!token.empty()) result.push_back(std::move(token));
+    return result;
 }
 
 bool validParamName(const std::string_view& name)
 {
-    static const char* validChars = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvqxyz0123456789";
+    static const char* validChars = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789";
     return name.find_first_not_of(validChars) == std::string_view::npos;
 }
 
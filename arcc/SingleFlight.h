@@ -0,0 +1,96 @@
+// Another Reddit Console Client
+// Copyright (c) 2017-2019, Adalid Claure <aclaure@gmail.com>
+
+#pragma once
+
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace arcc
+{
+
+// Collapses concurrent calls for the same key into one. The first caller
+// runs the work, anyone who asks for the same key while it is running waits
+// for it and gets a copy of the same immutable result (or its exception).
+// When nobody else was waiting the result is moved out rather than copied.
+template<typename Key, typename Value>
+class SingleFlight final
+{
+    using SharedValue = std::shared_ptr<const Value>;
+
+    struct Flight
+    {
+        std::shared_future<SharedValue>     future;
+        std::size_t                         waiters = 0;
+    };
+
+    std::mutex                  _mutex;
+    std::map<Key, Flight>       _flights;                       // guarded by _mutex
+
+public:
+    template<typename Fn>
+    Value run(const Key& key, Fn&& fn)
+    {
+        std::promise<SharedValue> promise;
+
+        {
+            std::unique_lock<std::mutex> lock{ _mutex };
+            if (auto it = _flights.find(key); it != _flights.end())
+            {
+                it->second.waiters++;
+                auto future = it->second.future;
+
+                lock.unlock();
+                return *future.get();
+            }
+
+            _flights.emplace(key, Flight{ promise.get_future().share() });
+        }
+
+        try
+        {
+            Value value = fn();
+            if (finish(key) == 0)
+            {
+                return value;
+            }
+
+            auto shared = std::make_shared<const Value>(std::move(value));
+            promise.set_value(shared);
+            return *shared;
+        }
+        catch (...)
+        {
+            if (finish(key) > 0)
+            {
+                promise.set_exception(std::current_exception());
+            }
+
+            throw;
+        }
+    }
+
+    std::size_t inflight()
+    {
+        std::lock_guard<std::mutex> lock{ _mutex };
+        return _flights.size();
+    }
+
+private:
+    // nobody can join once the flight is gone, so this returns
+    // the final number of callers waiting on the result
+    std::size_t finish(const Key& key)
+    {
+        std::lock_guard<std::mutex> lock{ _mutex };
+
+        auto it = _flights.find(key);
+        const auto waiters = it->second.waiters;
+        _flights.erase(it);
+
+        return waiters;
+    }
+};
+
+} // namespace arcc
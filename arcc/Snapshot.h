@@ -0,0 +1,61 @@
+// Another Reddit Console Client
+// Copyright (c) 2017-2019, Adalid Claure <aclaure@gmail.com>
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+
+namespace arcc
+{
+
+// A shared_ptr that many threads load and replace at once, the part of
+// std::atomic<std::shared_ptr> that we need. libc++ has no such atomic,
+// so this takes a lock, but only for as long as it takes to copy the
+// pointer. Whatever is pointed to is shared as an immutable snapshot, a
+// change means a new object that is swapped in whole.
+template<typename T>
+class Snapshot final
+{
+    using Pointer = std::shared_ptr<T>;
+
+    mutable std::mutex      _mutex;
+    Pointer                 _value;             // guarded by _mutex
+
+public:
+    Snapshot() = default;
+    Snapshot(Pointer value) : _value{ std::move(value) } {}
+
+    Snapshot(const Snapshot&) = delete;
+    Snapshot& operator=(const Snapshot&) = delete;
+
+    Pointer load() const
+    {
+        std::lock_guard<std::mutex> lock{ _mutex };
+        return _value;
+    }
+
+    void store(Pointer value)
+    {
+        // the old value goes with `value`, after the lock is released
+        std::lock_guard<std::mutex> lock{ _mutex };
+        _value.swap(value);
+    }
+
+    // replaces the value with `desired` if it is still `expected`, otherwise
+    // sets `expected` to what it is now
+    bool compare_exchange(Pointer& expected, Pointer desired)
+    {
+        std::lock_guard<std::mutex> lock{ _mutex };
+        if (_value == expected)
+        {
+            _value.swap(desired);
+            return true;
+        }
+
+        expected = _value;
+        return false;
+    }
+};
+
+} // namespace arcc
@@ -0,0 +1,42 @@
+// Another Reddit Console Client
+// Copyright (c) 2017-2019, Adalid Claure <aclaure@gmail.com>
+
+#include "StringPool.h"
+
+namespace arcc
+{
+
+StringPool& StringPool::instance()
+{
+    static StringPool pool;
+    return pool;
+}
+
+InternedString StringPool::intern(std::string_view value)
+{
+    if (value.empty()) return {};
+
+    std::lock_guard<std::mutex> lock{ _mutex };
+    if (const auto it = _strings.find(value); it != _strings.end())
+    {
+        return *it;
+    }
+
+    // the set is node based, so the string never moves once it is in
+    _bytes += value.size();
+    return *(_strings.emplace(value).first);
+}
+
+std::size_t StringPool::size() const
+{
+    std::lock_guard<std::mutex> lock{ _mutex };
+    return _strings.size();
+}
+
+std::size_t StringPool::bytes() const
+{
+    std::lock_guard<std::mutex> lock{ _mutex };
+    return _bytes;
+}
+
+} // namespace arcc
@@ -0,0 +1,43 @@
+// Another Reddit Console Client
+// Copyright (c) 2017-2019, Adalid Claure <aclaure@gmail.com>
+
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+
+namespace arcc
+{
+
+// a string that lives in the StringPool, equal strings share one copy
+using InternedString = std::string_view;
+
+// Keeps one copy of strings that repeat across many posts, like subreddit
+// names and flair. Interned strings are never released, so this is only
+// meant for values with a small number of distinct entries. Anything that
+// grows with the number of posts seen, such as authors, belongs in the
+// arena of the page it came from.
+class StringPool final
+{
+    struct Hash
+    {
+        using is_transparent = void;
+        std::size_t operator()(std::string_view value) const { return std::hash<std::string_view>{}(value); }
+    };
+
+    mutable std::mutex                                              _mutex;
+    std::unordered_set<std::string, Hash, std::equal_to<>>          _strings;   // guarded by _mutex
+    std::size_t                                                     _bytes = 0; // guarded by _mutex
+
+public:
+    static StringPool& instance();
+
+    InternedString intern(std::string_view value);
+
+    std::size_t size() const;
+    std::size_t bytes() const;
+};
+
+} // namespace arcc
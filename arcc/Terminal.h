@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <chrono>
 #include <iostream>
 
 #include <boost/signals2.hpp>
@@ -24,6 +25,10 @@ public:
     std::string getLine();
     void setLine(const std::string& val) { _commandline = val; }
 
+    // waits up to `timeout` for a key and swallows it, returns whether
+    // there was one
+    bool waitForKey(std::chrono::milliseconds timeout);
+
     void backspace();
     void backspaces(std::size_t spaces)
     {
@@ -3,6 +3,10 @@
 
 #include "Terminal.h"
 
+#include <algorithm>
+#include <climits>
+
+#include <poll.h>
 #include <unistd.h>
 #include <termios.h>
 
@@ -28,6 +32,20 @@ Terminal::~Terminal()
     tcsetattr(STDIN_FILENO, TCSANOW, &t);
 }
 
+bool Terminal::waitForKey(std::chrono::milliseconds timeout)
+{
+    // a key that is already buffered never wakes up poll()
+    if (std::cin.rdbuf()->in_avail() <= 0)
+    {
+        pollfd fd{ STDIN_FILENO, POLLIN, 0 };
+        const auto wait = std::clamp<std::chrono::milliseconds::rep>(timeout.count(), 0, INT_MAX);
+        if (::poll(&fd, 1, static_cast<int>(wait)) <= 0) return false;
+    }
+
+    std::cin.get();
+    return true;
+}
+
 std::pair<bool, char> getChar()
 {
     using namespace std;
@@ -2,6 +2,7 @@
 // Copyright (c) 2017-2018, Adalid Claure <aclaure@gmail.com>
 
 #include <iostream>
+#include <thread>
 #include <conio.h>
 
 #include "Terminal.h"
@@ -12,6 +13,20 @@ namespace arcc
 Terminal::Terminal() = default;
 Terminal::~Terminal() = default;
 
+bool Terminal::waitForKey(std::chrono::milliseconds timeout)
+{
+    // the console has nothing to wait on, so check on it now and then
+    const auto until = std::chrono::steady_clock::now() + timeout;
+    while (!_kbhit())
+    {
+        if (std::chrono::steady_clock::now() >= until) return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds{ 50 });
+    }
+
+    _getch();
+    return true;
+}
+
 std::string Terminal::getLine()
 {
     _commandline.clear();
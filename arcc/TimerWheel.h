@@ -0,0 +1,130 @@
+// Another Reddit Console Client
+// Copyright (c) 2017-2019, Adalid Claure <aclaure@gmail.com>
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace arcc
+{
+
+// A hashed timer wheel. Time is cut into ticks and a timer goes into the
+// slot of the tick it is due on, modulo the number of slots, so scheduling
+// costs the same however many timers there are and every tick only looks
+// at the timers of one slot. A timer more than one turn of the wheel out
+// sits in its slot until the wheel has come around enough times. Timers
+// fire on the first tick at or after the time they were scheduled for.
+// Not thread safe.
+template<typename T>
+class TimerWheel final
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+private:
+    struct Timer
+    {
+        std::uint64_t   tick;
+        T               value;
+    };
+
+    const Clock::duration               _tick;
+    const Clock::time_point             _start;
+    std::vector<std::vector<Timer>>     _slots;
+    std::uint64_t                       _current = 0;       // the next tick to expire
+    std::size_t                         _size = 0;
+
+public:
+    TimerWheel(Clock::duration tick, std::size_t slots, Clock::time_point start = Clock::now())
+        : _tick{ std::max(tick, Clock::duration{ 1 }) },
+          _start{ start },
+          _slots(std::max<std::size_t>(slots, 1))
+    {
+    }
+
+    std::size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+
+    Clock::duration tick() const { return _tick; }
+
+    void schedule(Clock::time_point when, T value)
+    {
+        // a timer in the past goes off on the next expire()
+        std::uint64_t tick = _current;
+        if (when > _start)
+        {
+            const auto ticks = (when - _start + _tick - Clock::duration{ 1 }) / _tick;
+            tick = std::max(tick, static_cast<std::uint64_t>(ticks));
+        }
+
+        _slots[tick % _slots.size()].push_back({ tick, std::move(value) });
+        _size++;
+    }
+
+    // moves every timer due by `now` into `due`, in the order they are due
+    void expire(Clock::time_point now, std::vector<T>& due)
+    {
+        if (now < _start) return;
+
+        const std::uint64_t last = (now - _start) / _tick;
+        if (last < _current) return;
+
+        // after a long enough sleep every slot is due, each is gone
+        // through once either way
+        const auto turn = _slots.size();
+        std::vector<Timer> fired;
+
+        for (std::uint64_t tick = _current; tick <= last && tick < _current + turn && _size > 0; tick++)
+        {
+            auto& slot = _slots[tick % turn];
+            for (std::size_t i = 0; i < slot.size();)
+            {
+                if (slot[i].tick <= last)
+                {
+                    fired.push_back(std::move(slot[i]));
+                    if (i + 1 < slot.size()) slot[i] = std::move(slot.back());
+                    slot.pop_back();
+                    _size--;
+                }
+                else
+                {
+                    i++;
+                }
+            }
+        }
+
+        std::stable_sort(fired.begin(), fired.end(),
+            [](const Timer& a, const Timer& b) { return a.tick < b.tick; });
+
+        for (auto& timer : fired)
+        {
+            due.push_back(std::move(timer.value));
+        }
+
+        _current = last + 1;
+    }
+
+    // when the earliest timer is due, Clock::time_point::max() if there
+    // are none
+    Clock::time_point next() const
+    {
+        if (_size == 0) return Clock::time_point::max();
+
+        auto earliest = std::numeric_limits<std::uint64_t>::max();
+        for (const auto& slot : _slots)
+        {
+            for (const auto& timer : slot)
+            {
+                earliest = std::min(earliest, timer.tick);
+            }
+        }
+
+        return _start + _tick * static_cast<Clock::rep>(std::max(earliest, _current));
+    }
+};
+
+} // namespace arcc
@@ -0,0 +1,32 @@
+// Another Reddit Console Client
+// Copyright (c) 2017-2019, Adalid Claure <aclaure@gmail.com>
+
+#include "BufferPool.h"
+#include "Transport.h"
+
+namespace arcc
+{
+
+Transport::Reply::~Reply()
+{
+    BufferPool::instance().release(std::move(data));
+}
+
+auto Transport::doRequest(const std::string& url, const std::string& payload, Transport::Method method)
+    -> Transport::Reply
+{
+    return doRequestAsync(url, payload, method).get();
+}
+
+auto Transport::doRequestAsync(const std::string& url, const std::string& payload, Transport::Method method)
+    -> std::future<Transport::Reply>
+{
+    return send(Request{ url, payload, method, nullptr, nullptr });
+}
+
+void Transport::doRequestAsync(const std::string& url, Callback callback, const std::string& payload, Transport::Method method)
+{
+    send(Request{ url, payload, method, std::move(callback), nullptr });
+}
+
+} // namespace arcc
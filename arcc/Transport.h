@@ -0,0 +1,118 @@
+// Another Reddit Console Client
+// Copyright (c) 2017-2019, Adalid Claure <aclaure@gmail.com>
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <functional>
+#include <future>
+#include <memory>
+
+namespace arcc
+{
+
+class WebClientError : public std::runtime_error
+{
+
+public:
+    using std::runtime_error::runtime_error;
+};
+
+// shared by a request and whoever may want to call it off, setting it
+// makes the transport abandon the request as soon as it notices
+using CancelFlag = std::shared_ptr<std::atomic_bool>;
+
+class Transport;
+using TransportPtr = std::shared_ptr<Transport>;
+
+// Anything that can carry an HTTP request. The WebClient talks to the real
+// network, the cassette transports record and replay conversations.
+class Transport
+{
+
+public:
+    // where the time of a request went, each phase is measured from the
+    // end of the previous one except `firstByte` and `total` which are
+    // measured from the start of the request
+    struct Timings
+    {
+        std::chrono::microseconds   nameLookup{ 0 };
+        std::chrono::microseconds   connect{ 0 };
+        std::chrono::microseconds   tlsHandshake{ 0 };          // zero for plain http and reused connections
+        std::chrono::microseconds   firstByte{ 0 };
+        std::chrono::microseconds   total{ 0 };
+        std::uint64_t               bytesReceived = 0;
+    };
+
+    // response headers of the final response, names are lower case
+    using Headers = std::map<std::string, std::string>;
+
+    struct Reply
+    {
+        std::string data;                                       // owned, comes from the BufferPool
+        std::string finalUrl;
+        long        status = -1;
+        Headers     headers;
+        Timings     timings;
+
+        Reply() = default;
+        Reply(const Reply&) = default;
+        Reply(Reply&&) = default;
+        Reply& operator=(const Reply&) = default;
+        Reply& operator=(Reply&&) = default;
+
+        // hands `data` back to the BufferPool
+        ~Reply();
+    };
+
+    friend std::ostream& operator<<(std::ostream& os, const Transport::Reply& reply)
+    {
+        os << "{ " << reply.status << ", " << reply.finalUrl << ", " << reply.data << " }";
+        return os;
+    }
+
+    enum class Method
+    {
+        GET = 1,
+        POST = 2
+    };
+
+    // invoked on the transport's own thread, `error` is set when the
+    // request failed in which case the reply is empty
+    using Callback = std::function<void(const Transport::Reply&, std::exception_ptr error)>;
+
+    struct Request
+    {
+        std::string         url;
+        std::string         payload;
+        Method              method = Method::GET;
+        Callback            callback;
+        CancelFlag          cancel;
+    };
+
+    virtual ~Transport() = default;
+
+    // the one thing every transport has to do, the rest is sugar
+    virtual std::future<Transport::Reply> send(Request request) = 0;
+
+    // a new transport of the same kind that does not share this one's settings
+    virtual TransportPtr makeSibling() const = 0;
+
+    virtual void setBasicAuth(const std::string& username, const std::string& password) = 0;
+    virtual void setUserAgent(const std::string& useragent) = 0;
+    virtual void setHeader(const std::string& header) = 0;
+    virtual void setTrace(bool) {}
+
+    // blocking convenience wrapper around doRequestAsync()
+    Transport::Reply doRequest(const std::string& url, const std::string& payload = std::string(), Method method = Method::GET);
+
+    std::future<Transport::Reply> doRequestAsync(const std::string& url, const std::string& payload = std::string(), Method method = Method::GET);
+    void doRequestAsync(const std::string& url, Callback callback, const std::string& payload = std::string(), Method method = Method::GET);
+};
+
+} // namespace arcc
@@ -0,0 +1,190 @@
+// Another Reddit Console Client
+// Copyright (c) 2017-2019, Adalid Claure <aclaure@gmail.com>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+#include <boost/algorithm/string/join.hpp>
+#include <boost/algorithm/string/predicate.hpp>
+
+#include "RedditSession.h"
+#include "SearchIndex.h"
+#include "Watcher.h"
+
+namespace arcc
+{
+
+Watcher::Watcher(RedditSessionPtr session, const std::vector<std::string>& subreddits,
+    std::chrono::seconds interval, Clock::time_point start)
+    : _sessionPtr{ session },
+      _wheel{ TICK, SLOTS, start }
+{
+    std::vector<std::string> names;
+    for (auto name : subreddits)
+    {
+        if (boost::starts_with(name, "/r/")) name.erase(0, 3);
+        if (!name.empty()) names.push_back(std::move(name));
+    }
+
+    for (std::size_t first = 0; first < names.size(); first += MAX_GROUP_SIZE)
+    {
+        const auto last = std::min(first + MAX_GROUP_SIZE, names.size());
+        const std::vector<std::string> group{ names.begin() + first, names.begin() + last };
+
+        Group polled;
+        polled.endpoint = "/r/" + boost::algorithm::join(group, "+") + "/new";
+        _groups.push_back(std::move(polled));
+    }
+
+    _interval = std::max(interval, minimumInterval(_groups.size()));
+
+    // the groups take turns rather than all going at once
+    const auto turn = std::chrono::duration_cast<Clock::duration>(_interval)
+        / static_cast<Clock::rep>(std::max<std::size_t>(_groups.size(), 1));
+
+    for (std::size_t i = 0; i < _groups.size(); i++)
+    {
+        _wheel.schedule(start + turn * static_cast<Clock::rep>(i), i);
+    }
+}
+
+std::chrono::seconds Watcher::minimumInterval(std::size_t groups)
+{
+    return std::chrono::seconds{ static_cast<std::chrono::seconds::rep>(
+        std::ceil(static_cast<double>(groups) / MAX_REQUEST_RATE)) };
+}
+
+std::vector<std::string> Watcher::endpoints() const
+{
+    std::vector<std::string> retval;
+    for (const auto& group : _groups)
+    {
+        retval.push_back(group.endpoint);
+    }
+
+    return retval;
+}
+
+LinkPage Watcher::poll(Clock::time_point now)
+{
+    std::vector<std::size_t> due;
+    _wheel.expire(now, due);
+    if (due.empty()) return LinkPage{};
+
+    LinkPage found;
+    if (auto session = _sessionPtr.lock(); session)
+    {
+        for (const auto index : due)
+        {
+            pollGroup(*session, _groups[index], found);
+        }
+    }
+
+    for (const auto index : due)
+    {
+        _wheel.schedule(now + _interval, index);
+    }
+
+    // every group's posts came newest first, show them as they happened
+    std::vector<std::size_t> order(found.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+        [&found](std::size_t a, std::size_t b) { return found[a].created < found[b].created; });
+
+    LinkPage retval;
+    retval.reserve(found.size());
+
+    for (const auto index : order)
+    {
+        retval.append(found[index]);
+    }
+
+    _stats.items += retval.size();
+    return retval;
+}
+
+std::optional<ListingData> Watcher::fetch(RedditSession& session, const Group& group, const Params& params)
+{
+    _stats.requests++;
+
+    try
+    {
+        auto data = Listing::fetchPage(session, group.endpoint, params, RawJson::NONE, RequestPriority::BACKGROUND);
+        if (data && _index)
+        {
+            _index->add(data->children);
+        }
+
+        if (!data) _stats.errors++;
+        return data;
+    }
+    catch (const std::exception&)
+    {
+        // the next turn will simply ask again
+        _stats.errors++;
+        return {};
+    }
+}
+
+void Watcher::pollGroup(RedditSession& session, Group& group, LinkPage& found)
+{
+    _stats.polls++;
+
+    if (group.newest.empty())
+    {
+        // nothing that is already there is new
+        resync(session, group, nullptr);
+        return;
+    }
+
+    for (std::size_t pages = 0; pages < MAX_CATCH_UP; pages++)
+    {
+        const auto data = fetch(session, group,
+            Params{ { "before", group.newest }, { "limit", std::to_string(PAGE_SIZE) } });
+
+        if (!data) return;
+
+        if (data->children.empty())
+        {
+            if (pages == 0 && ++group.quiet >= RESYNC_POLLS)
+            {
+                resync(session, group, &found);
+            }
+
+            return;
+        }
+
+        // a full page is the oldest of what is new, there may be more
+        group.quiet = 0;
+        group.newest = data->children[0].name;
+        take(data->children, &found);
+
+        if (data->children.size() < PAGE_SIZE) return;
+    }
+}
+
+void Watcher::resync(RedditSession& session, Group& group, LinkPage* found)
+{
+    const auto data = fetch(session, group, Params{ { "limit", std::to_string(SEED_SIZE) } });
+    if (!data || data->children.empty()) return;
+
+    if (!group.newest.empty()) _stats.resyncs++;
+
+    group.quiet = 0;
+    group.newest = data->children[0].name;
+    take(data->children, found);
+}
+
+void Watcher::take(const LinkPage& page, LinkPage* found)
+{
+    for (const auto& link : page)
+    {
+        if (_seen.insert(link.name) && found)
+        {
+            found->append(link);
+        }
+    }
+}
+
+} // namespace arcc
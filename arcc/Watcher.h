@@ -0,0 +1,126 @@
+// Another Reddit Console Client
+// Copyright (c) 2017-2019, Adalid Claure <aclaure@gmail.com>
+
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "Listing.h"
+#include "SeenSet.h"
+#include "TimerWheel.h"
+
+namespace arcc
+{
+
+// Keeps an eye on the newest posts of a set of subreddits and hands out
+// the ones that were not there before.
+//
+// Subreddits are polled in groups, each group a single multireddit request
+// (e.g. `/r/a+b+c/new`), so that watching a couple of hundred subreddits
+// costs a few requests each time around. The first poll of a group only
+// notes its newest post, after that it asks for what came `before=` that
+// post, which is usually nothing and never more than the new posts, and a
+// poll that comes back full is followed up right away. If the newest post
+// is removed reddit has nothing before it anymore, so a group that has been
+// quiet for a while asks for its latest few posts instead and starts over
+// from the newest of them. Posts already handed out are remembered and
+// never handed out twice.
+//
+// The groups take turns over the interval on a timer wheel, rather than
+// all going at once, and every request is sent at background priority. An
+// interval too short to stay well within reddit's rate limit is stretched.
+class Watcher final
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // subreddits in one request, which keeps its URL a sensible length
+    static constexpr std::size_t MAX_GROUP_SIZE = 50;
+
+    // items asked for after the newest one, and to find the newest one
+    static constexpr std::size_t PAGE_SIZE = 100;
+    static constexpr std::size_t SEED_SIZE = 10;
+
+    // polls in a row that found nothing before a group starts over, and
+    // pages a single poll may follow up with
+    static constexpr std::size_t RESYNC_POLLS = 10;
+    static constexpr std::size_t MAX_CATCH_UP = 5;
+
+    // requests a second watching may take, half of reddit's limit
+    static constexpr double MAX_REQUEST_RATE = 50.0 / 60.0;
+
+    static constexpr std::chrono::milliseconds TICK{ 250 };
+    static constexpr std::size_t SLOTS = 512;
+
+    struct Stats
+    {
+        std::size_t     polls = 0;
+        std::size_t     requests = 0;
+        std::size_t     errors = 0;
+        std::size_t     resyncs = 0;
+        std::size_t     items = 0;          // handed out
+    };
+
+private:
+    struct Group
+    {
+        std::string     endpoint;
+        std::string     newest;             // fullname of the newest post seen, empty until the first poll
+        std::size_t     quiet = 0;          // polls in a row that found nothing
+    };
+
+    RedditSessionPtr                _sessionPtr;
+    std::vector<Group>              _groups;
+    std::chrono::seconds            _interval;
+
+    TimerWheel<std::size_t>         _wheel;                 // indices of groups waiting for their turn
+    SeenSet                         _seen{ SeenSet::Mode::EXACT };
+    Stats                           _stats;
+
+    // where every page fetched is indexed, if anywhere
+    std::shared_ptr<SearchIndex>    _index;
+
+public:
+    // `subreddits` are names with or without their "/r/" prefix, the first
+    // group is due at `start` and the others spread out over the interval
+    Watcher(RedditSessionPtr session, const std::vector<std::string>& subreddits,
+        std::chrono::seconds interval, Clock::time_point start = Clock::now());
+
+    // polls every group that is due by `now`, and returns the posts that
+    // were not seen before, oldest first
+    LinkPage poll(Clock::time_point now = Clock::now());
+
+    // when the next group is due
+    Clock::time_point nextPoll() const { return _wheel.next(); }
+
+    std::chrono::seconds interval() const { return _interval; }
+    std::size_t groups() const { return _groups.size(); }
+    std::vector<std::string> endpoints() const;
+
+    const Stats& stats() const { return _stats; }
+
+    // adds every page fetched from reddit to `index`
+    void setIndex(std::shared_ptr<SearchIndex> index) { _index = std::move(index); }
+
+    // the shortest interval `groups` requests fit in within MAX_REQUEST_RATE
+    static std::chrono::seconds minimumInterval(std::size_t groups);
+
+private:
+    std::optional<ListingData> fetch(RedditSession& session, const Group& group, const Params& params);
+
+    // adds the posts of a group that were not seen before to `found`
+    void pollGroup(RedditSession& session, Group& group, LinkPage& found);
+
+    // starts a group over from its latest posts, those not seen before go
+    // to `found` unless it is null
+    void resync(RedditSession& session, Group& group, LinkPage* found);
+
+    // remembers the posts of a page, and adds the new ones to `found`
+    void take(const LinkPage& page, LinkPage* found);
+};
+
+} // namespace arcc
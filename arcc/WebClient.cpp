@@ -5,25 +5,82 @@
 #include <string>
 #include <sstream>
 #include <cstring>
+#include <cstdint>
 #include <iostream>
 
+#include <boost/algorithm/string.hpp>
+
+#include "AsyncWebClient.h"
+#include "BufferPool.h"
+#include "HandlePool.h"
 #include "WebClient.h"
 
 const unsigned int  DEFAULT_MAX_REDIRECTS = 5;
 
+// never trust a Content-Length beyond this when reserving memory
+const std::uint64_t DEFAULT_MAX_RESERVE_SIZE = 64 * 1024 * 1024;
+
 
 namespace arcc
 {
 
-static size_t CURLwriter(char *data, size_t size, size_t nmemb, std::string *writerData)
+static size_t CURLwriter(char *data, size_t size, size_t nmemb, Transfer *transfer)
 {
-    if (writerData == nullptr)
+    if (transfer == nullptr)
     {
         return 0;
     }
 
-    writerData->append(data, size*nmemb);
-    return size * nmemb;
+    const std::size_t total = size * nmemb;
+
+    if (transfer->buffer.empty())
+    {
+        // size the buffer once up front when the server tells us
+        // how much is coming, rather than growing it chunk by chunk
+        curl_off_t length = -1;
+        curl_easy_getinfo(transfer->handle, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &length);
+
+        if (length > 0 && static_cast<std::uint64_t>(length) <= DEFAULT_MAX_RESERVE_SIZE)
+        {
+            transfer->buffer.reserve(static_cast<std::size_t>(length));
+        }
+    }
+
+    BufferPool::instance().append(transfer->buffer, data, total);
+    return total;
+}
+
+static size_t CURLheader(char *data, size_t size, size_t nitems, Transfer *transfer)
+{
+    const std::size_t total = size * nitems;
+    if (transfer == nullptr)
+    {
+        return total;
+    }
+
+    std::string_view line{ data, total };
+    if (boost::algorithm::istarts_with(line, "HTTP/"))
+    {
+        // a new status line, so anything before it belonged to a redirect
+        transfer->responseHeaders.clear();
+    }
+    else if (const auto colon = line.find(':'); colon != std::string_view::npos)
+    {
+        std::string name{ line.substr(0, colon) };
+        std::string value{ line.substr(colon + 1) };
+        boost::algorithm::to_lower(name);
+        boost::algorithm::trim(value);
+
+        transfer->responseHeaders.insert_or_assign(std::move(name), std::move(value));
+    }
+
+    return total;
+}
+
+static int CURLprogress(Transfer *transfer, curl_off_t, curl_off_t, curl_off_t, curl_off_t)
+{
+    // libcurl calls this at least once a second, a non-zero return aborts
+    return transfer != nullptr && transfer->cancel && *transfer->cancel ? 1 : 0;
 }
 
 int trace([[maybe_unused]] CURL *handle,
@@ -36,138 +93,114 @@ int trace([[maybe_unused]] CURL *handle,
    return 1;
 }
 
-CURLcode curlGlobalInit()
-{
-    return curl_global_init(CURL_GLOBAL_ALL);
-}
-
 WebClient::WebClient()
+    : _config{ std::make_shared<const Config>() }
 {
-    static CURLcode __global = curlGlobalInit();
-    (void)__global; // silence unused warnings
-
-    _curl = curl_easy_init();
-
     curl_version_info_data *vinfo = curl_version_info(CURLVERSION_NOW);
     if (!(vinfo->features & CURL_VERSION_SSL))
     {
         throw WebClientError("CURL SSL support is required but not enabled");
     }
+}
 
-    // set up our writer
-    curl_easy_setopt(_curl, CURLOPT_WRITEFUNCTION, CURLwriter);
-    curl_easy_setopt(_curl, CURLOPT_WRITEDATA, &_buffer);
-    curl_easy_setopt(_curl, CURLOPT_ERRORBUFFER, _errbuf);
-    
+WebClient::~WebClient() = default;
+
+void WebClient::prepareHandle(CURL* handle, const Config& config)
+{
     // set the redirects and the max number
-    curl_easy_setopt(_curl, CURLOPT_FOLLOWLOCATION, 1L);
-    curl_easy_setopt(_curl, CURLOPT_MAXREDIRS, DEFAULT_MAX_REDIRECTS);
+    curl_easy_setopt(handle, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt(handle, CURLOPT_MAXREDIRS, DEFAULT_MAX_REDIRECTS);
 
     // start cookie engine
-    curl_easy_setopt(_curl, CURLOPT_COOKIEFILE, "");
+    curl_easy_setopt(handle, CURLOPT_COOKIEFILE, "");
 
     // TODO: peer verification is disabled for now, figure out how to enable
     // it and optionally turn it on
-    curl_easy_setopt(_curl, CURLOPT_SSL_VERIFYPEER, 0L);
+    curl_easy_setopt(handle, CURLOPT_SSL_VERIFYPEER, 0L);
 
     // tell libcurl to redirect a post with a post after a 301, 302 or 303
-    curl_easy_setopt(_curl, CURLOPT_POSTREDIR, CURL_REDIR_POST_ALL);
+    curl_easy_setopt(handle, CURLOPT_POSTREDIR, CURL_REDIR_POST_ALL);
 
     // disable all curl's signal handling
-    curl_easy_setopt(_curl, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(handle, CURLOPT_NOSIGNAL, 1L);
 
 #ifdef _WINDOWS
     // need to disable this otherwise SSL does not work on Windows 7    
-    curl_easy_setopt(_curl, CURLOPT_SSL_ENABLE_ALPN, 0);
+    curl_easy_setopt(handle, CURLOPT_SSL_ENABLE_ALPN, 0);
 #endif    
-}
-
-WebClient::~WebClient()
-{
-    curl_easy_cleanup(_curl);
-}
-
-auto WebClient::doRequest(const std::string& url, const std::string& payload, WebClient::Method method)
-    -> WebClient::Reply
-{
-    WebClient::Reply retval;
 
-    // set the URL we're getting
-    curl_easy_setopt(_curl, CURLOPT_URL, url.c_str());
+    if (!config.useragent.empty())
+    {
+        curl_easy_setopt(handle, CURLOPT_USERAGENT, config.useragent.c_str());
+    }
 
-    if (method == Method::POST)
+    if (!config.authstr.empty())
     {
-        if (payload.size() > 0)
-        {
-            curl_easy_setopt(_curl, CURLOPT_POSTFIELDSIZE, payload.size());
-            curl_easy_setopt(_curl, CURLOPT_COPYPOSTFIELDS, payload.c_str());
-        }
-        else
-        {
-            curl_easy_setopt(_curl, CURLOPT_POSTFIELDSIZE, 0L);
-            curl_easy_setopt(_curl, CURLOPT_POSTFIELDS, nullptr);
-        }
+        curl_easy_setopt(handle, CURLOPT_HTTPAUTH, CURLAUTH_BASIC);
+        curl_easy_setopt(handle, CURLOPT_USERPWD, config.authstr.c_str());
     }
-    else
+
+    if (config.headers)
     {
-        curl_easy_setopt(_curl, CURLOPT_HTTPGET, 1L);
-        curl_easy_setopt(_curl, CURLOPT_POST, 0L);
+        curl_easy_setopt(handle, CURLOPT_HTTPHEADER, config.headers.get());
     }
 
-    _buffer.clear();
-    CURLcode result = curl_easy_perform(_curl);
+    curl_easy_setopt(handle, CURLOPT_VERBOSE, config.trace ? 1L : 0L);
+    // curl_easy_setopt(handle, CURLOPT_DEBUGFUNCTION, trace);
+}
 
-    long status = 0;
-    curl_easy_getinfo(_curl, CURLINFO_RESPONSE_CODE, &status);
-    
-    retval.status = status;
+auto WebClient::send(Request request)
+    -> std::future<Transport::Reply>
+{
+    // one consistent view of the settings for the whole request
+    const auto config = _config.load();
 
-    if (result == CURLE_OK)
-    {
-        char *finalUrl;
-        curl_easy_getinfo(_curl, CURLINFO_EFFECTIVE_URL, &finalUrl);
+    auto transfer = std::make_unique<Transfer>();
+    transfer->handle = HandlePool::instance().acquire();
+    transfer->headers = config->headers;
+    transfer->callback = std::move(request.callback);
+    transfer->cancel = std::move(request.cancel);
+    transfer->buffer = BufferPool::instance().acquire();
 
-        retval.status = status;
+    CURL* handle = transfer->handle;
+    prepareHandle(handle, *config);
 
-        if (status == 200)
-        {
-            retval.finalUrl = finalUrl;
-            retval.data = _buffer; // copy! :(
-        }
-    }
-    else
+    // set up our writer
+    curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, CURLwriter);
+    curl_easy_setopt(handle, CURLOPT_WRITEDATA, transfer.get());
+    curl_easy_setopt(handle, CURLOPT_ERRORBUFFER, transfer->errbuf);
+    curl_easy_setopt(handle, CURLOPT_HEADERFUNCTION, CURLheader);
+    curl_easy_setopt(handle, CURLOPT_HEADERDATA, transfer.get());
+
+    if (transfer->cancel)
     {
-        std::stringstream ss;
+        curl_easy_setopt(handle, CURLOPT_XFERINFOFUNCTION, CURLprogress);
+        curl_easy_setopt(handle, CURLOPT_XFERINFODATA, transfer.get());
+        curl_easy_setopt(handle, CURLOPT_NOPROGRESS, 0L);
+    }
 
-        if (std::strlen(_errbuf) > 0)
+    // set the URL we're getting
+    curl_easy_setopt(handle, CURLOPT_URL, request.url.c_str());
+
+    if (request.method == Method::POST)
+    {
+        if (request.payload.size() > 0)
         {
-            ss << "Request error: " << _errbuf;
+            curl_easy_setopt(handle, CURLOPT_POSTFIELDSIZE, request.payload.size());
+            curl_easy_setopt(handle, CURLOPT_COPYPOSTFIELDS, request.payload.c_str());
         }
         else
         {
-            ss << "Request error: " << curl_easy_strerror(result);
+            curl_easy_setopt(handle, CURLOPT_POSTFIELDSIZE, 0L);
+            curl_easy_setopt(handle, CURLOPT_POSTFIELDS, nullptr);
         }
-
-        throw WebClientError(ss.str());
-    }
-
-   return retval;
-}
-
-void WebClient::setTrace(bool trace)
-{
-    if (trace)
-    {
-        curl_easy_setopt(_curl, CURLOPT_VERBOSE, 1);
-        // curl_easy_setopt(_curl, CURLOPT_DEBUGFUNCTION, trace);
     }
     else
     {
-        curl_easy_setopt(_curl, CURLOPT_VERBOSE, 0);
-        // curl_easy_setopt(_curl, CURLOPT_DEBUGFUNCTION, nullptr);
+        curl_easy_setopt(handle, CURLOPT_HTTPGET, 1L);
     }
-}
-
 
+    return AsyncWebClient::instance().submit(std::move(transfer));
+}
 
 } // namespace arcc
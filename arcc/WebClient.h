@@ -3,81 +3,84 @@
 
 #pragma once
 
-#include <iostream>
-#include <stdexcept>
+#include <memory>
+#include <string>
 
 #include <curl/curl.h>
 
+#include "Snapshot.h"
+#include "Transport.h"
+
 namespace arcc
 {
 
-class WebClientError : public std::runtime_error
+// Safe to share between threads, every request takes its own handle from
+// the HandlePool and a snapshot of the settings below.
+class WebClient : public Transport
 {
+    struct Config
+    {
+        std::string                     authstr;                // username:password for http basic auth
+        std::string                     useragent;
+        std::shared_ptr<curl_slist>     headers;                // shared with any in-flight transfers
+        bool                            trace = false;
+    };
 
-public:
-    using std::runtime_error::runtime_error;
-};
+    using ConfigPtr = std::shared_ptr<const Config>;
 
-class WebClient
-{
-    CURL*               _curl;                                  // the curl object
-    std::string         _buffer;                                // buffer for response text
-    char                _errbuf[CURL_ERROR_SIZE];               // detailed error buffer
-
-    std::string         _authstr;                               // username:password for http basic auth
-    
-    // our own copy of the useragent since I believe Curl internally only stores the buffer
-    std::string         _useragent;                             
+    Snapshot<const Config>              _config;                // swapped whole, never modified in place
 
 public:
-    struct Reply
-    {
-        std::string data;
-        std::string finalUrl;
-        long        status = -1;
-    };
+    WebClient();
+    virtual ~WebClient();
 
+    // hands the request to the AsyncWebClient
+    std::future<Transport::Reply> send(Request request) override;
 
-    friend std::ostream& operator<<(std::ostream& os, const WebClient::Reply& reply)
+    TransportPtr makeSibling() const override
     {
-        os << "{ " << reply.status << ", " << reply.finalUrl << ", " << reply.data << " }";
-        return os;
+        return std::make_shared<WebClient>();
     }
 
-    enum class Method
+    void setBasicAuth(const std::string& username, const std::string& password) override
     {
-        GET = 1,
-        POST = 2
-    };
-
-    WebClient();
-    virtual ~WebClient();
-
-    WebClient::Reply doRequest(const std::string& url, const std::string& payload = std::string(), Method method = Method::GET);
+        update([&](Config& config) { config.authstr = username + ":" + password; });
+    }
 
-    void setBasicAuth(const std::string& username, const std::string& password)
+    void setUserAgent(const std::string& useragent) override
     {
-        _authstr = username + ":" + password;
-        curl_easy_setopt(_curl, CURLOPT_HTTPAUTH, CURLAUTH_BASIC);
-        curl_easy_setopt(_curl, CURLOPT_USERPWD, _authstr.c_str());
+        update([&](Config& config) { config.useragent = useragent; });
     }
 
-    void setUserAgent(const std::string& useragent)
+    void setHeader(const std::string& header) override
     {
-        _useragent = useragent;
-        curl_easy_setopt(_curl, CURLOPT_USERAGENT, _useragent.c_str());
+        // TODO: this only allows one custom header at a time
+        std::shared_ptr<curl_slist> headers{ curl_slist_append(nullptr, header.c_str()), curl_slist_free_all };
+        update([&](Config& config) { config.headers = headers; });
     }
 
-    void setHeader(const std::string& header)
+    void setTrace(bool trace) override
     {
-        // TODO: this only allows one custom header at a time
-        curl_slist* headers = nullptr;
-        headers = curl_slist_append(headers, header.c_str());
+        update([&](Config& config) { config.trace = trace; });
+    }
 
-        curl_easy_setopt(_curl, CURLOPT_HTTPHEADER, headers);
+private:
+    template<typename Fn>
+    void update(Fn&& change)
+    {
+        auto current = _config.load();
+        ConfigPtr next;
+
+        do
+        {
+            auto copy = std::make_shared<Config>(*current);
+            change(*copy);
+            next = std::move(copy);
+        }
+        while (!_config.compare_exchange(current, next));
     }
 
-    void setTrace(bool trace);
+    static void prepareHandle(CURL* handle, const Config& config);
 };
 
 } // namespace arcc
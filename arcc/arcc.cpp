@@ -9,6 +9,7 @@
 #include <boost/filesystem.hpp>
 
 #include "core.h"
+#include "Cassette.h"
 #include "SimpleArgs.h"
 #include "ConsoleApp.h"
 
@@ -23,8 +24,14 @@ arcc::Settings registerAllSettings()
     settings.registerEnum("global.mode", "text", { "text", "curses" });
 
     settings.registerBool("command.go.autolist", true);
+    settings.registerUInt("command.list.cache.size", 4096);
+    settings.registerEnum("command.list.dedup", "exact", { "exact", "bloom", "off" });
     settings.registerUInt("command.list.limit", 5);
+    settings.registerUInt("command.list.prefetch", 1);
+    settings.registerBool("command.list.store", true);
     settings.registerEnum("command.list.type", "hot", { "new", "hot", "rising", "controversial", "top" });
+    settings.registerBool("command.search.index", true);
+    settings.registerUInt("command.watch.interval", 60);
     settings.registerEnum("command.view.type", "url", { "url", "comments" });
     settings.registerEnum("command.view.form", "normal", { "normal", "mobile", "compact", "json" });
 
@@ -38,6 +45,7 @@ arcc::Settings registerAllSettings()
     settings.registerString("reddit.clientsecret", "");
     settings.registerString("reddit.useragent", "");
     settings.registerString("reddit.randomstring", "");
+    settings.registerUInt("reddit.refresh.margin", 300);
 
     return settings;
 }
@@ -93,6 +101,10 @@ int main(int argc, char* argv[])
         ("help,?", "print help message")
         ("version,v", "print version string")
         ("reset", po::bool_switch()->default_value(false), "reset session data") 
+        ("record", po::value<std::string>(), "record all reddit traffic to a cassette file")
+        ("replay", po::value<std::string>(), "answer reddit requests from a cassette file instead of the network")
+        ("api-url", po::value<std::string>(), "base url of the reddit API (default https://oauth.reddit.com)")
+        ("auth-url", po::value<std::string>(), "base url used to refresh access tokens (default https://www.reddit.com)")
     ;
 
     po::variables_map vm;
@@ -134,8 +146,29 @@ int main(int argc, char* argv[])
     auto settings = initSettings();
     auto session = initSession();
 
+    if (vm.count("api-url") > 0)
+    {
+        session->setApiUrl(vm["api-url"].as<std::string>());
+    }
+
+    if (vm.count("auth-url") > 0)
+    {
+        session->setAuthUrl(vm["auth-url"].as<std::string>());
+    }
+
     try
     {
+        if (vm.count("replay") > 0)
+        {
+            session->setTransport(std::make_shared<ReplayTransport>(vm["replay"].as<std::string>()));
+        }
+        else if (vm.count("record") > 0)
+        {
+            session->setTransport(std::make_shared<RecordingTransport>(
+                session->transport(), vm["record"].as<std::string>()));
+        }
+
+
         auto consoleApp = std::make_unique<ConsoleApp>(settings, session);
         consoleApp->run();
     }
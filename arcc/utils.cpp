@@ -224,6 +224,26 @@ bool isNumeric(const std::string_view& s)
             }) == s.end();
 }
 
+std::optional<std::chrono::seconds> parseDuration(const std::string_view s)
+{
+    if (s.empty()) return {};
+
+    auto digits = s;
+    std::chrono::seconds::rep scale = 1;
+    switch (s.back())
+    {
+        case 's': digits.remove_suffix(1); break;
+        case 'm': digits.remove_suffix(1); scale = 60; break;
+        case 'h': digits.remove_suffix(1); scale = 60 * 60; break;
+        default: break;
+    }
+
+    // anything longer than this is not something anyone means
+    if (!isNumeric(digits) || digits.size() > 9) return {};
+
+    return std::chrono::seconds{ std::stoll(std::string{ digits }) * scale };
+}
+
 
 static const std::vector<std::string> trueStrings = { "true", "on", "1" };
 static const std::vector<std::string> falseStrings = { "false", "off", "0" };
@@ -283,5 +303,17 @@ std::string getDefaultConfigFile()
         utils::getUserFolder(), PATH_SEPERATOR, ".arcc_config");
 }
 
+std::string getDefaultPostStoreFile()
+{
+    return fmt::format("{}{}{}",
+        utils::getUserFolder(), PATH_SEPERATOR, ".arcc_posts");
+}
+
+std::string getDefaultSearchIndexFile()
+{
+    return fmt::format("{}{}{}",
+        utils::getUserFolder(), PATH_SEPERATOR, ".arcc_search");
+}
+
 
 } // namespace
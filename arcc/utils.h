@@ -3,6 +3,8 @@
 
 #pragma once
 
+#include <chrono>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -37,8 +39,13 @@ bool isNumeric(const std::string_view& s);
 bool isBoolean(const std::string_view s);
 bool convertToBool(const std::string_view s);
 
+// "90", "90s", "5m" or "1h", nothing if `s` is none of those
+std::optional<std::chrono::seconds> parseDuration(const std::string_view s);
+
 std::string getDefaultHistoryFile();
 std::string getDefaultSessionFile();
 std::string getDefaultConfigFile();
+std::string getDefaultPostStoreFile();
+std::string getDefaultSearchIndexFile();
 
 } // namespace
@@ -0,0 +1,619 @@
+// Another Reddit Console Client
+// Copyright (c) 2017-2019, Adalid Claure <aclaure@gmail.com>
+
+// Compares decoding listing pages through nlohmann's DOM with the
+// projection decoder that Listing uses, and times the JsonIndex it runs on
+// with each kernel the CPU supports. A second table compares looking fields
+// up in the items as nlohmann::json and as FlatJson, which is what a Link
+// keeps when asked for the raw JSON. A third times a `--where` filter over
+// the decoded links, another how long it takes to read a page back from
+// the post store, and the last indexes made up posts for `search` and times
+// a few queries over them. Pages come from cassettes recorded
+// with `arcc --record`, from files holding a single listing response, or
+// are generated to look like a 100 item /r/all/hot page.
+//
+//     listingbench --iterations 200 all-hot.cassette
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <random>
+#include <sstream>
+
+#include <malloc.h>
+
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/program_options.hpp>
+
+#include <fmt/core.h>
+#include <nlohmann/json.hpp>
+
+#include "../arcc/FlatJson.h"
+#include "../arcc/JsonIndex.h"
+#include "../arcc/Link.h"
+#include "../arcc/LinkFilter.h"
+#include "../arcc/ListingDecoder.h"
+#include "../arcc/PostStore.h"
+#include "../arcc/SearchIndex.h"
+
+namespace po = boost::program_options;
+
+namespace
+{
+
+std::atomic<std::uint64_t> allocations = 0;
+std::atomic<std::uint64_t> allocatedBytes = 0;
+std::atomic<std::int64_t> liveBytes = 0;        // what malloc actually holds, slack included
+
+} // namespace
+
+// every allocation in the process goes through here so the benchmark can
+// tell how many each decoder makes
+void* operator new(std::size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+
+    if (void* retval = std::malloc(size == 0 ? 1 : size); retval != nullptr)
+    {
+        liveBytes.fetch_add(static_cast<std::int64_t>(malloc_usable_size(retval)), std::memory_order_relaxed);
+        return retval;
+    }
+
+    throw std::bad_alloc{};
+}
+
+void* operator new[](std::size_t size)
+{
+    return ::operator new(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    if (ptr != nullptr)
+    {
+        liveBytes.fetch_sub(static_cast<std::int64_t>(malloc_usable_size(ptr)), std::memory_order_relaxed);
+    }
+
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    ::operator delete(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    ::operator delete(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+    ::operator delete(ptr);
+}
+
+namespace
+{
+
+constexpr auto GENERATED_PAGES = 4u;
+constexpr auto GENERATED_ITEMS = 100u;
+
+// a child with roughly the size and shape of what reddit sends, most of
+// which arcc never looks at
+nlohmann::json makeChild(std::size_t index, std::mt19937& random)
+{
+    const auto id = fmt::format("{:x}", 0x9a0000 + index);
+
+    nlohmann::json resolutions = nlohmann::json::array();
+    for (auto width : { 108, 216, 320, 640, 960, 1080 })
+    {
+        resolutions.push_back({
+            { "url", fmt::format("https://preview.redd.it/{}.jpg?width={}&amp;crop=smart&amp;auto=webp&amp;s={:x}", id, width, random()) },
+            { "width", width },
+            { "height", width * 3 / 4 } });
+    }
+
+    nlohmann::json awardings = nlohmann::json::array();
+    for (auto i = 0u; i < random() % 4; i++)
+    {
+        awardings.push_back({
+            { "id", fmt::format("award_{:x}", random()) },
+            { "name", "Helpful" },
+            { "description", "Thank you stranger. Shows the award." },
+            { "coin_price", 150 },
+            { "count", 1 + random() % 5 },
+            { "icon_url", "https://www.redditstatic.com/gold/awards/icon/SnooHelpful_512.png" },
+            { "resized_icons", resolutions },
+            { "is_enabled", true } });
+    }
+
+    nlohmann::json data =
+    {
+        { "name", "t3_" + id },
+        { "id", id },
+        { "subreddit", fmt::format("sub{}", random() % 40) },
+        { "subreddit_name_prefixed", fmt::format("r/sub{}", random() % 40) },
+        { "title", fmt::format("Post number {} with a title of a perfectly ordinary length for reddit", index) },
+        { "author", fmt::format("user{}", random() % 5000) },
+        { "score", random() % 50000 },
+        { "ups", random() % 50000 },
+        { "downs", 0 },
+        { "num_comments", random() % 2000 },
+        { "created_utc", 1546300800.0 + static_cast<double>(random() % 86400) },
+        { "stickied", index == 0 },
+        { "link_flair_text", index % 4 == 0 ? nlohmann::json("Discussion") : nlohmann::json{} },
+        { "permalink", fmt::format("/r/sub/comments/{}/post_number_{}/", id, index) },
+        { "url", fmt::format("https://i.redd.it/{}.jpg", id) },
+        { "selftext", std::string(random() % 800, 'x') },
+        { "selftext_html", "&lt;!-- SC_OFF --&gt;&lt;div class=\"md\"&gt;&lt;p&gt;" + std::string(random() % 800, 'y') + "&lt;/p&gt;&lt;/div&gt;" },
+        { "preview", { { "images", { { { "source", resolutions.back() }, { "resolutions", resolutions }, { "variants", nlohmann::json::object() }, { "id", id } } } }, { "enabled", true } } },
+        { "all_awardings", awardings },
+        { "media", nullptr },
+        { "media_embed", nlohmann::json::object() },
+        { "secure_media", nullptr },
+        { "link_flair_richtext", nlohmann::json::array() },
+        { "author_flair_richtext", nlohmann::json::array() },
+        { "thumbnail", fmt::format("https://b.thumbs.redditmedia.com/{}.jpg", id) },
+    };
+
+    // the long tail of flags and counters every child carries
+    for (auto i = 0u; data.size() < 100; i++)
+    {
+        const auto key = fmt::format("attribute_{}", i);
+        switch (i % 4)
+        {
+            case 0: data[key] = false; break;
+            case 1: data[key] = nullptr; break;
+            case 2: data[key] = random() % 1000; break;
+            default: data[key] = "some_value"; break;
+        }
+    }
+
+    return { { "kind", "t3" }, { "data", std::move(data) } };
+}
+
+std::vector<std::string> generatePages()
+{
+    std::mt19937 random{ 42 };
+    std::vector<std::string> retval;
+
+    for (auto page = 0u; page < GENERATED_PAGES; page++)
+    {
+        nlohmann::json children = nlohmann::json::array();
+        for (auto i = 0u; i < GENERATED_ITEMS; i++)
+        {
+            children.push_back(makeChild(page * GENERATED_ITEMS + i, random));
+        }
+
+        nlohmann::json listing =
+        {
+            { "kind", "Listing" },
+            { "data", { { "after", fmt::format("t3_{:x}", 0x9a0000 + (page + 1) * GENERATED_ITEMS - 1) },
+                        { "before", nullptr }, { "dist", GENERATED_ITEMS }, { "children", std::move(children) } } }
+        };
+
+        retval.push_back(listing.dump());
+    }
+
+    return retval;
+}
+
+// every successful GET in a cassette, or the whole file otherwise
+void loadPages(const std::string& filename, std::vector<std::string>& pages)
+{
+    std::ifstream in{ filename };
+    if (!in)
+    {
+        throw std::runtime_error(fmt::format("could not open '{}'", filename));
+    }
+
+    if (!boost::algorithm::ends_with(filename, ".cassette"))
+    {
+        std::stringstream ss;
+        ss << in.rdbuf();
+        pages.push_back(ss.str());
+        return;
+    }
+
+    std::string line;
+    while (std::getline(in, line))
+    {
+        const auto entry = nlohmann::json::parse(line, nullptr, false);
+        if (entry.is_discarded() || entry.value("status", 0) != 200) continue;
+
+        if (auto body = entry.value("data", ""); body.find("\"children\"") != std::string::npos)
+        {
+            pages.push_back(std::move(body));
+        }
+    }
+}
+
+struct Result
+{
+    double          seconds = 0;
+    std::uint64_t   allocations = 0;
+    std::uint64_t   bytes = 0;
+    std::size_t     links = 0;
+};
+
+Result run(const std::vector<std::string>& pages, std::size_t iterations,
+    const std::function<std::size_t(const std::string&)>& decode)
+{
+    Result retval;
+
+    const auto startAllocations = allocations.load();
+    const auto startBytes = allocatedBytes.load();
+    const auto start = std::chrono::steady_clock::now();
+
+    for (auto i = 0u; i < iterations; i++)
+    {
+        for (const auto& page : pages)
+        {
+            retval.links += decode(page);
+        }
+    }
+
+    retval.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    retval.allocations = allocations.load() - startAllocations;
+    retval.bytes = allocatedBytes.load() - startBytes;
+
+    return retval;
+}
+
+// what a Link reads from an item, and one key no item has
+const std::vector<std::string> LOOKUP_KEYS
+{
+    "author", "created_utc", "downs", "link_flair_text", "name", "num_comments", "permalink",
+    "score", "stickied", "subreddit", "subreddit_name_prefixed", "title", "ups", "url", "not_a_field"
+};
+
+template<typename Json>
+void compareLookups(const std::string& name, const std::vector<std::string>& pages, std::size_t iterations)
+{
+    const auto startBytes = liveBytes.load();
+
+    std::vector<Json> items;
+    for (const auto& page : pages)
+    {
+        auto json = Json::parse(page);
+        for (auto& child : json["data"]["children"])
+        {
+            items.push_back(std::move(child["data"]));
+        }
+    }
+
+    const auto bytes = liveBytes.load() - startBytes;
+
+    std::size_t found = 0;
+    const auto start = std::chrono::steady_clock::now();
+
+    for (auto i = 0u; i < iterations; i++)
+    {
+        for (const auto& item : items)
+        {
+            for (const auto& key : LOOKUP_KEYS)
+            {
+                found += item.find(key) != item.end() ? 1 : 0;
+            }
+        }
+    }
+
+    const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    const auto lookups = static_cast<double>(iterations * items.size() * LOOKUP_KEYS.size());
+
+    std::cout << fmt::format("{:<22}{:>12.1f}{:>16.1f}{:>18}\n",
+        name,
+        seconds * 1e9 / lookups,
+        bytes / 1024.0 / pages.size(),
+        found);
+}
+
+// matches every decoded link against a filter
+void filterLinks(const std::string& expression, const std::vector<std::string>& pages, std::size_t iterations)
+{
+    std::vector<arcc::LinkPage> decoded;
+    for (const auto& page : pages)
+    {
+        decoded.push_back(arcc::decodeListing(page)->children);
+    }
+
+    const arcc::LinkFilter filter{ expression };
+    std::vector<std::uint32_t> indices;
+    for (const auto& page : decoded)
+    {
+        // grows `indices` to the largest page, so the timed passes reuse it
+        filter.select(page, indices);
+    }
+
+    std::size_t items = 0;
+    std::size_t matched = 0;
+    const auto startAllocations = allocations.load();
+    const auto start = std::chrono::steady_clock::now();
+
+    for (auto i = 0u; i < iterations; i++)
+    {
+        for (const auto& page : decoded)
+        {
+            matched += filter.select(page, indices);
+            items += page.size();
+        }
+    }
+
+    const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << fmt::format("{:<72}{:>12.1f}{:>16.1f}{:>18}\n",
+        expression,
+        seconds * 1e9 / static_cast<double>(std::max<std::size_t>(items, 1)),
+        (allocations.load() - startAllocations) / static_cast<double>(iterations * decoded.size()),
+        matched);
+}
+
+// saves every page to a post store and reads them back
+void readSaved(const std::vector<std::string>& pages, std::size_t iterations)
+{
+    const auto filename = (boost::filesystem::temp_directory_path()
+        / boost::filesystem::unique_path("listingbench-%%%%-%%%%.posts")).string();
+
+    std::size_t links = 0;
+    double seconds = 0;
+    std::uint64_t allocationCount = 0;
+
+    {
+        arcc::PostStore store{ filename };
+        for (std::size_t i = 0; i < pages.size(); i++)
+        {
+            store.put(fmt::format("/r/bench/{}", i), arcc::decodeListing(pages.at(i))->children, 0);
+        }
+
+        const auto startAllocations = allocations.load();
+        const auto start = std::chrono::steady_clock::now();
+
+        for (auto i = 0u; i < iterations; i++)
+        {
+            for (std::size_t page = 0; page < pages.size(); page++)
+            {
+                links += store.get(fmt::format("/r/bench/{}", page), 100)->page.size();
+            }
+        }
+
+        seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        allocationCount = allocations.load() - startAllocations;
+    }
+
+    boost::filesystem::remove(filename);
+
+    const auto reads = static_cast<double>(iterations * pages.size());
+    std::cout << fmt::format("{:<22}{:>12.1f}{:>16.1f}{:>18}\n",
+        "PostStore::get",
+        seconds * 1e6 / reads,
+        allocationCount / reads,
+        links);
+}
+
+// indexes made up posts whose words are drawn so that a few are very
+// common and most are rare, the way they are in real text, and times a
+// few queries over them
+void searchPosts(std::size_t posts, std::size_t iterations)
+{
+    constexpr std::size_t VOCABULARY = 50000;
+    constexpr std::size_t BATCH = 1000;
+
+    std::mt19937 random{ 42 };
+
+    // word `n` comes up about 1/n as often as the first one
+    std::vector<double> weights(VOCABULARY);
+    for (std::size_t i = 0; i < VOCABULARY; i++) weights[i] = 1.0 / static_cast<double>(i + 1);
+    std::discrete_distribution<std::size_t> word{ weights.begin(), weights.end() };
+
+    const auto text = [&](std::size_t count)
+        {
+            std::string retval;
+            for (std::size_t i = 0; i < count; i++)
+            {
+                retval.append(fmt::format("w{} ", word(random)));
+            }
+
+            return retval;
+        };
+
+    arcc::SearchIndex index;
+    double seconds = 0;
+
+    for (std::size_t first = 0; first < posts; first += BATCH)
+    {
+        arcc::LinkPage page;
+        for (std::size_t i = first; i < std::min(first + BATCH, posts); i++)
+        {
+            arcc::Link link;
+            link.kind = "t3";
+            link.name = page.store(fmt::format("t3_{:x}", 0x100000 + i));
+            link.title = page.store(text(10));
+            link.selftext = page.store(text(random() % 4 == 0 ? 80 : 0));
+            link.author = page.store(fmt::format("user{}", random() % 5000));
+            link.subreddit = arcc::StringPool::instance().intern(fmt::format("r/sub{}", random() % 40));
+            page.push_back(link);
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        index.add(page);
+        seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    const auto stats = index.stats();
+    std::cout << fmt::format("{:<22}{:>12.2f}{:>16.1f}{:>18}\n",
+        "SearchIndex::add",
+        seconds * 1e6 / static_cast<double>(posts),
+        static_cast<double>(stats.postingBytes) / static_cast<double>(posts),
+        stats.words);
+
+    std::cout << fmt::format("\n{:<22}{:>12}{:>16}{:>18}\n", "", "ms/query", "allocs/query", "matched");
+
+    for (const auto query : { "w3", "w2000", "w3 w40", "w40 OR w4000", "w3 -w4", "w12*", "w1 w2 w3 -w4 sub7" })
+    {
+        std::size_t matched = 0;
+        const auto startAllocations = allocations.load();
+        const auto start = std::chrono::steady_clock::now();
+
+        for (std::size_t i = 0; i < iterations; i++)
+        {
+            matched = index.search(query).matches;
+        }
+
+        const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << fmt::format("{:<22}{:>12.2f}{:>16.1f}{:>18}\n",
+            query,
+            elapsed * 1e3 / static_cast<double>(iterations),
+            (allocations.load() - startAllocations) / static_cast<double>(iterations),
+            matched);
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    std::size_t iterations = 0;
+    std::size_t posts = 0;
+    std::vector<std::string> files;
+
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("help,?", "print help message")
+        ("iterations,i", po::value<std::size_t>(&iterations)->default_value(50), "passes over every page")
+        ("posts,p", po::value<std::size_t>(&posts)->default_value(200000), "made up posts to search")
+        ("files", po::value<std::vector<std::string>>(&files), "cassettes or listing responses, a generated page is used if none are given")
+    ;
+
+    po::positional_options_description positional;
+    positional.add("files", -1);
+
+    po::variables_map vm;
+
+    try
+    {
+        po::store(po::command_line_parser(argc, argv).options(desc).positional(positional).run(), vm);
+        po::notify(vm);
+    }
+    catch (const po::error& er)
+    {
+        std::cerr << er.what() << std::endl;
+        return 1;
+    }
+
+    if (vm.count("help"))
+    {
+        std::cout << desc << "\n";
+        return 0;
+    }
+
+    std::vector<std::string> pages;
+    try
+    {
+        for (const auto& file : files)
+        {
+            loadPages(file, pages);
+        }
+    }
+    catch (const std::exception& ex)
+    {
+        std::cerr << ex.what() << std::endl;
+        return 1;
+    }
+
+    if (files.empty()) pages = generatePages();
+    if (pages.empty())
+    {
+        std::cerr << "no listing pages found" << std::endl;
+        return 1;
+    }
+
+    std::size_t totalBytes = 0;
+    for (const auto& page : pages) totalBytes += page.size();
+
+    std::cout << fmt::format("{} page(s), {:.1f} KB on average, {} iteration(s)\n\n",
+        pages.size(), totalBytes / 1024.0 / pages.size(), iterations);
+
+    std::vector<std::pair<std::string, std::function<std::size_t(const std::string&)>>> decoders
+    {
+        { "json::parse",
+            [](const std::string& page)
+            {
+                return nlohmann::json::parse(page)["data"]["children"].size();
+            } },
+
+        { "json::parse + Link",
+            [](const std::string& page)
+            {
+                // what Listing did before it used the projection decoder
+                const auto json = nlohmann::json::parse(page);
+
+                arcc::LinkPage links;
+                for (const auto& child : json["data"]["children"])
+                {
+                    links.push_back(arcc::Link::fromJson(child, links));
+                }
+
+                return links.size();
+            } },
+
+        { "projection",
+            [](const std::string& page)
+            {
+                return arcc::decodeListing(page)->children.size();
+            } },
+    };
+
+    using Kernel = arcc::JsonIndex::Kernel;
+    for (const auto& [name, kernel] : { std::pair{ "index (scalar)", Kernel::SCALAR },
+        std::pair{ "index (sse2)", Kernel::SSE2 }, std::pair{ "index (avx2)", Kernel::AVX2 } })
+    {
+        if (!arcc::JsonIndex::supported(kernel)) continue;
+
+        decoders.emplace_back(name,
+            [kernel = kernel](const std::string& page)
+            {
+                return arcc::JsonIndex{ page, kernel }.tape().size();
+            });
+    }
+
+    std::cout << fmt::format("{:<22}{:>12}{:>16}{:>18}\n", "", "MB/s", "allocs/page", "alloc KB/page");
+
+    const auto pageCount = static_cast<double>(pages.size() * iterations);
+    for (const auto& [name, decode] : decoders)
+    {
+        const auto result = run(pages, iterations, decode);
+
+        std::cout << fmt::format("{:<22}{:>12.1f}{:>16.0f}{:>18.1f}\n",
+            name,
+            totalBytes * iterations / result.seconds / (1024 * 1024),
+            result.allocations / pageCount,
+            result.bytes / pageCount / 1024);
+    }
+
+    std::cout << fmt::format("\n{:<22}{:>12}{:>16}{:>18}\n", "", "ns/lookup", "KB/page held", "found");
+
+    compareLookups<nlohmann::json>("nlohmann::json", pages, iterations);
+    compareLookups<arcc::FlatJson>("arcc::FlatJson", pages, iterations);
+
+    std::cout << fmt::format("\n{:<72}{:>12}{:>16}{:>18}\n", "", "ns/item", "allocs/page", "matched");
+
+    filterLinks("score > 500", pages, iterations);
+    filterLinks(R"(score > 500 && num_comments < 50 && !stickied && flair ~ "discussion")", pages, iterations);
+    filterLinks(R"(title ~ "ordinary length" || author == "user42")", pages, iterations);
+
+    std::cout << fmt::format("\n{:<22}{:>12}{:>16}{:>18}\n", "", "us/page", "allocs/page", "links");
+
+    readSaved(pages, iterations);
+
+    std::cout << fmt::format("\n{:<22}{:>12}{:>16}{:>18}\n", "", "us/post", "postings B/post", "words");
+
+    searchPosts(posts, iterations);
+
+    return 0;
+}
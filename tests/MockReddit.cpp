@@ -0,0 +1,509 @@
+// Another Reddit Console Client
+// Copyright (c) 2017-2019, Adalid Claure <aclaure@gmail.com>
+
+// A stand-in for the parts of the reddit API that arcc talks to, so that
+// throughput and tail latency can be measured without a network. Point
+// arcc at it with
+//
+//     arcc --api-url=http://localhost:27183 --auth-url=http://localhost:27183
+//
+// Subreddits are served from `<fixtures>/<name>.json` (an array of listing
+// children) when such a file exists and are generated otherwise.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <unordered_map>
+
+#include <boost/filesystem.hpp>
+#include <boost/program_options.hpp>
+
+#include <fmt/core.h>
+#include <nlohmann/json.hpp>
+
+#include <server_http.hpp>
+
+namespace po = boost::program_options;
+
+using HttpServer = SimpleWeb::Server<SimpleWeb::HTTP>;
+using ResponsePtr = std::shared_ptr<HttpServer::Response>;
+using RequestPtr = std::shared_ptr<HttpServer::Request>;
+
+namespace
+{
+
+constexpr auto DEFAULT_PORT = 27183;
+constexpr auto DEFAULT_LIMIT = 25u;
+constexpr auto MAX_LIMIT = 100u;
+
+// mirrors reddit's budget of 600 requests per 10 minutes, it is only
+// reported in the headers and never enforced
+constexpr auto RATELIMIT_BUDGET = 600u;
+constexpr auto RATELIMIT_WINDOW = std::chrono::seconds{ 600 };
+
+struct Options
+{
+    unsigned short              port = DEFAULT_PORT;
+    std::size_t                 threads = 4;
+    std::chrono::milliseconds   latency{ 0 };
+    std::chrono::milliseconds   jitter{ 0 };
+    double                      throttle = 0.0;         // share of requests answered with a 429
+    double                      truncate = 0.0;         // share of bodies cut off half way
+    std::size_t                 posts = 1000;           // size of a generated subreddit
+    std::string                 fixtures;
+    std::size_t                 duration = 0;           // seconds to run, zero runs until interrupted
+};
+
+std::string toBase36(std::uint64_t value)
+{
+    constexpr auto digits = "0123456789abcdefghijklmnopqrstuvwxyz";
+
+    std::string retval;
+    do
+    {
+        retval.insert(retval.begin(), digits[value % 36]);
+        value /= 36;
+    }
+    while (value > 0);
+
+    return retval;
+}
+
+// one ordering of a subreddit's posts plus an index to find a cursor in it
+struct Ordering
+{
+    std::vector<const nlohmann::json*>              posts;
+    std::unordered_map<std::string, std::size_t>    position;
+
+    void index()
+    {
+        for (std::size_t i = 0; i < posts.size(); i++)
+        {
+            position.emplace((*posts[i])["data"].value("name", ""), i);
+        }
+    }
+};
+
+struct Subreddit
+{
+    std::string                     name;
+    std::vector<nlohmann::json>     children;
+    Ordering                        hot;
+    Ordering                        fresh;                  // "new"
+    Ordering                        top;
+};
+
+using SubredditPtr = std::shared_ptr<const Subreddit>;
+
+class MockReddit
+{
+    using Clock = std::chrono::steady_clock;
+
+    const Options                       _options;
+    HttpServer                          _server;
+
+    std::mutex                          _mutex;
+    std::map<std::string, SubredditPtr> _subreddits;    // guarded by _mutex
+    std::mt19937                        _random;        // guarded by _mutex
+
+    const Clock::time_point             _started = Clock::now();
+
+    std::atomic_uint64_t                _requests = 0;
+    std::atomic_uint64_t                _throttled = 0;
+    std::atomic_uint64_t                _truncated = 0;
+    std::atomic_uint64_t                _tokens = 0;
+
+public:
+    explicit MockReddit(const Options& options);
+
+    void start(const std::function<void(unsigned short)>& started) { _server.start(started); }
+    void stop() { _server.stop(); }
+
+    void printStats(std::ostream& out) const;
+
+private:
+    SubredditPtr subreddit(const std::string& name);
+    SubredditPtr loadSubreddit(const std::string& name);
+
+    std::string listing(const Ordering& ordering, const SimpleWeb::CaseInsensitiveMultimap& query) const;
+
+    void respond(ResponsePtr response, SimpleWeb::StatusCode status, std::string body);
+    std::string rateLimitHeaders() const;
+};
+
+MockReddit::MockReddit(const Options& options)
+    : _options{ options }
+{
+    _server.config.port = options.port;
+    _server.config.thread_pool_size = options.threads;
+
+    _server.resource["^/r/([^/]+)/(hot|new|top)/?$"]["GET"] =
+        [this](ResponsePtr response, RequestPtr request)
+        {
+            const auto sub = subreddit(request->path_match[1].str());
+            const auto sort = request->path_match[2].str();
+            const auto& ordering = sort == "new" ? sub->fresh : (sort == "top" ? sub->top : sub->hot);
+
+            respond(response, SimpleWeb::StatusCode::success_ok, listing(ordering, request->parse_query_string()));
+        };
+
+    _server.resource["^/r/([^/]+)/about/?$"]["GET"] =
+        [this](ResponsePtr response, RequestPtr request)
+        {
+            const auto sub = subreddit(request->path_match[1].str());
+
+            nlohmann::json about =
+            {
+                { "kind", "t5" },
+                { "data",
+                    {
+                        { "display_name", sub->name },
+                        { "title", fmt::format("r/{} on the mock server", sub->name) },
+                        { "subscribers", sub->children.size() * 100 },
+                        { "public_description", "Served by mockreddit" },
+                        { "over18", false }
+                    }
+                }
+            };
+
+            respond(response, SimpleWeb::StatusCode::success_ok, about.dump());
+        };
+
+    _server.resource["^/api/v1/me/?$"]["GET"] =
+        [this](ResponsePtr response, RequestPtr)
+        {
+            nlohmann::json me =
+            {
+                { "name", "mockuser" },
+                { "id", "mock1" },
+                { "link_karma", 1 },
+                { "comment_karma", 1 },
+                { "has_mail", false }
+            };
+
+            respond(response, SimpleWeb::StatusCode::success_ok, me.dump());
+        };
+
+    _server.resource["^/api/v1/access_token/?$"]["POST"] =
+        [this](ResponsePtr response, RequestPtr)
+        {
+            nlohmann::json token =
+            {
+                { "access_token", fmt::format("mock-token-{}", ++_tokens) },
+                { "token_type", "bearer" },
+                { "expires_in", 3600 },
+                { "scope", "*" }
+            };
+
+            respond(response, SimpleWeb::StatusCode::success_ok, token.dump());
+        };
+
+    _server.default_resource["GET"] =
+        [this](ResponsePtr response, RequestPtr)
+        {
+            respond(response, SimpleWeb::StatusCode::client_error_not_found, R"({"message": "Not Found", "error": 404})");
+        };
+}
+
+SubredditPtr MockReddit::subreddit(const std::string& name)
+{
+    {
+        std::lock_guard<std::mutex> lock{ _mutex };
+        if (auto it = _subreddits.find(name); it != _subreddits.end())
+        {
+            return it->second;
+        }
+    }
+
+    // build outside the lock, if two requests race the first one wins
+    auto sub = loadSubreddit(name);
+
+    std::lock_guard<std::mutex> lock{ _mutex };
+    return _subreddits.emplace(name, std::move(sub)).first->second;
+}
+
+SubredditPtr MockReddit::loadSubreddit(const std::string& name)
+{
+    auto retval = std::make_shared<Subreddit>();
+    retval->name = name;
+
+    const auto fixture = boost::filesystem::path{ _options.fixtures } / (name + ".json");
+    if (!_options.fixtures.empty() && boost::filesystem::exists(fixture))
+    {
+        std::ifstream in{ fixture.string() };
+        retval->children = nlohmann::json::parse(in).get<std::vector<nlohmann::json>>();
+    }
+    else
+    {
+        // same name, same posts, so runs are comparable
+        std::mt19937 random{ static_cast<std::uint32_t>(std::hash<std::string>{}(name)) };
+        std::uniform_int_distribution<int> score{ 0, 50000 };
+        std::uniform_int_distribution<int> comments{ 0, 2000 };
+
+        const std::int64_t now = 1546300800;
+        for (std::size_t i = 0; i < _options.posts; i++)
+        {
+            const auto id = toBase36(1000000 + i);
+            retval->children.push_back(
+            {
+                { "kind", "t3" },
+                { "data",
+                    {
+                        { "name", "t3_" + id },
+                        { "id", id },
+                        { "subreddit", name },
+                        { "title", fmt::format("Mock post number {} in r/{}", i, name) },
+                        { "author", fmt::format("user{}", random() % 5000) },
+                        { "score", score(random) },
+                        { "num_comments", comments(random) },
+                        { "created_utc", now - static_cast<std::int64_t>(random() % (86400 * 7)) },
+                        { "over_18", false },
+                        { "is_self", i % 3 == 0 },
+                        { "selftext", std::string(random() % 600, 'x') },
+                        { "permalink", fmt::format("/r/{}/comments/{}/mock_post_{}/", name, id, i) },
+                        { "url", fmt::format("https://example.com/{}/{}", name, id) }
+                    }
+                }
+            });
+        }
+    }
+
+    for (const auto& child : retval->children)
+    {
+        retval->hot.posts.push_back(&child);
+    }
+
+    retval->fresh.posts = retval->hot.posts;
+    std::stable_sort(retval->fresh.posts.begin(), retval->fresh.posts.end(),
+        [](const nlohmann::json* a, const nlohmann::json* b)
+        {
+            return (*a)["data"].value("created_utc", 0.0) > (*b)["data"].value("created_utc", 0.0);
+        });
+
+    retval->top.posts = retval->hot.posts;
+    std::stable_sort(retval->top.posts.begin(), retval->top.posts.end(),
+        [](const nlohmann::json* a, const nlohmann::json* b)
+        {
+            return (*a)["data"].value("score", 0) > (*b)["data"].value("score", 0);
+        });
+
+    retval->hot.index();
+    retval->fresh.index();
+    retval->top.index();
+
+    return retval;
+}
+
+std::string MockReddit::listing(const Ordering& ordering, const SimpleWeb::CaseInsensitiveMultimap& query) const
+{
+    const auto param = [&query](const std::string& name) -> std::string
+        {
+            const auto it = query.find(name);
+            return it == query.end() ? std::string{} : it->second;
+        };
+
+    std::size_t limit = DEFAULT_LIMIT;
+    if (const auto value = param("limit"); !value.empty())
+    {
+        limit = std::clamp<std::size_t>(std::strtoul(value.c_str(), nullptr, 10), 1, MAX_LIMIT);
+    }
+
+    const auto& posts = ordering.posts;
+    std::size_t start = 0;
+
+    // like reddit, an unknown cursor gives an empty page
+    if (const auto after = param("after"); !after.empty())
+    {
+        const auto it = ordering.position.find(after);
+        start = it == ordering.position.end() ? posts.size() : it->second + 1;
+    }
+    else if (const auto before = param("before"); !before.empty())
+    {
+        const auto it = ordering.position.find(before);
+        const auto end = it == ordering.position.end() ? 0 : it->second;
+        start = end > limit ? end - limit : 0;
+        limit = end - start;
+    }
+
+    const auto end = std::min(start + limit, posts.size());
+
+    nlohmann::json children = nlohmann::json::array();
+    for (auto i = start; i < end; i++)
+    {
+        children.push_back(*posts[i]);
+    }
+
+    nlohmann::json retval =
+    {
+        { "kind", "Listing" },
+        { "data",
+            {
+                { "modhash", "" },
+                { "dist", end - start },
+                { "children", std::move(children) },
+                { "after", end < posts.size() && end > start ? (*posts[end - 1])["data"]["name"] : nlohmann::json{} },
+                { "before", start > 0 && end > start ? (*posts[start])["data"]["name"] : nlohmann::json{} }
+            }
+        }
+    };
+
+    return retval.dump();
+}
+
+std::string MockReddit::rateLimitHeaders() const
+{
+    const auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(Clock::now() - _started);
+    const auto reset = RATELIMIT_WINDOW - (elapsed % RATELIMIT_WINDOW);
+    const auto used = static_cast<std::uint64_t>(_requests % RATELIMIT_BUDGET);
+
+    return fmt::format("x-ratelimit-remaining: {}.0\r\nx-ratelimit-used: {}\r\nx-ratelimit-reset: {}\r\n",
+        RATELIMIT_BUDGET - used, used, reset.count());
+}
+
+void MockReddit::respond(ResponsePtr response, SimpleWeb::StatusCode status, std::string body)
+{
+    ++_requests;
+
+    bool throttle = false;
+    bool truncate = false;
+    auto delay = _options.latency;
+
+    {
+        std::lock_guard<std::mutex> lock{ _mutex };
+        std::uniform_real_distribution<double> chance{ 0.0, 1.0 };
+
+        throttle = chance(_random) < _options.throttle;
+        truncate = !throttle && chance(_random) < _options.truncate;
+
+        if (_options.jitter.count() > 0)
+        {
+            std::uniform_int_distribution<long> jitter{ 0, static_cast<long>(_options.jitter.count()) };
+            delay += std::chrono::milliseconds{ jitter(_random) };
+        }
+    }
+
+    auto send = [this, response, status, body = std::move(body), throttle, truncate]()
+        {
+            auto& out = *response;
+
+            if (throttle)
+            {
+                ++_throttled;
+                const std::string message = R"({"message": "Too Many Requests", "error": 429})";
+                out << "HTTP/1.1 429 Too Many Requests\r\n"
+                    << "Content-Type: application/json; charset=UTF-8\r\n"
+                    << "Retry-After: 1\r\n"
+                    << rateLimitHeaders()
+                    << "Content-Length: " << message.size() << "\r\n\r\n"
+                    << message;
+                return;
+            }
+
+            const auto code = status == SimpleWeb::StatusCode::success_ok ? "200 OK" : "404 Not Found";
+            out << "HTTP/1.1 " << code << "\r\n"
+                << "Content-Type: application/json; charset=UTF-8\r\n"
+                << rateLimitHeaders()
+                << "Content-Length: " << body.size() << "\r\n\r\n";
+
+            if (truncate)
+            {
+                // promise the whole body, send half and hang up
+                ++_truncated;
+                out << body.substr(0, body.size() / 2);
+                response->close_connection_after_response = true;
+                return;
+            }
+
+            out << body;
+        };
+
+    if (delay.count() == 0)
+    {
+        send();
+        return;
+    }
+
+    // the response goes out when the last copy of `response` is dropped,
+    // so the pool thread is free to take the next request meanwhile
+    std::thread([delay, send = std::move(send)]()
+        {
+            std::this_thread::sleep_for(delay);
+            send();
+        }).detach();
+}
+
+void MockReddit::printStats(std::ostream& out) const
+{
+    out << fmt::format("requests: {}  throttled: {}  truncated: {}  tokens issued: {}",
+        _requests.load(), _throttled.load(), _truncated.load(), _tokens.load()) << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    long latency = 0;
+    long jitter = 0;
+
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("help,?", "print help message")
+        ("port,p", po::value<unsigned short>(&options.port)->default_value(DEFAULT_PORT), "port to listen on")
+        ("threads", po::value<std::size_t>(&options.threads)->default_value(4), "server threads")
+        ("latency", po::value<long>(&latency)->default_value(0), "delay every response by this many milliseconds")
+        ("jitter", po::value<long>(&jitter)->default_value(0), "add up to this many random milliseconds to every response")
+        ("throttle", po::value<double>(&options.throttle)->default_value(0.0), "share of requests (0-1) answered with a 429")
+        ("truncate", po::value<double>(&options.truncate)->default_value(0.0), "share of responses (0-1) whose body is cut off")
+        ("posts", po::value<std::size_t>(&options.posts)->default_value(1000), "number of posts in a generated subreddit")
+        ("fixtures", po::value<std::string>(&options.fixtures), "folder with <subreddit>.json fixture files")
+        ("duration", po::value<std::size_t>(&options.duration)->default_value(0), "stop after this many seconds, 0 runs until killed")
+    ;
+
+    po::variables_map vm;
+
+    try
+    {
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+        po::notify(vm);
+    }
+    catch (const po::error& er)
+    {
+        std::cerr << er.what() << std::endl;
+        return 1;
+    }
+
+    if (vm.count("help"))
+    {
+        std::cout << desc << "\n";
+        return 0;
+    }
+
+    options.latency = std::chrono::milliseconds{ std::max(latency, 0L) };
+    options.jitter = std::chrono::milliseconds{ std::max(jitter, 0L) };
+
+    MockReddit server{ options };
+    std::thread thread([&server]()
+        {
+            server.start([](unsigned short port)
+                {
+                    std::cout << "mockreddit listening on http://localhost:" << port << std::endl;
+                });
+        });
+
+    if (options.duration > 0)
+    {
+        std::this_thread::sleep_for(std::chrono::seconds{ options.duration });
+        server.stop();
+    }
+
+    thread.join();
+    server.printStats(std::cout);
+
+    return 0;
+}
@@ -0,0 +1,1282 @@
+#include <atomic>
+#include <fstream>
+#include <future>
+#include <optional>
+#include <ranges>
+#include <sstream>
+#include <thread>
+
+#include <boost/test/unit_test.hpp>
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/filesystem.hpp>
+
+#include <fmt/core.h>
+#include <nlohmann/json.hpp>
+
+#include "../arcc/Cassette.h"
+#include "../arcc/Exporter.h"
+#include "../arcc/FilteredListing.h"
+#include "../arcc/ListingDecoder.h"
+#include "../arcc/ListingStream.h"
+#include "../arcc/MergedListing.h"
+#include "../arcc/PostStore.h"
+#include "../arcc/RedditSession.h"
+#include "../arcc/SearchListing.h"
+#include "../arcc/Watcher.h"
+
+using namespace std::string_literals;
+
+BOOST_AUTO_TEST_SUITE(Replay)
+
+#ifndef _CASSETTE_FILE
+#   error "_CASSETTE_FILE not defined, replay unit tests cannot run"
+#endif
+
+// a session whose token is fresh, so nothing ever asks for a new one
+std::shared_ptr<arcc::RedditSession> replaySession(arcc::TransportPtr transport)
+{
+    auto session = std::make_shared<arcc::RedditSession>("token", "refresh", 3600.0, std::time(nullptr));
+    session->setTransport(transport);
+    return session;
+}
+
+BOOST_AUTO_TEST_CASE(ReplayListing)
+{
+    auto session = replaySession(std::make_shared<arcc::ReplayTransport>(_CASSETTE_FILE));
+
+    arcc::Listing listing{ session, "/r/cpp/new", 2u };
+    auto page = listing.getFirstPage();
+    BOOST_REQUIRE_EQUAL(page.size(), 2u);
+    BOOST_CHECK_EQUAL(page.at(0).name, "t3_a1"s);
+    BOOST_CHECK_EQUAL(page.at(1).name, "t3_a2"s);
+    BOOST_CHECK_EQUAL(listing.after(), "t3_a2"s);
+
+    page = listing.getNextPage();
+    BOOST_REQUIRE_EQUAL(page.size(), 1u);
+    BOOST_CHECK_EQUAL(page.at(0).name, "t3_a3"s);
+
+    // the last page has no `after`, so there is nothing left to ask for
+    BOOST_CHECK(listing.getNextPage().empty());
+
+    // a recorded error status comes back as an empty page
+    arcc::Listing denied{ session, "/r/private/new", 2u };
+    BOOST_CHECK(denied.getFirstPage().empty());
+}
+
+BOOST_AUTO_TEST_CASE(DecodeLinks)
+{
+    auto session = replaySession(std::make_shared<arcc::ReplayTransport>(_CASSETTE_FILE));
+
+    arcc::Listing listing{ session, "/r/cpp/new", 2u };
+    auto page = listing.getFirstPage();
+    BOOST_REQUIRE_EQUAL(page.size(), 2u);
+
+    const auto& link = page.at(0);
+    BOOST_CHECK_EQUAL(link.kind, "t3");
+    BOOST_CHECK_EQUAL(link.title, "First post");
+    BOOST_CHECK_EQUAL(link.url, "https://example.com/t3_a1");
+    BOOST_CHECK_EQUAL(link.subreddit, "r/cpp");
+    BOOST_CHECK_EQUAL(link.score, 10);
+    BOOST_CHECK(link.flair.empty());
+    BOOST_CHECK(!link.raw);
+
+    // both posts share a single copy of the subreddit
+    BOOST_CHECK_EQUAL(link.author, "someone");
+    BOOST_CHECK(link.subreddit.data() == page.at(1).subreddit.data());
+
+    const auto plainUsage = page.memoryUsage();
+
+    arcc::Listing raw{ session, "/r/cpp/new", 2u };
+    raw.setKeepRaw(true);
+    page = raw.getFirstPage();
+    BOOST_REQUIRE_EQUAL(page.size(), 2u);
+    BOOST_REQUIRE(page.at(0).raw);
+    BOOST_CHECK_EQUAL(page.at(0).raw->at("name"), "t3_a1"s);
+    BOOST_CHECK(page.memoryUsage() > plainUsage);
+}
+
+BOOST_AUTO_TEST_CASE(LinkPageArena)
+{
+    arcc::LinkPage page;
+    BOOST_CHECK(page.empty());
+    BOOST_CHECK(page.begin() == page.end());
+    BOOST_CHECK_EQUAL(page.memoryUsage(), 0u);
+    BOOST_CHECK_THROW(page.at(0), std::out_of_range);
+
+    std::string title{ "a title that is copied into the page" };
+
+    arcc::Link link;
+    link.title = page.store(title);
+    link.name = page.store("t3_x1");
+    BOOST_CHECK(page.store("").empty());
+    page.push_back(link);
+
+    title.assign(title.size(), '-');
+    BOOST_CHECK_EQUAL(page.at(0).title, "a title that is copied into the page");
+    BOOST_CHECK_EQUAL(page.at(0).name, "t3_x1");
+
+    // copies share the links and the arena, and keep both alive
+    std::optional<arcc::LinkPage> copy{ page };
+    page = arcc::LinkPage{};
+    BOOST_CHECK(page.empty());
+    BOOST_REQUIRE_EQUAL(copy->size(), 1u);
+    BOOST_CHECK_EQUAL((*copy)[0].title, "a title that is copied into the page");
+
+    arcc::LinkPage shared{ *copy };
+    BOOST_CHECK(shared.at(0).title.data() == copy->at(0).title.data());
+    copy.reset();
+    BOOST_CHECK_EQUAL(shared.at(0).name, "t3_x1");
+
+    // pages handed out by a Listing share their text with its cache
+    auto session = replaySession(std::make_shared<arcc::ReplayTransport>(_CASSETTE_FILE));
+    arcc::Listing listing{ session, "/r/cpp/new", 2u };
+    const auto first = listing.getFirstPage();
+    BOOST_REQUIRE_EQUAL(listing.getNextPage().size(), 1u);
+    const auto again = listing.getPreviousPage();
+    BOOST_REQUIRE_EQUAL(again.size(), 2u);
+    BOOST_CHECK(again.at(0).title.data() == first.at(0).title.data());
+}
+
+BOOST_AUTO_TEST_CASE(ProjectionDecoder)
+{
+    const std::string text = R"({
+        "kind": "Listing",
+        "data": {
+            "modhash": "", "dist": 2, "after": "t3_b2", "before": null,
+            "children": [
+                { "kind": "t3", "data": {
+                    "preview": { "images": [ { "source": { "url": "x}]\"{" } } ], "enabled": true },
+                    "all_awardings": [], "media": null,
+                    "title": "caf\u00e9 \"quoted\" \ud83d\ude00",
+                    "name": "t3_b1", "score": -4, "ups": 12, "num_comments": 3,
+                    "created_utc": 1546300800.0, "stickied": true,
+                    "author": "someone", "subreddit": "cpp", "link_flair_text": null,
+                    "url": "https:\/\/example.com\/b1", "permalink": "/r/cpp/comments/b1/",
+                    "selftext": "line one\nline two"
+                } },
+                { "kind": "t3", "data": {
+                    "name": "t3_b2", "subreddit_name_prefixed": "r/cpp", "author": "someone",
+                    "link_flair_text": "News", "score": 1
+                } },
+                { "kind": "t3", "data": null }
+            ]
+        }
+    })";
+
+    const auto listing = arcc::decodeListing(text);
+    BOOST_REQUIRE(listing);
+    BOOST_CHECK_EQUAL(listing->after, "t3_b2");
+    BOOST_CHECK(listing->before.empty());
+    BOOST_REQUIRE_EQUAL(listing->children.size(), 2u);
+
+    const auto& first = listing->children.at(0);
+    BOOST_CHECK_EQUAL(first.name, "t3_b1");
+    BOOST_CHECK_EQUAL(first.title, "caf\u00e9 \"quoted\" \U0001F600");
+    BOOST_CHECK_EQUAL(first.url, "https://example.com/b1");
+    BOOST_CHECK_EQUAL(first.permalink, "/r/cpp/comments/b1/");
+    BOOST_CHECK_EQUAL(first.selftext, "line one\nline two");
+    BOOST_CHECK_EQUAL(first.score, -4);
+    BOOST_CHECK_EQUAL(first.ups, 12u);
+    BOOST_CHECK_EQUAL(first.comments, 3u);
+    BOOST_CHECK_EQUAL(first.created, 1546300800u);
+    BOOST_CHECK(first.stickied);
+    BOOST_CHECK_EQUAL(first.subreddit, "r/cpp");
+    BOOST_CHECK(first.flair.empty());
+    BOOST_CHECK(!first.raw);
+
+    const auto& second = listing->children.at(1);
+    BOOST_CHECK_EQUAL(second.flair, "News");
+    BOOST_CHECK(!second.stickied);
+    BOOST_CHECK_EQUAL(second.author, "someone");
+
+    // subreddits are interned, authors are too many and stay with the page
+    BOOST_CHECK(second.subreddit.data() == first.subreddit.data());
+    BOOST_CHECK(second.author.data() != first.author.data());
+
+    // agrees with decoding through the DOM
+    const auto dom = nlohmann::json::parse(text);
+    arcc::LinkPage domPage;
+    const auto expected = arcc::Link::fromJson(dom["data"]["children"][0], domPage);
+    BOOST_CHECK_EQUAL(first.title, expected.title);
+    BOOST_CHECK_EQUAL(first.selftext, expected.selftext);
+    BOOST_CHECK_EQUAL(first.created, expected.created);
+    BOOST_CHECK_EQUAL(first.subreddit, expected.subreddit);
+
+    const auto raw = arcc::decodeListing(text, arcc::RawJson::PARSED);
+    BOOST_REQUIRE(raw);
+    BOOST_REQUIRE(raw->children.at(0).raw);
+    BOOST_CHECK_EQUAL(raw->children.at(0).raw->dump(), dom["data"]["children"][0]["data"].dump());
+
+    const auto kept = arcc::decodeListing(text, arcc::RawJson::TEXT);
+    BOOST_REQUIRE(kept);
+    BOOST_CHECK(!kept->children.at(0).raw);
+    BOOST_CHECK(nlohmann::json::parse(kept->children.at(0).text) == dom["data"]["children"][0]["data"]);
+
+    BOOST_CHECK(!arcc::decodeListing(""));
+    BOOST_CHECK(!arcc::decodeListing(R"({"kind": "Listing"})"));
+    BOOST_CHECK(!arcc::decodeListing(text.substr(0, text.size() / 2)));
+}
+
+BOOST_AUTO_TEST_CASE(ExportListing)
+{
+    auto session = replaySession(std::make_shared<arcc::ReplayTransport>(_CASSETTE_FILE));
+
+    std::stringstream all;
+    arcc::Exporter exporter{ session, "/r/cpp/new" };
+    auto stats = exporter.run(all, 1000, 2);
+
+    // the listing ends after the second page
+    BOOST_CHECK_EQUAL(stats.pages, 2u);
+    BOOST_CHECK_EQUAL(stats.items, 3u);
+    BOOST_CHECK_EQUAL(stats.bytes, all.str().size());
+
+    // each item exactly as reddit sent it
+    BOOST_CHECK_EQUAL(all.str().substr(0, all.str().find('\n')),
+        R"({"name": "t3_a1", "title": "First post", "score": 10, "subreddit": "cpp", "author": "someone", "url": "https://example.com/t3_a1"})");
+
+    std::string line;
+    std::vector<nlohmann::json> items;
+    while (std::getline(all, line)) items.push_back(nlohmann::json::parse(line));
+
+    BOOST_REQUIRE_EQUAL(items.size(), 3u);
+    BOOST_CHECK_EQUAL(items.at(2)["name"], "t3_a3");
+    BOOST_CHECK_EQUAL(items.at(2)["url"], "https://example.com/t3_a3");
+
+    std::stringstream some;
+    exporter.setFields({ "name", "score", "missing" });
+    stats = exporter.run(some, 2, 2);
+
+    BOOST_CHECK_EQUAL(stats.pages, 1u);
+    BOOST_CHECK_EQUAL(some.str(), "{\"name\":\"t3_a1\",\"score\":10}\n{\"name\":\"t3_a2\",\"score\":7}\n");
+}
+
+BOOST_AUTO_TEST_CASE(StreamListing)
+{
+    static_assert(std::ranges::input_range<arcc::ListingStream>);
+
+    auto session = replaySession(std::make_shared<arcc::ReplayTransport>(_CASSETTE_FILE));
+
+    {
+        // runs until reddit says there is nothing after the second page
+        arcc::ListingStream stream{ session, "/r/cpp/new", 1000 };
+        stream.setPageSize(2);
+        stream.setDepth(1);
+
+        std::vector<std::string> names;
+        for (const auto& link : stream)
+        {
+            names.emplace_back(link.name);
+        }
+
+        BOOST_CHECK((names == std::vector<std::string>{ "t3_a1", "t3_a2", "t3_a3" }));
+        BOOST_CHECK_EQUAL(stream.pagesFetched(), 2u);
+        BOOST_CHECK_THROW(stream.begin(), std::runtime_error);
+    }
+
+    {
+        // stops at the limit without asking for another page
+        arcc::ListingStream stream{ session, "/r/cpp/new", 2 };
+        stream.setPageSize(500);
+        BOOST_CHECK_EQUAL(stream.pageSize(), arcc::ListingStream::MAX_PAGE_SIZE);
+        stream.setPageSize(2);
+
+        const auto count = std::ranges::distance(stream.begin(), stream.end());
+        BOOST_CHECK_EQUAL(count, 2);
+        BOOST_CHECK_EQUAL(stream.pagesFetched(), 1u);
+    }
+
+    {
+        // walking away halfway does not wait for the rest of the listing
+        arcc::ListingStream stream{ session, "/r/cpp/new", 1000 };
+        stream.setPageSize(2);
+
+        auto it = stream.begin();
+        BOOST_REQUIRE(it != stream.end());
+        BOOST_CHECK_EQUAL(it->name, "t3_a1");
+    }
+}
+
+// a recorded listing page whose children were created at the given times
+arcc::CassetteEntry listingEntry(const std::string& url, const std::string& sub,
+    const std::vector<std::pair<std::string, std::uint32_t>>& items, const std::string& after,
+    const std::string& before = {})
+{
+    nlohmann::json children = nlohmann::json::array();
+    for (const auto& [name, created] : items)
+    {
+        children.push_back({ { "kind", "t3" }, { "data", {
+            { "name", name }, { "created_utc", created }, { "score", created / 10 },
+            { "subreddit_name_prefixed", sub } } } });
+    }
+
+    arcc::CassetteEntry entry;
+    entry.url = url;
+    entry.finalUrl = url;
+    entry.status = 200;
+    entry.data = nlohmann::json{ { "kind", "Listing" }, { "data", {
+        { "after", after.empty() ? nlohmann::json{} : nlohmann::json(after) },
+        { "before", before.empty() ? nlohmann::json{} : nlohmann::json(before) },
+        { "children", children } } } }.dump();
+
+    return entry;
+}
+
+BOOST_AUTO_TEST_CASE(LargePages)
+{
+    // pages of more than reddit sends at once are put together from
+    // several requests that carry on from each other
+    const auto items = [](std::size_t first, std::size_t count)
+        {
+            std::vector<std::pair<std::string, std::uint32_t>> retval;
+            for (auto i = first; i < first + count; i++)
+            {
+                retval.emplace_back(fmt::format("t3_x{}", i), static_cast<std::uint32_t>(1000 - i));
+            }
+
+            return retval;
+        };
+
+    const std::string base = "https://oauth.reddit.com/r/a/new";
+    const std::vector<arcc::CassetteEntry> entries
+    {
+        listingEntry(base + "?limit=100&", "r/a", items(1, 100), "t3_x100"),
+        listingEntry(base + "?after=t3_x100&count=100&limit=50&", "r/a", items(101, 50), "t3_x150"),
+        listingEntry(base + "?after=t3_x150&count=150&limit=100&", "r/a", items(151, 100), "t3_x250"),
+        listingEntry(base + "?after=t3_x250&count=250&limit=50&", "r/a", items(251, 20), ""),
+    };
+
+    auto session = replaySession(std::make_shared<arcc::ReplayTransport>(entries));
+    arcc::Listing listing{ session, "/r/a/new", 150u };
+
+    auto page = listing.getFirstPage();
+    BOOST_REQUIRE_EQUAL(page.size(), 150u);
+    BOOST_CHECK_EQUAL(page.at(0).name, "t3_x1");
+    BOOST_CHECK_EQUAL(page.at(149).name, "t3_x150");
+    BOOST_CHECK_EQUAL(listing.after(), "t3_x150");
+
+    page = listing.getNextPage();
+    BOOST_REQUIRE_EQUAL(page.size(), 120u);
+    BOOST_CHECK_EQUAL(page.at(0).name, "t3_x151");
+    BOOST_CHECK(listing.after().empty());
+    BOOST_CHECK(listing.getNextPage().empty());
+
+    BOOST_CHECK_EQUAL(listing.getPreviousPage().at(149).name, "t3_x150");
+
+    // going back without the cache walks backwards from the first item
+    const std::string other = "https://oauth.reddit.com/r/b/new";
+    const std::vector<arcc::CassetteEntry> uncached
+    {
+        listingEntry(other + "?limit=100&", "r/b", items(1, 100), "t3_x100"),
+        listingEntry(other + "?after=t3_x100&count=100&limit=50&", "r/b", items(101, 50), "t3_x150"),
+        listingEntry(other + "?after=t3_x150&count=150&limit=100&", "r/b", items(151, 100), "t3_x250", "t3_x151"),
+        listingEntry(other + "?after=t3_x250&count=250&limit=50&", "r/b", items(251, 50), "t3_x300", "t3_x251"),
+        listingEntry(other + "?after=t3_x300&count=300&limit=100&", "r/b", items(301, 100), "t3_x400", "t3_x301"),
+        listingEntry(other + "?after=t3_x400&count=400&limit=50&", "r/b", items(401, 20), "", "t3_x401"),
+        listingEntry(other + "?before=t3_x301&count=151&limit=100&", "r/b", items(201, 100), "t3_x300", "t3_x201"),
+        listingEntry(other + "?before=t3_x201&count=51&limit=50&", "r/b", items(151, 50), "t3_x200", "t3_x151"),
+    };
+
+    session = replaySession(std::make_shared<arcc::ReplayTransport>(uncached));
+    arcc::Listing back{ session, "/r/b/new", 150u };
+    back.setCacheSize(0);
+
+    back.getFirstPage();
+    back.getNextPage();
+    BOOST_REQUIRE_EQUAL(back.getNextPage().size(), 120u);
+
+    page = back.getPreviousPage();
+    BOOST_REQUIRE_EQUAL(page.size(), 150u);
+    BOOST_CHECK_EQUAL(page.at(0).name, "t3_x151");
+    BOOST_CHECK_EQUAL(page.at(149).name, "t3_x300");
+    BOOST_CHECK_EQUAL(back.before(), "t3_x151");
+    BOOST_CHECK_EQUAL(back.after(), "t3_x300");
+
+    // calling it off aborts the request under way
+    auto slow = std::make_shared<arcc::ReplayTransport>(entries);
+    slow->setLatency(std::chrono::milliseconds{ 500 });
+    session = replaySession(slow);
+
+    const auto cancel = std::make_shared<std::atomic_bool>(false);
+    const auto start = std::chrono::steady_clock::now();
+    auto fetch = std::async(std::launch::async, [&]
+        {
+            return arcc::Listing::fetchPage(*session, "/r/a/new", arcc::Params{ { "limit", "150" } },
+                arcc::RawJson::NONE, arcc::RequestPriority::BACKGROUND, cancel);
+        });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds{ 50 });
+    *cancel = true;
+
+    BOOST_CHECK_THROW(fetch.get(), arcc::WebClientError);
+    BOOST_CHECK(std::chrono::steady_clock::now() - start < std::chrono::milliseconds{ 300 });
+}
+
+BOOST_AUTO_TEST_CASE(MergeListings)
+{
+    const std::string base = "https://oauth.reddit.com";
+    const std::vector<arcc::CassetteEntry> entries
+    {
+        listingEntry(base + "/r/a/new?limit=2&", "r/a", { { "t3_a1", 100 }, { "t3_a2", 80 } }, "t3_a2"),
+        listingEntry(base + "/r/a/new?after=t3_a2&count=2&limit=2&", "r/a", { { "t3_a3", 50 } }, ""),
+        listingEntry(base + "/r/b/new?limit=2&", "r/b", { { "t3_b1", 90 }, { "t3_b2", 70 } }, "t3_b2"),
+        listingEntry(base + "/r/b/new?after=t3_b2&count=2&limit=2&", "r/b", { { "t3_b3", 60 }, { "t3_b4", 10 } }, ""),
+    };
+
+    auto session = replaySession(std::make_shared<arcc::ReplayTransport>(entries));
+    arcc::MergedListing listing{ session, { "/r/a/new", "/r/b/new" }, 2u, arcc::Params{}, arcc::MergeOrder::CREATED };
+
+    const auto names = [](const arcc::LinkPage& page)
+        {
+            std::vector<std::string> retval;
+            for (const auto& link : page) retval.emplace_back(link.name);
+            return retval;
+        };
+
+    using Names = std::vector<std::string>;
+    BOOST_CHECK((names(listing.getFirstPage()) == Names{ "t3_a1", "t3_b1" }));
+    BOOST_CHECK((names(listing.getNextPage()) == Names{ "t3_a2", "t3_b2" }));
+    BOOST_CHECK((names(listing.getNextPage()) == Names{ "t3_b3", "t3_a3" }));
+    BOOST_CHECK((names(listing.getNextPage()) == Names{ "t3_b4" }));
+    BOOST_CHECK(listing.getNextPage().empty());
+
+    // earlier pages come back without asking reddit again
+    const auto previous = listing.getPreviousPage();
+    BOOST_CHECK((names(previous) == Names{ "t3_b3", "t3_a3" }));
+    BOOST_CHECK_EQUAL(previous.at(0).subreddit, "r/b");
+    BOOST_CHECK((names(listing.getNextPage()) == Names{ "t3_b4" }));
+
+    // with no room for pages, going back merges everything up to it again
+    auto replay = std::make_shared<arcc::ReplayTransport>(entries);
+    auto uncachedSession = replaySession(replay);
+    arcc::MergedListing uncached{ uncachedSession, { "/r/a/new", "/r/b/new" }, 2u, arcc::Params{}, arcc::MergeOrder::CREATED };
+    uncached.setCacheSize(0);
+    BOOST_CHECK((names(uncached.getFirstPage()) == Names{ "t3_a1", "t3_b1" }));
+    BOOST_CHECK((names(uncached.getNextPage()) == Names{ "t3_a2", "t3_b2" }));
+    BOOST_CHECK((names(uncached.getNextPage()) == Names{ "t3_b3", "t3_a3" }));
+    BOOST_CHECK((names(uncached.getPreviousPage()) == Names{ "t3_a2", "t3_b2" }));
+    BOOST_CHECK_EQUAL(replay->played(arcc::Transport::Method::GET, base + "/r/a/new?limit=2&"), 2u);
+    BOOST_CHECK((names(uncached.getNextPage()) == Names{ "t3_b3", "t3_a3" }));
+    BOOST_CHECK((names(uncached.getNextPage()) == Names{ "t3_b4" }));
+
+    // a newer post ranks hotter unless it is far behind on score
+    arcc::Link older;
+    older.score = 100;
+    older.created = 1546300800;
+    auto newer = older;
+    newer.created += 12 * 3600;
+    BOOST_CHECK(arcc::MergedListing::rank(newer, arcc::MergeOrder::HOT) > arcc::MergedListing::rank(older, arcc::MergeOrder::HOT));
+    newer.score = 1;
+    BOOST_CHECK(arcc::MergedListing::rank(newer, arcc::MergeOrder::HOT) < arcc::MergedListing::rank(older, arcc::MergeOrder::HOT));
+}
+
+BOOST_AUTO_TEST_CASE(DeduplicateListing)
+{
+    // new posts push older ones onto the next page, so pages repeat items
+    const std::string base = "https://oauth.reddit.com";
+    const std::vector<arcc::CassetteEntry> entries
+    {
+        listingEntry(base + "/r/a/new?limit=2&", "r/a", { { "t3_a1", 100 }, { "t3_a2", 90 } }, "t3_a2"),
+        listingEntry(base + "/r/a/new?after=t3_a2&count=2&limit=2&", "r/a", { { "t3_a2", 90 }, { "t3_a3", 80 } }, "t3_a3"),
+        listingEntry(base + "/r/a/new?after=t3_a3&count=4&limit=2&", "r/a", { { "t3_a2", 90 }, { "t3_a3", 80 } }, "t3_a4"),
+        listingEntry(base + "/r/a/new?after=t3_a4&count=6&limit=2&", "r/a", { { "t3_a4", 70 } }, ""),
+    };
+
+    auto session = replaySession(std::make_shared<arcc::ReplayTransport>(entries));
+
+    const auto names = [](const arcc::LinkPage& page)
+        {
+            std::vector<std::string> retval;
+            for (const auto& link : page) retval.emplace_back(link.name);
+            return retval;
+        };
+
+    using Names = std::vector<std::string>;
+
+    {
+        arcc::Listing listing{ session, "/r/a/new", 2u };
+        BOOST_CHECK(!listing.deduplicate());
+        listing.getFirstPage();
+        BOOST_CHECK((names(listing.getNextPage()) == Names{ "t3_a2", "t3_a3" }));
+    }
+
+    {
+        arcc::Listing listing{ session, "/r/a/new", 2u };
+        listing.setDeduplicate(arcc::SeenSet::Mode::EXACT);
+
+        BOOST_CHECK((names(listing.getFirstPage()) == Names{ "t3_a1", "t3_a2" }));
+        BOOST_CHECK((names(listing.getNextPage()) == Names{ "t3_a3" }));
+
+        // a page of nothing but repeats is skipped
+        BOOST_CHECK((names(listing.getNextPage()) == Names{ "t3_a4" }));
+        BOOST_CHECK(listing.getNextPage().empty());
+
+        // going back shows what was shown before, not less
+        BOOST_CHECK((names(listing.getPreviousPage()) == Names{ "t3_a3" }));
+        BOOST_CHECK((names(listing.getPreviousPage()) == Names{ "t3_a1", "t3_a2" }));
+        BOOST_CHECK((names(listing.getNextPage()) == Names{ "t3_a3" }));
+
+        // starting over forgets what was seen
+        BOOST_CHECK((names(listing.getFirstPage()) == Names{ "t3_a1", "t3_a2" }));
+        BOOST_CHECK((names(listing.getNextPage()) == Names{ "t3_a3" }));
+    }
+
+    {
+        std::stringstream out;
+        arcc::Exporter exporter{ session, "/r/a/new" };
+        exporter.setDeduplicate(arcc::SeenSet::Mode::EXACT);
+
+        const auto stats = exporter.run(out, 10, 2);
+        BOOST_CHECK_EQUAL(stats.pages, 4u);
+        BOOST_CHECK_EQUAL(stats.items, 4u);
+        BOOST_CHECK_EQUAL(stats.duplicates, 3u);
+        const auto text = out.str();
+        BOOST_CHECK_EQUAL(std::count(text.begin(), text.end(), '\n'), 4);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(FilterListing)
+{
+    // the score of each item is a tenth of its creation time
+    const std::string base = "https://oauth.reddit.com";
+    const std::vector<arcc::CassetteEntry> entries
+    {
+        listingEntry(base + "/r/a/new?limit=3&", "r/a", { { "t3_a1", 600 }, { "t3_a2", 100 }, { "t3_a3", 90 } }, "t3_a3"),
+        listingEntry(base + "/r/a/new?after=t3_a3&count=3&limit=3&", "r/a", { { "t3_a4", 80 }, { "t3_a5", 70 }, { "t3_a6", 60 } }, "t3_a6"),
+        listingEntry(base + "/r/a/new?after=t3_a6&count=6&limit=3&", "r/a", { { "t3_a7", 700 }, { "t3_a8", 650 }, { "t3_a9", 500 } }, ""),
+    };
+
+    auto session = replaySession(std::make_shared<arcc::ReplayTransport>(entries));
+
+    const auto names = [](const arcc::LinkPage& page)
+        {
+            std::vector<std::string> retval;
+            for (const auto& link : page) retval.emplace_back(link.name);
+            return retval;
+        };
+
+    using Names = std::vector<std::string>;
+
+    {
+        // keeps going through pages until it has enough matches
+        arcc::FilteredListing listing{ std::make_unique<arcc::Listing>(session, "/r/a/new", 3u),
+            arcc::LinkFilter{ "score >= 50" }, 2u };
+
+        BOOST_CHECK((names(listing.getFirstPage()) == Names{ "t3_a1", "t3_a7" }));
+        BOOST_CHECK_EQUAL(listing.scanned(), 3u);
+        BOOST_CHECK((names(listing.getNextPage()) == Names{ "t3_a8", "t3_a9" }));
+        BOOST_CHECK(listing.getNextPage().empty());
+
+        const auto previous = listing.getPreviousPage();
+        BOOST_CHECK((names(previous) == Names{ "t3_a1", "t3_a7" }));
+        BOOST_CHECK_EQUAL(previous.at(1).score, 70);
+        BOOST_CHECK(listing.getPreviousPage().empty());
+    }
+
+    {
+        // gives up on a page after too many without a match, and carries
+        // on from there on the next one
+        arcc::FilteredListing listing{ std::make_unique<arcc::Listing>(session, "/r/a/new", 3u),
+            arcc::LinkFilter{ "score >= 50" }, 2u };
+        listing.setMaxScan(1);
+
+        BOOST_CHECK((names(listing.getFirstPage()) == Names{ "t3_a1" }));
+        BOOST_CHECK_EQUAL(listing.scanned(), 2u);
+        BOOST_CHECK((names(listing.getNextPage()) == Names{ "t3_a7", "t3_a8" }));
+    }
+
+    {
+        // with no room for pages, going back filters everything up to it again
+        arcc::FilteredListing listing{ std::make_unique<arcc::Listing>(session, "/r/a/new", 3u),
+            arcc::LinkFilter{ "score >= 50" }, 2u };
+        listing.setCacheSize(0);
+
+        BOOST_CHECK((names(listing.getFirstPage()) == Names{ "t3_a1", "t3_a7" }));
+        BOOST_CHECK((names(listing.getNextPage()) == Names{ "t3_a8", "t3_a9" }));
+        BOOST_CHECK((names(listing.getPreviousPage()) == Names{ "t3_a1", "t3_a7" }));
+        BOOST_CHECK((names(listing.getNextPage()) == Names{ "t3_a8", "t3_a9" }));
+        BOOST_CHECK(listing.getNextPage().empty());
+    }
+
+    {
+        std::vector<std::uint32_t> indices;
+        arcc::Listing listing{ session, "/r/a/new", 3u };
+        BOOST_CHECK_EQUAL(arcc::LinkFilter{ "score < 10 || name == 't3_a1'" }.select(listing.getFirstPage(), indices), 2u);
+        BOOST_CHECK((indices == std::vector<std::uint32_t>{ 0, 2 }));
+    }
+}
+
+// a page of made up links, each scored `score` plus its index
+arcc::LinkPage storedPage(std::size_t count, std::int32_t score)
+{
+    arcc::LinkPage page;
+    for (std::size_t i = 0; i < count; i++)
+    {
+        arcc::Link link;
+        link.kind = "t3";
+        link.name = page.store(fmt::format("t3_p{}", i));
+        link.title = page.store(fmt::format("Post number {} with a title of a perfectly ordinary length", i));
+        link.url = page.store(fmt::format("https://example.com/{}", i));
+        link.author = "someone";
+        link.subreddit = "r/cpp";
+        link.score = score + static_cast<std::int32_t>(i);
+        link.created = 1546300800;
+        page.push_back(link);
+    }
+
+    return page;
+}
+
+BOOST_AUTO_TEST_CASE(SavePosts)
+{
+    const auto filename = (boost::filesystem::temp_directory_path()
+        / boost::filesystem::unique_path("arcc-%%%%-%%%%.posts")).string();
+
+    BOOST_CHECK_EQUAL(arcc::PostStore::key("/r/cpp/top", arcc::Params{ { "t", "day" }, { "limit", "2" }, { "after", "t3_x" } }),
+        "/r/cpp/top?t=day");
+
+    auto session = replaySession(std::make_shared<arcc::ReplayTransport>(_CASSETTE_FILE));
+    arcc::LinkPage fetched;
+
+    {
+        auto store = std::make_shared<arcc::PostStore>(filename);
+        arcc::Listing listing{ session, "/r/cpp/new", 2u };
+        listing.setStore(store);
+
+        fetched = listing.getFirstPage();
+        BOOST_REQUIRE_EQUAL(fetched.size(), 2u);
+
+        // only first pages are saved
+        listing.getNextPage();
+        BOOST_CHECK_EQUAL(store->stats().snapshots, 1u);
+        BOOST_CHECK_EQUAL(store->stats().links, 2u);
+    }
+
+    {
+        // still there after a restart
+        arcc::PostStore store{ filename };
+        const auto saved = store.get("/r/cpp/new", 10);
+        BOOST_REQUIRE(saved);
+        BOOST_REQUIRE_EQUAL(saved->page.size(), 2u);
+        BOOST_CHECK(saved->saved > 1546300800u);
+
+        for (std::size_t i = 0; i < fetched.size(); i++)
+        {
+            const auto& expected = fetched[i];
+            const auto& link = saved->page[i];
+
+            BOOST_CHECK_EQUAL(link.name, expected.name);
+            BOOST_CHECK_EQUAL(link.title, expected.title);
+            BOOST_CHECK_EQUAL(link.url, expected.url);
+            BOOST_CHECK_EQUAL(link.author, expected.author);
+            BOOST_CHECK_EQUAL(link.subreddit, expected.subreddit);
+            BOOST_CHECK_EQUAL(link.score, expected.score);
+            BOOST_CHECK_EQUAL(link.created, expected.created);
+        }
+
+        BOOST_CHECK_EQUAL(store.get("/r/cpp/new", 1)->page.size(), 1u);
+        BOOST_CHECK(!store.get("/r/cpp/hot", 10));
+
+        arcc::LinkPage page;
+        BOOST_CHECK(store.find(fetched[1].name, page));
+        BOOST_CHECK(!store.find("t3_missing", page));
+        BOOST_REQUIRE_EQUAL(page.size(), 1u);
+        BOOST_CHECK_EQUAL(page[0].title, fetched[1].title);
+    }
+
+    boost::filesystem::remove(filename);
+
+    {
+        arcc::PostStore store{ filename };
+
+        // links that have not changed are not written again
+        store.put("/r/cpp/hot", storedPage(100, 0), 1);
+        const auto first = store.stats().fileBytes;
+        store.put("/r/cpp/hot", storedPage(100, 0), 2);
+        const auto second = store.stats().fileBytes;
+        BOOST_CHECK_LT(second - first, 1024u);
+
+        store.put("/r/cpp/hot", storedPage(100, 1), 3);
+        store.put("/r/cpp/new", storedPage(50, 1), 3);
+        BOOST_CHECK_EQUAL(store.stats().links, 100u);
+        BOOST_CHECK_LT(store.stats().liveBytes, store.stats().fileBytes);
+
+        store.compact();
+        BOOST_CHECK_EQUAL(store.stats().liveBytes, store.stats().fileBytes);
+        BOOST_CHECK_EQUAL(store.get("/r/cpp/hot", 100)->page[99].score, 100);
+        BOOST_CHECK_EQUAL(store.get("/r/cpp/new", 100)->page.size(), 50u);
+        BOOST_CHECK_EQUAL(store.get("/r/cpp/new", 100)->saved, 3u);
+
+        // the file is compacted on its own as it grows
+        for (std::int32_t i = 0; i < 200; i++)
+        {
+            store.put("/r/cpp/hot", storedPage(100, i), 4);
+        }
+
+        BOOST_CHECK_LT(store.stats().fileBytes, arcc::PostStore::MIN_COMPACT_SIZE + 64 * 1024);
+        BOOST_CHECK_EQUAL(store.get("/r/cpp/hot", 1)->page[0].score, 199);
+    }
+
+    {
+        // a write cut short is dropped rather than read
+        const auto size = boost::filesystem::file_size(filename);
+        std::ofstream{ filename, std::ios::binary | std::ios::app } << "half a record";
+
+        arcc::PostStore store{ filename };
+        BOOST_CHECK_EQUAL(store.stats().fileBytes, size);
+        BOOST_CHECK_EQUAL(boost::filesystem::file_size(filename), size);
+        BOOST_CHECK_EQUAL(store.get("/r/cpp/new", 100)->page.size(), 50u);
+
+        store.put("/r/cpp/new", storedPage(10, 7), 5);
+        BOOST_CHECK_EQUAL(arcc::PostStore{ filename }.get("/r/cpp/new", 100)->page[9].score, 16);
+    }
+
+    boost::filesystem::remove(filename);
+
+    {
+        // a file that is not a store is left alone
+        std::ofstream{ filename } << "someone else's file, which is long enough";
+        BOOST_CHECK_THROW(arcc::PostStore{ filename }, std::runtime_error);
+        BOOST_CHECK_EQUAL(boost::filesystem::file_size(filename), 41u);
+    }
+
+    boost::filesystem::remove(filename);
+}
+
+BOOST_AUTO_TEST_CASE(FilterSavedListing)
+{
+    const auto filename = (boost::filesystem::temp_directory_path()
+        / boost::filesystem::unique_path("arcc-%%%%-%%%%.posts")).string();
+
+    const std::string base = "https://oauth.reddit.com";
+    const std::vector<arcc::CassetteEntry> entries
+    {
+        listingEntry(base + "/r/a/new?limit=3&", "r/a", { { "t3_a1", 600 }, { "t3_a2", 100 }, { "t3_a3", 90 } }, ""),
+    };
+
+    auto session = replaySession(std::make_shared<arcc::ReplayTransport>(entries));
+    auto store = std::make_shared<arcc::PostStore>(filename);
+
+    // what `list` saved earlier, unfiltered
+    store->put("/r/a/new", storedPage(2, 5), 1546300800);
+
+    {
+        auto inner = std::make_unique<arcc::Listing>(session, "/r/a/new", 3u);
+        inner->setStore(store);
+
+        arcc::FilteredListing listing{ std::move(inner), arcc::LinkFilter{ "score >= 50" }, 2u };
+        const auto page = listing.getFirstPage();
+        BOOST_REQUIRE_EQUAL(page.size(), 1u);
+        BOOST_CHECK_EQUAL(page.at(0).name, "t3_a1");
+    }
+
+    // the filtered listing left the saved page alone
+    const auto saved = store->get("/r/a/new", 10);
+    BOOST_REQUIRE(saved);
+    BOOST_REQUIRE_EQUAL(saved->page.size(), 2u);
+    BOOST_CHECK_EQUAL(saved->page.at(0).name, "t3_p0");
+    BOOST_CHECK_EQUAL(saved->saved, 1546300800u);
+
+    store.reset();
+    boost::filesystem::remove(filename);
+}
+
+// the fullnames of a page, in order
+std::vector<std::string> names(const arcc::LinkPage& page)
+{
+    std::vector<std::string> retval;
+    for (const auto& link : page)
+    {
+        retval.emplace_back(link.name);
+    }
+
+    return retval;
+}
+
+BOOST_AUTO_TEST_CASE(SearchPosts)
+{
+    using Names = std::vector<std::string>;
+
+    arcc::LinkPage page;
+    const auto post = [&page](const std::string& name, const std::string& title, const std::string& selftext,
+        const char* flair = "")
+        {
+            arcc::Link link;
+            link.kind = "t3";
+            link.name = page.store(name);
+            link.title = page.store(title);
+            link.selftext = page.store(selftext);
+            link.url = page.store("https://example.com/" + name);
+            link.author = "someone";
+            link.subreddit = "r/cpp";
+            link.flair = flair;
+            link.score = 1;
+            page.push_back(link);
+        };
+
+    post("t3_s1", "Async Rust is hard", "");
+    post("t3_s2", "Why I moved to C++", "I used rust for a year", "Discussion");
+    post("t3_s3", "TOKIO 1.0 released", "async runtime for Rust");
+    post("t3_s4", "Learning C#", "coming from c++ and java");
+    post("t3_s5", "Asynchronous C++ with coroutines", "");
+
+    auto index = std::make_shared<arcc::SearchIndex>();
+    BOOST_CHECK(!index->modified());
+    index->add(page);
+    BOOST_CHECK_EQUAL(index->size(), 5u);
+    BOOST_CHECK(index->modified());
+
+    const auto search = [&index](std::string_view query)
+        {
+            const auto result = index->search(query);
+            return names(index->links(result.docs));
+        };
+
+    // the title counts for more than the self text, newer breaks a tie
+    BOOST_CHECK(search("rust") == (Names{ "t3_s1", "t3_s3", "t3_s2" }));
+    BOOST_CHECK(search("RUST async") == (Names{ "t3_s1", "t3_s3" }));
+    BOOST_CHECK(search("c++") == (Names{ "t3_s5", "t3_s2", "t3_s4" }));
+    BOOST_CHECK(search("c#") == (Names{ "t3_s4" }));
+    BOOST_CHECK(search("discussion") == (Names{ "t3_s2" }));
+    BOOST_CHECK(search("async*").size() == 3u);
+    BOOST_CHECK(search("tokio OR coroutines") == (Names{ "t3_s5", "t3_s3" }));
+    BOOST_CHECK(search("rust -tokio") == (Names{ "t3_s1", "t3_s2" }));
+    BOOST_CHECK(search("rust NOT async") == (Names{ "t3_s2" }));
+    BOOST_CHECK(search("cpp c++ OR rust java") == (Names{ "t3_s4" }));
+    BOOST_CHECK(search("go").empty());
+    BOOST_CHECK(search("nothing*").empty());
+
+    BOOST_CHECK_THROW(index->search(""), std::invalid_argument);
+    BOOST_CHECK_THROW(index->search("-rust"), std::invalid_argument);
+    BOOST_CHECK_THROW(index->search("a"), std::invalid_argument);
+    BOOST_CHECK_THROW(index->search("rust OR"), std::invalid_argument);
+    BOOST_CHECK_THROW(index->search("OR rust"), std::invalid_argument);
+    BOOST_CHECK_THROW(index->search("rust OR -tokio"), std::invalid_argument);
+    BOOST_CHECK_THROW(index->search("rust NOT"), std::invalid_argument);
+
+    std::vector<std::string> words;
+    arcc::SearchIndex::forEachWord("Don't use CMake-GUI, use c++20!", [&](std::string_view w) { words.emplace_back(w); });
+    BOOST_CHECK(words == (Names{ "don", "use", "cmake", "gui", "use", "c++", "20" }));
+
+    // a link seen again shows what it is now, but is still one document
+    {
+        arcc::Link link = page[0];
+        link.score = 42;
+        BOOST_CHECK(!index->add(link));
+        BOOST_CHECK_EQUAL(index->size(), 5u);
+
+        const auto result = index->search("hard");
+        BOOST_REQUIRE_EQUAL(result.docs.size(), 1u);
+        BOOST_CHECK_EQUAL(index->links(result.docs)[0].score, 42);
+        BOOST_CHECK_EQUAL(index->links(result.docs)[0].title, "Async Rust is hard");
+    }
+
+    const auto filename = (boost::filesystem::temp_directory_path()
+        / boost::filesystem::unique_path("arcc-%%%%-%%%%.search")).string();
+
+    // nothing there yet is an empty index
+    arcc::SearchIndex loaded;
+    loaded.load(filename);
+    BOOST_CHECK_EQUAL(loaded.size(), 0u);
+
+    index->save(filename);
+    BOOST_CHECK(!index->modified());
+
+    loaded.load(filename);
+    BOOST_CHECK_EQUAL(loaded.size(), 5u);
+    BOOST_CHECK(!loaded.modified());
+    BOOST_CHECK(names(loaded.links(loaded.search("rust").docs)) == (Names{ "t3_s1", "t3_s3", "t3_s2" }));
+    BOOST_CHECK_EQUAL(loaded.links(loaded.search("hard").docs)[0].score, 42);
+    BOOST_CHECK_EQUAL(loaded.stats().words, index->stats().words);
+
+    // and it goes on from where it was
+    {
+        arcc::LinkPage more;
+        arcc::Link link;
+        link.name = more.store("t3_s6");
+        link.title = more.store("Rust 2021 edition");
+        BOOST_CHECK(loaded.add(link));
+        BOOST_CHECK(!loaded.add(link));
+        BOOST_CHECK_EQUAL(loaded.search("rust").docs.front(), 5u);
+    }
+
+    {
+        // damage is noticed rather than read
+        std::string data;
+        {
+            std::ifstream in{ filename, std::ios::binary };
+            data.assign(std::istreambuf_iterator<char>{ in }, std::istreambuf_iterator<char>{});
+        }
+
+        std::ofstream{ filename, std::ios::binary | std::ios::trunc } << data.substr(0, data.size() - 3);
+        BOOST_CHECK_THROW(loaded.load(filename), std::runtime_error);
+        BOOST_CHECK_EQUAL(loaded.size(), 6u);
+
+        std::ofstream{ filename, std::ios::binary | std::ios::trunc } << "someone else's file";
+        BOOST_CHECK_THROW(loaded.load(filename), std::runtime_error);
+    }
+
+    boost::filesystem::remove(filename);
+
+    // listings add what they fetch
+    auto session = replaySession(std::make_shared<arcc::ReplayTransport>(_CASSETTE_FILE));
+    auto fetched = std::make_shared<arcc::SearchIndex>();
+
+    arcc::Listing listing{ session, "/r/cpp/new", 2u };
+    listing.setIndex(fetched);
+    listing.getFirstPage();
+    listing.getNextPage();
+    BOOST_CHECK_EQUAL(fetched->size(), 3u);
+    BOOST_CHECK(names(fetched->links(fetched->search("first post").docs)) == (Names{ "t3_a1" }));
+
+    // results are paged like any other listing
+    arcc::LinkPage many;
+    for (std::size_t i = 0; i < 25; i++)
+    {
+        arcc::Link link;
+        link.name = many.store(fmt::format("t3_m{}", i));
+        link.title = many.store(fmt::format("Weekly thread {}", i));
+        many.push_back(link);
+    }
+
+    fetched->add(many);
+
+    arcc::SearchListing results{ fetched, "weekly", 10 };
+    BOOST_CHECK_EQUAL(results.matches(), 25u);
+    BOOST_CHECK_EQUAL(results.getFirstPage().size(), 10u);
+    BOOST_CHECK_EQUAL(results.getNextPage().size(), 10u);
+    BOOST_CHECK_EQUAL(results.getNextPage().size(), 5u);
+    BOOST_CHECK(results.getNextPage().empty());
+    BOOST_CHECK_EQUAL(results.getPreviousPage()[0].name, "t3_m14");
+    BOOST_CHECK_EQUAL(results.refresh()[0].name, "t3_m24");
+    BOOST_CHECK(results.getPreviousPage().empty());
+    BOOST_CHECK_THROW(arcc::SearchListing(fetched, "-weekly", 10), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(WatchSubreddits)
+{
+    const std::string base = "https://oauth.reddit.com/r/a+b/new";
+    const std::vector<arcc::CassetteEntry> entries
+    {
+        listingEntry(base + "?limit=10&", "r/a", { { "t3_a2", 200 }, { "t3_b1", 150 } }, ""),
+        listingEntry(base + "?limit=10&", "r/a", { { "t3_c1", 400 }, { "t3_b2", 300 }, { "t3_a3", 250 } }, ""),
+        listingEntry(base + "?before=t3_a2&limit=100&", "r/b", { { "t3_b2", 300 }, { "t3_a3", 250 } }, ""),
+        listingEntry(base + "?before=t3_b2&limit=100&", "r/a", {}, ""),
+    };
+
+    auto session = replaySession(std::make_shared<arcc::ReplayTransport>(entries));
+    auto index = std::make_shared<arcc::SearchIndex>();
+
+    const auto start = arcc::Watcher::Clock::now();
+    const std::chrono::seconds interval{ 30 };
+
+    arcc::Watcher watcher{ session, { "a", "/r/b" }, interval, start };
+    watcher.setIndex(index);
+    BOOST_CHECK_EQUAL(watcher.groups(), 1u);
+    BOOST_CHECK(watcher.endpoints() == std::vector<std::string>{ "/r/a+b/new" });
+    BOOST_CHECK(watcher.nextPoll() == start);
+
+    const auto names = [](const arcc::LinkPage& page)
+        {
+            std::vector<std::string> retval;
+            for (const auto& link : page) retval.emplace_back(link.name);
+            return retval;
+        };
+
+    using Names = std::vector<std::string>;
+
+    // what is there to begin with is not new
+    BOOST_CHECK(watcher.poll(start).empty());
+    BOOST_CHECK(watcher.nextPoll() == start + interval);
+    BOOST_CHECK(watcher.poll(start + interval / 2).empty());
+    BOOST_CHECK_EQUAL(watcher.stats().requests, 1u);
+
+    // after that only what came since, oldest first
+    BOOST_CHECK((names(watcher.poll(start + interval)) == Names{ "t3_a3", "t3_b2" }));
+    BOOST_CHECK_EQUAL(watcher.stats().requests, 2u);
+    BOOST_CHECK_EQUAL(watcher.stats().items, 2u);
+    BOOST_CHECK_EQUAL(index->size(), 4u);
+
+    // a group that stays quiet starts over, and what was seen is not new
+    auto now = start + interval;
+    for (std::size_t i = 1; i < arcc::Watcher::RESYNC_POLLS; i++)
+    {
+        now += interval;
+        BOOST_CHECK(watcher.poll(now).empty());
+    }
+
+    now += interval;
+    BOOST_CHECK((names(watcher.poll(now)) == Names{ "t3_c1" }));
+    BOOST_CHECK_EQUAL(watcher.stats().resyncs, 1u);
+    BOOST_CHECK_EQUAL(watcher.stats().errors, 0u);
+    BOOST_CHECK_EQUAL(watcher.stats().items, 3u);
+
+    // many subreddits share a few requests that take turns, and an interval
+    // too short for them is stretched
+    std::vector<std::string> many;
+    for (std::size_t i = 0; i < 120; i++) many.push_back(fmt::format("s{}", i));
+
+    arcc::Watcher crowd{ session, many, std::chrono::seconds{ 1 }, start };
+    BOOST_CHECK_EQUAL(crowd.groups(), 3u);
+    BOOST_CHECK(crowd.interval() == arcc::Watcher::minimumInterval(3));
+    BOOST_CHECK(crowd.interval() > std::chrono::seconds{ 1 });
+    BOOST_CHECK(boost::starts_with(crowd.endpoints()[1], "/r/s50+s51+"));
+
+    arcc::Watcher spread{ std::weak_ptr<arcc::RedditSession>{}, many, std::chrono::seconds{ 30 }, start };
+    BOOST_CHECK(spread.interval() == std::chrono::seconds{ 30 });
+    BOOST_CHECK(spread.poll(start).empty());
+    BOOST_CHECK(spread.nextPoll() == start + std::chrono::seconds{ 10 });
+}
+
+BOOST_AUTO_TEST_CASE(ReplayLatency)
+{
+    auto replay = std::make_shared<arcc::ReplayTransport>(_CASSETTE_FILE);
+    replay->setLatency(std::chrono::milliseconds{ 20 });
+
+    auto session = replaySession(replay);
+    const auto start = std::chrono::steady_clock::now();
+
+    arcc::Listing listing{ session, "/r/cpp/new", 2u };
+    BOOST_CHECK_EQUAL(listing.getFirstPage().size(), 2u);
+    BOOST_CHECK(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds{ 20 });
+}
+
+BOOST_AUTO_TEST_CASE(PrefetchNextPage)
+{
+    auto replay = std::make_shared<arcc::ReplayTransport>(_CASSETTE_FILE);
+    replay->setLatency(std::chrono::milliseconds{ 50 });
+    auto session = replaySession(replay);
+
+    arcc::Listing listing{ session, "/r/cpp/new", 2u };
+    listing.setPrefetchDepth(1);
+    BOOST_REQUIRE_EQUAL(listing.getFirstPage().size(), 2u);
+
+    // give the worker time to bring in the next page
+    std::this_thread::sleep_for(std::chrono::milliseconds{ 200 });
+
+    const auto start = std::chrono::steady_clock::now();
+    auto page = listing.getNextPage();
+    BOOST_CHECK(std::chrono::steady_clock::now() - start < std::chrono::milliseconds{ 50 });
+
+    BOOST_REQUIRE_EQUAL(page.size(), 1u);
+    BOOST_CHECK_EQUAL(page.at(0).name, "t3_a3"s);
+    BOOST_CHECK(listing.getNextPage().empty());
+}
+
+BOOST_AUTO_TEST_CASE(CancelPrefetch)
+{
+    auto replay = std::make_shared<arcc::ReplayTransport>(_CASSETTE_FILE);
+    replay->setLatency(std::chrono::milliseconds{ 50 });
+    auto session = replaySession(replay);
+
+    arcc::Listing listing{ session, "/r/cpp/new", 2u };
+    listing.setPrefetchDepth(2);
+    BOOST_REQUIRE_EQUAL(listing.getFirstPage().size(), 2u);
+    listing.cancelPrefetch();
+
+    // nothing was kept, so the page comes straight from the transport
+    auto page = listing.getNextPage();
+    BOOST_REQUIRE_EQUAL(page.size(), 1u);
+    BOOST_CHECK_EQUAL(page.at(0).name, "t3_a3"s);
+}
+
+BOOST_AUTO_TEST_CASE(PageCache)
+{
+    auto replay = std::make_shared<arcc::ReplayTransport>(_CASSETTE_FILE);
+    replay->setLatency(std::chrono::milliseconds{ 50 });
+    auto session = replaySession(replay);
+
+    arcc::Listing listing{ session, "/r/cpp/new", 2u };
+    listing.setPrefetchDepth(0);
+    BOOST_REQUIRE_EQUAL(listing.getFirstPage().size(), 2u);
+    BOOST_REQUIRE_EQUAL(listing.getNextPage().size(), 1u);
+
+    // both directions are served from memory once a page has been shown
+    auto start = std::chrono::steady_clock::now();
+    auto page = listing.getPreviousPage();
+    BOOST_REQUIRE_EQUAL(page.size(), 2u);
+    BOOST_CHECK_EQUAL(page.at(0).name, "t3_a1"s);
+    BOOST_CHECK_EQUAL(listing.after(), "t3_a2"s);
+
+    page = listing.getNextPage();
+    BOOST_REQUIRE_EQUAL(page.size(), 1u);
+    BOOST_CHECK_EQUAL(page.at(0).name, "t3_a3"s);
+    BOOST_CHECK(std::chrono::steady_clock::now() - start < std::chrono::milliseconds{ 50 });
+
+    // a refresh always goes back to reddit
+    start = std::chrono::steady_clock::now();
+    page = listing.refresh();
+    BOOST_REQUIRE_EQUAL(page.size(), 1u);
+    BOOST_CHECK_EQUAL(page.at(0).name, "t3_a3"s);
+    BOOST_CHECK(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds{ 50 });
+
+    // a cache with no room behaves as before
+    arcc::Listing uncached{ session, "/r/cpp/new", 2u };
+    uncached.setCacheSize(0);
+    BOOST_REQUIRE_EQUAL(uncached.getFirstPage().size(), 2u);
+    BOOST_REQUIRE_EQUAL(uncached.getNextPage().size(), 1u);
+    BOOST_CHECK(uncached.getPreviousPage().empty());
+}
+
+BOOST_AUTO_TEST_CASE(ConcurrentRequests)
+{
+    // a generous rate limit so the limiter stays out of the way
+    auto entries = arcc::loadCassette(_CASSETTE_FILE);
+    for (auto& entry : entries)
+    {
+        entry.headers["x-ratelimit-remaining"] = "100000";
+        entry.headers["x-ratelimit-reset"] = "1";
+    }
+
+    auto replay = std::make_shared<arcc::ReplayTransport>(entries);
+    replay->setLatency(std::chrono::milliseconds{ 2 });
+    auto session = replaySession(replay);
+
+    std::atomic_int failures = 0;
+    std::vector<std::thread> workers;
+
+    for (auto i = 0; i < 8; i++)
+    {
+        workers.emplace_back([session, i, &failures]()
+            {
+                for (auto j = 0; j < 20; j++)
+                {
+                    const auto listing = arcc::decodeListing((i + j) % 2 == 0
+                        ? session->doGetRequest("/r/cpp/new", arcc::Params{ {"limit", "2"} })
+                        : session->doGetRequest("/r/cpp/new", arcc::Params{ {"after", "t3_a2"}, {"count", "2"}, {"limit", "2"} }));
+
+                    const auto expected = (i + j) % 2 == 0 ? 2u : 1u;
+                    if (!listing || listing->children.size() != expected)
+                    {
+                        ++failures;
+                    }
+
+                    session->setLocation(fmt::format("/r/worker{}", i));
+                }
+            });
+    }
+
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+
+    BOOST_CHECK_EQUAL(failures, 0);
+    BOOST_CHECK(boost::algorithm::starts_with(session->location(), "/r/worker"));
+}
+
+BOOST_AUTO_TEST_CASE(BackgroundRefresh)
+{
+    // one second left on the token and a five second margin, so the
+    // refresher has to renew it as soon as the session is used
+    auto session = std::make_shared<arcc::RedditSession>("token", "refresh", 10.0, std::time(nullptr) - 9);
+    session->setTransport(std::make_shared<arcc::ReplayTransport>(_CASSETTE_FILE));
+    session->setRefreshMargin(std::chrono::seconds{ 5 });
+
+    std::atomic_int saved = 0;
+    session->setRefreshCallback([&saved]() { ++saved; });
+
+    arcc::Listing listing{ session, "/r/cpp/new", 2u };
+    BOOST_CHECK_EQUAL(listing.getFirstPage().size(), 2u);
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{ 5 };
+    while (saved == 0 && std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds{ 10 });
+    }
+
+    BOOST_CHECK_EQUAL(saved, 1);
+    BOOST_CHECK_EQUAL(session->accessToken(), "renewed-token"s);
+    BOOST_CHECK_EQUAL(session->expiry(), 3600.0);
+    BOOST_CHECK(session->loggedIn());
+}
+
+BOOST_AUTO_TEST_CASE(FailedRefresh)
+{
+    const std::string tokenUrl = "https://www.reddit.com/api/v1/access_token";
+    const std::string refresh = "grant_type=refresh_token&refresh_token=refresh";
+
+    const auto refreshed = [&](long status, const std::string& data)
+        {
+            arcc::CassetteEntry entry;
+            entry.method = arcc::Transport::Method::POST;
+            entry.url = tokenUrl;
+            entry.payload = refresh;
+            entry.status = status;
+            entry.data = data;
+
+            auto replay = std::make_shared<arcc::ReplayTransport>(std::vector<arcc::CassetteEntry>{ entry,
+                listingEntry("https://oauth.reddit.com/r/a/new?limit=2&", "r/a", { { "t3_a1", 100 } }, "") });
+
+            // one second left on the token and a five second margin
+            auto session = std::make_shared<arcc::RedditSession>("token", "refresh", 10.0, std::time(nullptr) - 9);
+            session->setTransport(replay);
+            session->setRefreshMargin(std::chrono::seconds{ 5 });
+
+            arcc::Listing listing{ session, "/r/a/new", 2u };
+            BOOST_CHECK_EQUAL(listing.getFirstPage().size(), 1u);
+
+            const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{ 5 };
+            while (replay->played(arcc::Transport::Method::POST, tokenUrl, refresh) == 0
+                && std::chrono::steady_clock::now() < deadline)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds{ 10 });
+            }
+
+            // let the refresher take in the reply
+            std::this_thread::sleep_for(std::chrono::milliseconds{ 100 });
+            BOOST_CHECK_EQUAL(replay->played(arcc::Transport::Method::POST, tokenUrl, refresh), 1u);
+
+            return session;
+        };
+
+    // the token still works, so a failed early refresh changes nothing
+    auto session = refreshed(503, "");
+    BOOST_CHECK(session->loggedIn());
+    BOOST_CHECK_EQUAL(session->accessToken(), "token"s);
+
+    session = refreshed(200, R"({"error": "temporarily_unavailable"})");
+    BOOST_CHECK(session->loggedIn());
+
+    // a refresh token reddit no longer takes is the end of the session
+    session = refreshed(400, "");
+    BOOST_CHECK(!session->loggedIn());
+
+    session = refreshed(200, R"({"error": "invalid_grant"})");
+    BOOST_CHECK(!session->loggedIn());
+}
+
+BOOST_AUTO_TEST_CASE(ReplayUnknownRequest)
+{
+    arcc::ReplayTransport replay{ _CASSETTE_FILE };
+    BOOST_CHECK_THROW(replay.doRequest("https://oauth.reddit.com/r/unknown"), arcc::WebClientError);
+}
+
+BOOST_AUTO_TEST_CASE(RecordRoundTrip)
+{
+    const auto filename = (boost::filesystem::temp_directory_path()
+        / boost::filesystem::unique_path("arcc-%%%%-%%%%.cassette")).string();
+
+    {
+        auto recorder = std::make_shared<arcc::RecordingTransport>(
+            std::make_shared<arcc::ReplayTransport>(_CASSETTE_FILE), filename);
+
+        auto session = replaySession(recorder);
+        arcc::Listing listing{ session, "/r/cpp/new", 2u };
+        listing.getFirstPage();
+        listing.getNextPage();
+    }
+
+    const auto recorded = arcc::loadCassette(filename);
+    boost::filesystem::remove(filename);
+
+    BOOST_REQUIRE_EQUAL(recorded.size(), 2u);
+    BOOST_CHECK_EQUAL(recorded.at(0).url, "https://oauth.reddit.com/r/cpp/new?limit=2&"s);
+    BOOST_CHECK_EQUAL(recorded.at(0).status, 200);
+    BOOST_CHECK_EQUAL(recorded.at(0).headers.at("x-ratelimit-used"), "2"s);
+
+    // the streamed body was captured whole
+    const auto json = nlohmann::json::parse(recorded.at(1).data);
+    BOOST_CHECK_EQUAL(json.at("data").at("children").size(), 1u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
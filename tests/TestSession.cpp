@@ -65,8 +65,8 @@ BOOST_AUTO_TEST_CASE(testWeirdEndPoints)
         arcc::Listing::Page page = listing.getFirstPage();
 
         BOOST_REQUIRE(page.size() > 0);
-        BOOST_REQUIRE_EQUAL(page.at(0).at("data").at("name"), "t3_z1c9z"s);
-        BOOST_REQUIRE_EQUAL(page.at(1).at("data").at("name"), "t3_7eojwf"s);
+        BOOST_REQUIRE_EQUAL(page.at(0).name, "t3_z1c9z"s);
+        BOOST_REQUIRE_EQUAL(page.at(1).name, "t3_7eojwf"s);
     }
 }
 
@@ -77,10 +77,9 @@ void testSubPages(const arcc::Listing::Page& otherpage,
     std::size_t baseIdx = baseOffset;
     for (const auto& item : otherpage)
     {
-        const auto& bigitem = basepage.at(baseIdx).at("data");
-        BOOST_REQUIRE(item.find("data") != item.end());
-        BOOST_REQUIRE(!item["data"].value("name", "").empty());
-        BOOST_REQUIRE_EQUAL(item["data"]["name"], bigitem["name"]);
+        const auto& bigitem = basepage.at(baseIdx);
+        BOOST_REQUIRE(!item.name.empty());
+        BOOST_REQUIRE_EQUAL(item.name, bigitem.name);
         baseIdx++;
     }
 }
@@ -143,8 +142,8 @@ BOOST_AUTO_TEST_CASE(testHotSubListing)
     arcc::Listing::Page page = listing.getFirstPage();
 
     BOOST_REQUIRE(page.size() > 0);
-    BOOST_REQUIRE_EQUAL(page.at(0).at("data").at("name"), "t3_z1c9z"s);
-    BOOST_REQUIRE_EQUAL(page.at(1).at("data").at("name"), "t3_7eojwf"s); 
+    BOOST_REQUIRE_EQUAL(page.at(0).name, "t3_z1c9z"s);
+    BOOST_REQUIRE_EQUAL(page.at(1).name, "t3_7eojwf"s); 
 }
 
 BOOST_AUTO_TEST_SUITE_END() // Session
@@ -164,8 +163,8 @@ BOOST_AUTO_TEST_CASE(testGuestHotSubList)
     arcc::Listing::Page page = listing.getFirstPage();
 
     BOOST_REQUIRE(page.size() > 0);
-    BOOST_REQUIRE_EQUAL(page.at(0).at("data").at("name"), "t3_z1c9z"s);
-    BOOST_REQUIRE_EQUAL(page.at(1).at("data").at("name"), "t3_7eojwf"s); 
+    BOOST_REQUIRE_EQUAL(page.at(0).name, "t3_z1c9z"s);
+    BOOST_REQUIRE_EQUAL(page.at(1).name, "t3_7eojwf"s); 
 }
 
 BOOST_AUTO_TEST_SUITE_END() // GuestSession
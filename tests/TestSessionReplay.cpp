@@ -0,0 +1,155 @@
+#include <boost/test/unit_test.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/iterator/transform_iterator.hpp>
+#include <boost/range/adaptor/transformed.hpp>
+
+#include <nlohmann/json.hpp>
+
+#include "../arcc/Cassette.h"
+#include "../arcc/ConsoleApp.h"
+#include "../arcc/RedditSession.h"
+
+using namespace std::string_literals;
+
+BOOST_AUTO_TEST_SUITE(SessionReplay)
+
+#ifndef _SESSION_CASSETTE
+#   error "_SESSION_CASSETTE not defined, session unit tests cannot run"
+#endif
+
+// a logged in session that answers from the recorded session traffic, its
+// token is fresh so nothing asks for a new one
+std::shared_ptr<arcc::RedditSession> loadSession()
+{
+    auto session = std::make_shared<arcc::RedditSession>("token", "refresh", 3600.0, std::time(nullptr));
+    session->setTransport(std::make_shared<arcc::ReplayTransport>(_SESSION_CASSETTE));
+    return session;
+}
+
+BOOST_AUTO_TEST_CASE(TestWhoAmI)
+{
+    auto session = loadSession();
+
+    const auto jsontext = session->doGetRequest("/api/v1/me");
+    BOOST_REQUIRE(!jsontext.empty());
+
+    nlohmann::json j = nlohmann::json::parse(jsontext);
+    BOOST_CHECK_EQUAL(j.value("name", ""), "arcc_tester");
+}
+
+BOOST_AUTO_TEST_CASE(testWeirdEndPoints)
+{
+    const std::vector<std::string> endpoints =
+    {
+        "/r/IAmA/top", "/r/IAmA/top/", "r/IAmA/top", "r/IAmA/top/"
+    };
+
+    auto session = loadSession();
+
+    for (const auto& endpoint : endpoints)
+    {
+        arcc::Params params{ {"t", "all"} };
+        arcc::Listing listing{ session, endpoint , 2u, params };
+        arcc::Listing::Page page = listing.getFirstPage();
+
+        BOOST_REQUIRE(page.size() > 0);
+        BOOST_REQUIRE_EQUAL(page.at(0).name, "t3_z1c9z"s);
+        BOOST_REQUIRE_EQUAL(page.at(1).name, "t3_7eojwf"s);
+    }
+}
+
+void testSubPages(const arcc::Listing::Page& otherpage, 
+    const arcc::Listing::Page& basepage, 
+    std::size_t baseOffset)
+{
+    std::size_t baseIdx = baseOffset;
+    for (const auto& item : otherpage)
+    {
+        const auto& bigitem = basepage.at(baseIdx);
+        BOOST_REQUIRE(!item.name.empty());
+        BOOST_REQUIRE_EQUAL(item.name, bigitem.name);
+        baseIdx++;
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testNewSubListing)
+{
+    constexpr auto endpoint = "r/Omnism/new/";
+
+    auto session = loadSession();
+
+    arcc::Listing biglist{ session, endpoint, 24u };
+    arcc::Listing::Page bigpage = biglist.getFirstPage();
+    BOOST_REQUIRE_EQUAL(bigpage.size(), 24u);
+    BOOST_REQUIRE(biglist.before().empty());
+    BOOST_REQUIRE(!biglist.after().empty());
+
+    arcc::Listing listing{ session, endpoint, 4u };
+
+    // test the first page
+    arcc::Listing::Page page = listing.getFirstPage();
+    testSubPages(page, bigpage, 0u);
+
+    // test the second page
+    page = listing.getNextPage();
+    testSubPages(page, bigpage, 4u);
+
+    // go back a page
+    page = listing.getPreviousPage();
+    testSubPages(page, bigpage, 0u);
+
+    // go forward two pages
+    listing.getNextPage();
+    page = listing.getNextPage();
+    testSubPages(page, bigpage, 8u);
+
+    // go back two pages
+    listing.getPreviousPage();
+    page = listing.getPreviousPage();
+    testSubPages(page, bigpage, 0u);
+
+    // go fwd three pages
+    listing.getNextPage();
+    listing.getNextPage();
+    page = listing.getNextPage();
+    testSubPages(page, bigpage, 12u);
+}
+
+BOOST_AUTO_TEST_CASE(testHotSubListing)
+{
+    auto session = loadSession();
+
+    // Based off of this post: http://shorturl.at/btwH4, we know that
+    // the all time top voted thread was Obama's AMA
+    arcc::Params params{ {"t", "all"} };
+    arcc::Listing listing{ session, "/r/IAmA/top" , 5u, params };
+    arcc::Listing::Page page = listing.getFirstPage();
+
+    BOOST_REQUIRE(page.size() > 0);
+    BOOST_REQUIRE_EQUAL(page.at(0).name, "t3_z1c9z"s);
+    BOOST_REQUIRE_EQUAL(page.at(1).name, "t3_7eojwf"s); 
+}
+
+BOOST_AUTO_TEST_SUITE_END() // SessionReplay
+
+
+BOOST_AUTO_TEST_SUITE(GuestSessionReplay)
+
+BOOST_AUTO_TEST_CASE(testGuestHotSubList)
+{
+    // create default guest session, which asks for a token of its own
+    auto session = std::make_shared<arcc::RedditSession >(); 
+    session->setTransport(std::make_shared<arcc::ReplayTransport>(_SESSION_CASSETTE));
+
+    // Based off of this post: http://shorturl.at/btwH4, we know that
+    // the all time top voted thread was Obama's AMA
+    arcc::Params params{ {"t", "all"} };
+    arcc::Listing listing{ session, "/r/IAmA/top" , 5u, params };
+    arcc::Listing::Page page = listing.getFirstPage();
+
+    BOOST_REQUIRE(page.size() > 0);
+    BOOST_REQUIRE_EQUAL(page.at(0).name, "t3_z1c9z"s);
+    BOOST_REQUIRE_EQUAL(page.at(1).name, "t3_7eojwf"s); 
+}
+
+BOOST_AUTO_TEST_SUITE_END() // GuestSessionReplay
@@ -1,10 +1,29 @@
 #include <boost/test/unit_test.hpp>
 #include <boost/filesystem.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <thread>
+
+#include <nlohmann/json.hpp>
+
 #include "../arcc/SimpleArgs.h"
 #include "../arcc/CommandHistory.h"
 #include "../arcc/utils.h"
 #include "../arcc/Settings.h"
+#include "../arcc/BufferPool.h"
+#include "../arcc/NetStats.h"
+#include "../arcc/RateLimiter.h"
+#include "../arcc/SingleFlight.h"
+#include "../arcc/Snapshot.h"
+#include "../arcc/LruCache.h"
+#include "../arcc/TimerWheel.h"
+#include "../arcc/JsonIndex.h"
+#include "../arcc/FlatJson.h"
+#include "../arcc/StringPool.h"
+#include "../arcc/SeenSet.h"
+#include "../arcc/LinkFilter.h"
 
 using namespace std::string_literals;
 
@@ -87,6 +106,13 @@ BOOST_AUTO_TEST_CASE(SimpleArgs)
     BOOST_CHECK_EQUAL(args.getTokenCount(), 3u);
     BOOST_CHECK_EQUAL(args.getPositionalCount(), 1u);
     BOOST_CHECK_EQUAL(args.getNamedCount(), 2u);
+
+    // a quote is only closed by the character that opened it
+    args.clear();
+    args.parse(R"(list --where='flair ~ "Discussion" && score > 5' -t "it's")");
+    BOOST_CHECK_EQUAL(args.getTokenCount(), 4u);
+    BOOST_CHECK_EQUAL(args.getNamedArgument("where"), R"(flair ~ "Discussion" && score > 5)");
+    BOOST_CHECK_EQUAL(args.getNamedArgument("t"), "it's");
 }
 
 BOOST_AUTO_TEST_CASE(convertToBool)
@@ -127,6 +153,524 @@ BOOST_AUTO_TEST_CASE(isBoolean)
     BOOST_CHECK_EQUAL(utils::isBoolean("tRue"), true);
 }
 
+BOOST_AUTO_TEST_CASE(parseDuration)
+{
+    using namespace std::chrono_literals;
+
+    BOOST_CHECK(utils::parseDuration("90") == 90s);
+    BOOST_CHECK(utils::parseDuration("30s") == 30s);
+    BOOST_CHECK(utils::parseDuration("5m") == 300s);
+    BOOST_CHECK(utils::parseDuration("2h") == 7200s);
+
+    BOOST_CHECK(!utils::parseDuration(""));
+    BOOST_CHECK(!utils::parseDuration("s"));
+    BOOST_CHECK(!utils::parseDuration("-5m"));
+    BOOST_CHECK(!utils::parseDuration("5d"));
+    BOOST_CHECK(!utils::parseDuration("99999999999999h"));
+}
+
+BOOST_AUTO_TEST_CASE(BufferPool)
+{
+    auto& pool = arcc::BufferPool::instance();
+    const auto before = pool.stats();
+
+    std::string buffer = pool.acquire();
+    buffer.reserve(1024);
+    pool.append(buffer, "hello", 5);
+    pool.append(buffer, " world", 6);
+    BOOST_CHECK_EQUAL(buffer, "hello world");
+
+    const auto capacity = buffer.capacity();
+    pool.release(std::move(buffer));
+
+    // the recycled buffer comes back empty but keeps its memory
+    std::string recycled = pool.acquire();
+    BOOST_CHECK(recycled.empty());
+    BOOST_CHECK_EQUAL(recycled.capacity(), capacity);
+
+    const auto after = pool.stats();
+    BOOST_CHECK_EQUAL(after.acquired - before.acquired, 2u);
+    BOOST_CHECK_EQUAL(after.reused - before.reused, 1u);
+    BOOST_CHECK_EQUAL(after.reallocations, before.reallocations);
+
+    pool.append(recycled, std::string(capacity + 1, 'x').data(), capacity + 1);
+    BOOST_CHECK_EQUAL(pool.stats().reallocations - before.reallocations, 1u);
+}
+
+BOOST_AUTO_TEST_CASE(LatencyHistogram)
+{
+    using arcc::LatencyHistogram;
+
+    // small values are exact and bucket boundaries line up
+    for (std::uint64_t value : { 0u, 1u, 31u, 32u, 47u, 48u, 1000u, 123456u })
+    {
+        const auto idx = LatencyHistogram::bucketIndex(value);
+        BOOST_CHECK_GE(LatencyHistogram::bucketHighest(idx), value);
+        if (idx > 0)
+        {
+            BOOST_CHECK_LT(LatencyHistogram::bucketHighest(idx - 1), value);
+        }
+    }
+    BOOST_CHECK_EQUAL(LatencyHistogram::bucketHighest(LatencyHistogram::bucketIndex(31)), 31u);
+
+    LatencyHistogram histogram;
+    BOOST_CHECK_EQUAL(histogram.percentile(50), 0u);
+
+    for (std::uint64_t value = 1; value <= 1000; value++)
+    {
+        histogram.record(value * 1000);
+    }
+
+    BOOST_CHECK_EQUAL(histogram.count(), 1000u);
+    BOOST_CHECK_EQUAL(histogram.min(), 1000u);
+    BOOST_CHECK_EQUAL(histogram.max(), 1000000u);
+    BOOST_CHECK_CLOSE(histogram.mean(), 500500.0, 0.001);
+
+    // every reported percentile is within the bucket precision
+    BOOST_CHECK_CLOSE(static_cast<double>(histogram.percentile(50)), 500000.0, 6.25);
+    BOOST_CHECK_CLOSE(static_cast<double>(histogram.percentile(99)), 990000.0, 6.25);
+    BOOST_CHECK_EQUAL(histogram.percentile(100), 1000000u);
+}
+
+BOOST_AUTO_TEST_CASE(RateLimiter)
+{
+    using namespace std::chrono_literals;
+    using Clock = std::chrono::steady_clock;
+
+    arcc::RateLimiter limiter{ 1000.0, 2.0 };
+
+    // a burst within capacity goes straight through
+    auto start = Clock::now();
+    limiter.acquire();
+    limiter.acquire();
+    BOOST_CHECK(Clock::now() - start < 100ms);
+
+    // the rate follows whatever budget is left in the window
+    limiter.update(arcc::WebClient::Headers{
+        { "x-ratelimit-remaining", "50.0" },
+        { "x-ratelimit-used", "50" },
+        { "x-ratelimit-reset", "100" } }, 200);
+    BOOST_CHECK_CLOSE(limiter.rate(), 0.5, 0.001);
+
+    // a spent window blocks everyone until it resets
+    limiter.update(0.0, 100.0, 0.2);
+    start = Clock::now();
+    limiter.acquire();
+    BOOST_CHECK(Clock::now() - start >= 150ms);
+
+    // interactive requests jump ahead of queued background work
+    limiter.pause(200ms);
+    std::vector<int> order;
+    std::mutex orderMutex;
+
+    auto background = std::thread(
+        [&]() 
+        { 
+            limiter.acquire(arcc::RequestPriority::BACKGROUND);
+            std::lock_guard<std::mutex> lock{ orderMutex };
+            order.push_back(2);
+        });
+
+    while (limiter.waiting() == 0) std::this_thread::sleep_for(1ms);
+
+    limiter.acquire(arcc::RequestPriority::INTERACTIVE);
+    {
+        std::lock_guard<std::mutex> lock{ orderMutex };
+        order.push_back(1);
+    }
+
+    background.join();
+    BOOST_REQUIRE_EQUAL(order.size(), 2u);
+    BOOST_CHECK_EQUAL(order.at(0), 1);
+    BOOST_CHECK_EQUAL(order.at(1), 2);
+}
+
+BOOST_AUTO_TEST_CASE(SingleFlight)
+{
+    using namespace std::chrono_literals;
+
+    arcc::SingleFlight<std::string, std::string> flights;
+    std::atomic<int> calls = 0;
+    std::promise<void> release;
+    auto released = release.get_future().share();
+
+    const auto work = 
+        [&]()
+        {
+            calls++;
+            released.wait();
+            return "response"s;
+        };
+
+    std::vector<std::future<std::string>> results;
+    results.push_back(std::async(std::launch::async, [&]() { return flights.run("/r/x/hot", work); }));
+    while (flights.inflight() == 0) std::this_thread::sleep_for(1ms);
+
+    for (auto i = 0; i < 4; i++)
+    {
+        results.push_back(std::async(std::launch::async, [&]() { return flights.run("/r/x/hot", work); }));
+    }
+
+    // a different key is never coalesced
+    BOOST_CHECK_EQUAL(flights.run("/r/y/hot", []() { return "other"s; }), "other");
+
+    // give the other callers time to join the flight
+    std::this_thread::sleep_for(100ms);
+    release.set_value();
+
+    for (auto& result : results)
+    {
+        BOOST_CHECK_EQUAL(result.get(), "response");
+    }
+
+    BOOST_CHECK_EQUAL(calls.load(), 1);
+    BOOST_CHECK_EQUAL(flights.inflight(), 0u);
+
+    // failures are shared as well and nothing is left behind
+    BOOST_CHECK_THROW(flights.run("/r/x/hot", []() -> std::string { throw std::runtime_error("boom"); }), std::runtime_error);
+    BOOST_CHECK_EQUAL(flights.inflight(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(Snapshot)
+{
+    arcc::Snapshot<const std::string> snapshot{ std::make_shared<const std::string>("first") };
+    auto first = snapshot.load();
+    BOOST_CHECK_EQUAL(*first, "first");
+
+    // a reader keeps the value it loaded whatever happens after
+    snapshot.store(std::make_shared<const std::string>("second"));
+    BOOST_CHECK_EQUAL(*first, "first");
+    BOOST_CHECK_EQUAL(*snapshot.load(), "second");
+
+    // a swap from a stale value fails and hands back the current one
+    auto expected = first;
+    BOOST_CHECK(!snapshot.compare_exchange(expected, std::make_shared<const std::string>("third")));
+    BOOST_CHECK_EQUAL(*expected, "second");
+    BOOST_CHECK(snapshot.compare_exchange(expected, std::make_shared<const std::string>("third")));
+    BOOST_CHECK_EQUAL(*snapshot.load(), "third");
+
+    // writers that race each other all get their change in
+    arcc::Snapshot<const int> counter{ std::make_shared<const int>(0) };
+    std::vector<std::thread> threads;
+    for (auto i = 0; i < 4; i++)
+    {
+        threads.emplace_back(
+            [&counter]()
+            {
+                for (auto j = 0; j < 1000; j++)
+                {
+                    auto current = counter.load();
+                    while (!counter.compare_exchange(current, std::make_shared<const int>(*current + 1)));
+                }
+            });
+    }
+
+    for (auto& thread : threads) thread.join();
+    BOOST_CHECK_EQUAL(*counter.load(), 4000);
+}
+
+BOOST_AUTO_TEST_CASE(LruCache)
+{
+    arcc::LruCache<std::string, int> cache{ 10 };
+
+    cache.put("a", 1, 4);
+    cache.put("b", 2, 4);
+    BOOST_CHECK_EQUAL(cache.size(), 2u);
+    BOOST_CHECK_EQUAL(cache.cost(), 8u);
+
+    // touching `a` makes `b` the one to go
+    BOOST_REQUIRE(cache.get("a") != nullptr);
+    cache.put("c", 3, 4);
+    BOOST_CHECK(cache.contains("a"));
+    BOOST_CHECK(!cache.contains("b"));
+    BOOST_CHECK_EQUAL(*cache.get("c"), 3);
+    BOOST_CHECK_EQUAL(cache.cost(), 8u);
+
+    // replacing a value replaces its cost as well
+    cache.put("a", 4, 2);
+    BOOST_CHECK_EQUAL(*cache.get("a"), 4);
+    BOOST_CHECK_EQUAL(cache.cost(), 6u);
+
+    // too big to ever fit
+    cache.put("d", 5, 11);
+    BOOST_CHECK(!cache.contains("d"));
+    BOOST_CHECK_EQUAL(cache.size(), 2u);
+
+    // shrinking evicts the least recently used
+    cache.setMaxCost(2);
+    BOOST_CHECK(cache.contains("a"));
+    BOOST_CHECK(!cache.contains("c"));
+
+    cache.clear();
+    BOOST_CHECK(cache.get("a") == nullptr);
+    BOOST_CHECK_EQUAL(cache.cost(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(TimerWheel)
+{
+    using namespace std::chrono_literals;
+    using Clock = arcc::TimerWheel<int>::Clock;
+
+    const auto start = Clock::now();
+    arcc::TimerWheel<int> wheel{ 100ms, 8, start };
+    BOOST_CHECK(wheel.next() == Clock::time_point::max());
+
+    // fires on the first tick at or after it is due, the third one only
+    // after the wheel has gone around twice
+    wheel.schedule(start + 150ms, 1);
+    wheel.schedule(start + 100ms, 2);
+    wheel.schedule(start + 1900ms, 3);
+    wheel.schedule(start + 300ms, 4);
+    BOOST_CHECK_EQUAL(wheel.size(), 4u);
+    BOOST_CHECK(wheel.next() == start + 100ms);
+
+    std::vector<int> due;
+    wheel.expire(start + 99ms, due);
+    BOOST_CHECK(due.empty());
+
+    wheel.expire(start + 299ms, due);
+    BOOST_CHECK((due == std::vector<int>{ 2, 1 }));
+    BOOST_CHECK(wheel.next() == start + 300ms);
+
+    due.clear();
+    wheel.expire(start + 1800ms, due);
+    BOOST_CHECK((due == std::vector<int>{ 4 }));
+    BOOST_CHECK(wheel.next() == start + 1900ms);
+
+    // missed ticks are caught up on, and the past is due right away
+    due.clear();
+    wheel.schedule(start, 5);
+    wheel.expire(start + 10s, due);
+    BOOST_CHECK((due == std::vector<int>{ 3, 5 }));
+    BOOST_CHECK(wheel.empty());
+}
+
+BOOST_AUTO_TEST_CASE(StringPool)
+{
+    auto& pool = arcc::StringPool::instance();
+    const auto before = pool.size();
+
+    std::string flair{ "string_pool_flair" };
+    const auto first = pool.intern(flair);
+    flair.assign("overwritten");
+
+    // the pool holds its own copy and hands it out again for equal strings
+    BOOST_CHECK_EQUAL(first, "string_pool_flair");
+    BOOST_CHECK(pool.intern("string_pool_flair").data() == first.data());
+    BOOST_CHECK_EQUAL(pool.size(), before + 1);
+
+    BOOST_CHECK(pool.intern("").empty());
+    BOOST_CHECK_EQUAL(pool.size(), before + 1);
+}
+
+BOOST_AUTO_TEST_CASE(JsonIndex)
+{
+    using Kernel = arcc::JsonIndex::Kernel;
+
+    // escapes and brackets inside strings, with a run of backslashes
+    // straddling the first 64 byte block
+    const std::string text = R"({"padding": "012345678901234567890123456789012345678901234567\\\\\\\"", )"
+        R"("list": [1, -2.5e3, true, null, "x]}\"{", {"k": [ ]}], "nested": {"a": {"b": "c"}}, )"
+        R"("empty": {}, "text": "café 😀"})";
+
+    const auto dom = nlohmann::json::parse(text);
+
+    for (auto kernel : { Kernel::SCALAR, Kernel::SSE2, Kernel::AVX2 })
+    {
+        if (!arcc::JsonIndex::supported(kernel)) continue;
+
+        arcc::JsonIndex index{ text, kernel };
+        BOOST_REQUIRE(index.valid());
+        BOOST_CHECK(index.tape() == arcc::JsonIndex(text, Kernel::SCALAR).tape());
+
+        const auto root = index.root();
+        BOOST_REQUIRE(root.isObject());
+        BOOST_CHECK_EQUAL(root.size(), dom.size());
+
+        for (const auto& [key, value] : dom.items())
+        {
+            const auto found = root.find(key);
+            BOOST_REQUIRE(found);
+            BOOST_CHECK_EQUAL(nlohmann::json::parse(found->raw()), value);
+        }
+
+        const auto list = root.find("list");
+        BOOST_REQUIRE(list && list->isArray());
+        BOOST_CHECK_EQUAL(list->size(), 6u);
+
+        std::vector<std::string> elements;
+        list->forEach([&](const arcc::JsonIndex::Value& v) { elements.emplace_back(v.raw()); });
+        BOOST_REQUIRE_EQUAL(elements.size(), 6u);
+        BOOST_CHECK_EQUAL(elements.at(1), "-2.5e3");
+        BOOST_CHECK_EQUAL(elements.at(4), R"("x]}\"{")");
+
+        BOOST_CHECK_EQUAL(list->first()->number<int>(), 1);
+        BOOST_CHECK_EQUAL(list->first()->next()->number<double>(), -2500.0);
+        BOOST_CHECK(list->first()->next()->next()->boolean());
+        BOOST_CHECK(list->first()->next()->next()->next()->isNull());
+
+        BOOST_CHECK_EQUAL(root.find("nested")->find("a")->find("b")->string(), "c");
+        BOOST_CHECK_EQUAL(root.find("text")->string(), dom["text"].get<std::string>());
+        BOOST_CHECK_EQUAL(root.find("padding")->string(), dom["padding"].get<std::string>());
+        BOOST_CHECK(!root.find("empty")->first());
+        BOOST_CHECK(!root.find("missing"));
+    }
+
+    BOOST_CHECK(!arcc::JsonIndex(R"({"a": [1, 2})").valid());
+    BOOST_CHECK(!arcc::JsonIndex(R"({"a": "open})").valid());
+    BOOST_CHECK(!arcc::JsonIndex(R"({"a": 1]})").valid());
+    BOOST_CHECK(arcc::JsonIndex("42").root().number<int>() == 42);
+}
+
+BOOST_AUTO_TEST_CASE(FlatJson)
+{
+    const std::string text = R"({"url": "https://example.com", "author": "someone", "score": 12, )"
+        R"("preview": {"enabled": true, "images": [{"id": "x", "b": null}]}, "name": "t3_x1"})";
+
+    auto flat = arcc::FlatJson::parse(text);
+    const auto dom = nlohmann::json::parse(text);
+
+    // members are kept sorted, so the text matches a std::map backed object
+    BOOST_CHECK_EQUAL(flat.dump(), dom.dump());
+    BOOST_CHECK_EQUAL(flat.size(), 5u);
+
+    const auto& object = flat.get_ref<const arcc::FlatJson::object_t&>();
+    BOOST_CHECK(std::is_sorted(object.begin(), object.end(),
+        [](const auto& a, const auto& b) { return a.first < b.first; }));
+
+    BOOST_CHECK_EQUAL(flat.at("score"), 12);
+    BOOST_CHECK_EQUAL(flat["preview"]["images"][0]["id"], "x");
+    BOOST_CHECK(flat.contains(std::string_view{ "name" }));
+    BOOST_CHECK(flat.find("missing") == flat.end());
+    BOOST_CHECK_THROW(flat.at("missing"), nlohmann::json::out_of_range);
+
+    flat["downs"] = 1;
+    flat["zzz"] = "last";
+    flat["author"] = "someone else";
+    BOOST_CHECK_EQUAL(flat.erase("url"), 1u);
+    BOOST_CHECK_EQUAL(flat.erase("url"), 0u);
+    flat.erase(flat.find("zzz"));
+    flat.update(arcc::FlatJson{ { "comments", 3 }, { "score", 13 } });
+
+    auto expected = dom;
+    expected["downs"] = 1;
+    expected["author"] = "someone else";
+    expected.erase("url");
+    expected.update(nlohmann::json{ { "comments", 3 }, { "score", 13 } });
+    BOOST_CHECK_EQUAL(flat.dump(), expected.dump());
+
+    const auto copy = flat;
+    BOOST_CHECK(copy == flat);
+}
+
+BOOST_AUTO_TEST_CASE(SeenSet)
+{
+    // the kind is part of the key, and anything that is not a fullname
+    // still gets one
+    BOOST_CHECK_NE(arcc::SeenSet::key("t3_abc"), arcc::SeenSet::key("t1_abc"));
+    BOOST_CHECK_EQUAL(arcc::SeenSet::key("t3_10"), (3ull << 57) | 36);
+    BOOST_CHECK_NE(arcc::SeenSet::key("t3_ABC"), arcc::SeenSet::key("t3_abc"));
+    BOOST_CHECK(arcc::SeenSet::key("not a fullname") >> 63);
+
+    const auto fullname = [](std::size_t i)
+        {
+            std::string id;
+            for (auto n = i + 1000000; n > 0; n /= 36) id.insert(id.begin(), "0123456789abcdefghijklmnopqrstuvwxyz"[n % 36]);
+            return "t3_" + id;
+        };
+
+    constexpr std::size_t count = 200000;
+
+    arcc::SeenSet exact;
+    for (std::size_t i = 0; i < count; i++)
+    {
+        BOOST_REQUIRE(exact.insert(fullname(i)));
+    }
+
+    for (std::size_t i = 0; i < count; i++)
+    {
+        BOOST_REQUIRE(!exact.insert(fullname(i)));
+    }
+
+    BOOST_CHECK_EQUAL(exact.size(), count);
+    BOOST_CHECK(exact.contains("t1_" + fullname(0).substr(3)) == false);
+    BOOST_CHECK(!exact.contains(fullname(count)));
+    BOOST_CHECK_LE(exact.memoryUsage(), count * 24);
+
+    exact.clear();
+    BOOST_CHECK_EQUAL(exact.size(), 0u);
+    BOOST_CHECK(!exact.contains(fullname(0)));
+    BOOST_CHECK(exact.insert(fullname(0)));
+
+    arcc::SeenSet bloom{ arcc::SeenSet::Mode::BLOOM, count, 0.01 };
+    const auto fixed = bloom.memoryUsage();
+    for (std::size_t i = 0; i < count; i++)
+    {
+        bloom.insert(fullname(i));
+    }
+
+    // never forgets, and mistakes a few new names for old ones
+    std::size_t falsePositives = 0;
+    for (std::size_t i = 0; i < count; i++)
+    {
+        BOOST_REQUIRE(bloom.contains(fullname(i)));
+        if (bloom.contains(fullname(count + i))) falsePositives++;
+    }
+
+    BOOST_CHECK_LT(falsePositives, count / 50);
+    BOOST_CHECK_EQUAL(bloom.memoryUsage(), fixed);
+
+    bloom.clear();
+    BOOST_CHECK(!bloom.contains(fullname(0)));
+}
+
+BOOST_AUTO_TEST_CASE(LinkFilter)
+{
+    arcc::Link link;
+    link.name = "t3_x1";
+    link.title = "Weekly Discussion Thread";
+    link.author = "someone";
+    link.flair = "Discussion";
+    link.score = 750;
+    link.comments = 20;
+    link.created = 1546300800;
+
+    const auto matches = [&link](std::string_view expression)
+        {
+            return arcc::LinkFilter{ expression }.matches(link);
+        };
+
+    BOOST_CHECK(matches(R"(score > 500 && num_comments < 50 && !stickied && flair ~ "discussion")"));
+    BOOST_CHECK(matches("score >= 750 && score <= 750 && score == 750 && score != 749"));
+    BOOST_CHECK(!matches("score < 750 || comments > 20"));
+    BOOST_CHECK(matches("!(score < 0) && (stickied || title ~ 'weekly')"));
+    BOOST_CHECK(matches("!!author && !stickied && stickied == false && ups == downs"));
+    BOOST_CHECK(matches("score > -1 && created_utc > 1500000000 && name == 't3_x1'"));
+    BOOST_CHECK(!matches(R"(author == "Someone")"));
+    BOOST_CHECK(matches(R"(title ~ "\"" || author ~ "")"));
+    BOOST_CHECK(matches("true"));
+    BOOST_CHECK(!matches("url"));
+
+    // `&&` binds tighter than `||`, and either skips what it does not need
+    BOOST_CHECK(matches("stickied && score < 0 || comments == 20"));
+    BOOST_CHECK(!matches("comments == 20 && (stickied || score < 0)"));
+
+    const arcc::LinkFilter filter{ "score > 500 && !stickied" };
+    BOOST_CHECK_EQUAL(filter.expression(), "score > 500 && !stickied");
+    BOOST_REQUIRE_EQUAL(filter.code().size(), 4u);
+    BOOST_CHECK(filter.code().at(1).code == arcc::LinkFilter::OpCode::JUMP_IF_FALSE);
+    BOOST_CHECK_EQUAL(filter.code().at(1).lhs, 4u);
+
+    link.stickied = true;
+    BOOST_CHECK(!filter.matches(link));
+
+    for (const auto bad : { "", "score >", "score > 'a'", "score ~ 5", "karma > 5", "(score > 5",
+        "score > 5 )", "title ~ 'open", "score > 99999999999999999999", "score > 5 &&", "&& score" })
+    {
+        BOOST_CHECK_THROW(arcc::LinkFilter{ bad }, std::invalid_argument);
+    }
+}
+
 BOOST_AUTO_TEST_SUITE(Settings) // arccutils/Settings
 
 void registerAllSettings(arcc::Settings& settings)